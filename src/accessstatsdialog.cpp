@@ -0,0 +1,98 @@
+/*
+Dwarf Therapist
+Copyright (c) 2009 Trey Stout (chmod)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+#include "accessstatsdialog.h"
+#include "dfinstance.h"
+
+#include <QDialogButtonBox>
+#include <QHeaderView>
+#include <QLabel>
+#include <QPushButton>
+#include <QTableWidget>
+#include <QVBoxLayout>
+
+AccessStatsDialog::AccessStatsDialog(DFInstance *df, QWidget *parent)
+    : QDialog(parent)
+    , m_df(df)
+    , m_table(new QTableWidget(this))
+    , m_freeze_label(new QLabel(this))
+{
+    setWindowTitle(tr("Memory Access Statistics"));
+
+    m_table->setColumnCount(6);
+    m_table->setHorizontalHeaderLabels(QStringList() << tr("Subsystem") << tr("Reads") << tr("Bytes Read")
+                                       << tr("Failed Reads") << tr("Writes") << tr("Bytes Written"));
+    m_table->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    m_table->setSelectionBehavior(QAbstractItemView::SelectRows);
+    m_table->verticalHeader()->hide();
+    m_table->horizontalHeader()->setSectionResizeMode(QHeaderView::ResizeToContents);
+
+    QDialogButtonBox *buttons = new QDialogButtonBox(QDialogButtonBox::Close, this);
+    QPushButton *btn_refresh = buttons->addButton(tr("Refresh"), QDialogButtonBox::ActionRole);
+    connect(btn_refresh, &QAbstractButton::clicked, this, &AccessStatsDialog::refresh);
+    connect(buttons, &QDialogButtonBox::rejected, this, &QDialog::reject);
+
+    QVBoxLayout *layout = new QVBoxLayout(this);
+    layout->addWidget(m_table);
+    layout->addWidget(m_freeze_label);
+    layout->addWidget(buttons);
+
+    resize(600, 320);
+    refresh();
+}
+
+void AccessStatsDialog::refresh(){
+    m_table->setRowCount(0);
+    m_freeze_label->clear();
+    if(!m_df)
+        return;
+
+    auto add_row = [this](const QString &name, const DFInstance::access_stats &s){
+        int row = m_table->rowCount();
+        m_table->insertRow(row);
+        m_table->setItem(row, 0, new QTableWidgetItem(name));
+        QList<quint64> values;
+        values << s.read_calls << s.read_bytes << s.read_failures << s.write_calls << s.write_bytes;
+        for(int col = 0; col < values.size(); col++){
+            QTableWidgetItem *item = new QTableWidgetItem(QString::number(values.at(col)));
+            item->setTextAlignment(Qt::AlignRight | Qt::AlignVCenter);
+            m_table->setItem(row, col + 1, item);
+        }
+    };
+
+    for(int i = 0; i < DFInstance::RS_TOTAL_SUBSYSTEMS; i++){
+        DFInstance::READ_SUBSYSTEM sub = static_cast<DFInstance::READ_SUBSYSTEM>(i);
+        add_row(DFInstance::subsystem_name(sub), m_df->get_access_stats(sub));
+    }
+    add_row(tr("Total"), m_df->total_access_stats());
+
+    QFont bold = m_table->font();
+    bold.setBold(true);
+    int last = m_table->rowCount() - 1;
+    for(int col = 0; col < m_table->columnCount(); col++){
+        m_table->item(last, col)->setFont(bold);
+    }
+
+    const DFInstance::freeze_stats &f = m_df->get_freeze_stats();
+    m_freeze_label->setText(tr("Game stopped %1 times for %2 ms in total, longest stop %3 ms.")
+                            .arg(f.count).arg(f.total_ms).arg(f.longest_ms));
+}
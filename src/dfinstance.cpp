@@ -49,15 +49,31 @@ THE SOFTWARE.
 #include "equipwarn.h"
 #include "unitemotion.h"
 #include "rolecalcbase.h"
+#include "rolekernel.h"
 #include "defaultroleweight.h"
 #include "standardpaths.h"
 #include "unitneed.h"
 #include "memorylayoutmanager.h"
+#include "profiler.h"
+#include "generationarena.h"
+#include "itemrepository.h"
 
+#include <QThread>
 #include <QTimer>
 #include <QTime>
 #include <QInputDialog>
+#include <QtConcurrent>
+#include <QCryptographicHash>
+#include <QFile>
+#include <QFileInfo>
+#include <QSettings>
+#include <iterator>
+
+#ifndef Q_OS_WIN
+#include <sys/stat.h>
+#endif
 
+#include "dfinstancesynthetic.h"
 #ifdef Q_OS_WIN
 #include "dfinstancewindows.h"
 #elif defined(Q_OS_LINUX)
@@ -71,18 +87,24 @@ DFInstance::DFInstance(QObject* parent)
     , m_base_addr(0)
     , m_df_checksum("")
     , m_pointer_size(sizeof(VIRTADDR)) // use build architecture as default
+    , m_item_repo(std::make_unique<ItemRepository>(this))
     , m_attach_count(0)
     , m_heartbeat_timer(new QTimer(this))
     , m_dwarf_race_id(0)
     , m_dwarf_civ_id(0)
     , m_status(DFS_DISCONNECTED)
-    , m_languages(0x0)
     , m_fortress(0x0)
-    , m_needs_data(Dwarf::FOCUS_DEGREE_COUNT)
     , m_fortress_name(tr("Embarking"))
+    , m_languages(0x0)
+    , m_needs_data(Dwarf::FOCUS_DEGREE_COUNT)
     , m_fortress_name_translated("")
     , m_squad_vector(0)
+    , m_external_flag(0)
+    , m_probe_fortress(0)
+    , m_probe_time(-1)
 {
+    reset_access_stats();
+
     // let subclasses start the heartbeat timer, since we don't want to be
     // checking before we're connected
     connect(m_heartbeat_timer, SIGNAL(timeout()), SLOT(heartbeat()));
@@ -93,6 +115,8 @@ DFInstance::DFInstance(QObject* parent)
 }
 
 DFInstance * DFInstance::newInstance(){
+    if(DT->synthetic_units() > 0)
+        return new DFInstanceSynthetic(DT->synthetic_units(), DT->synthetic_seed());
 #ifdef Q_OS_WIN
     return new DFInstanceWindows();
 #elif defined(Q_OS_MAC)
@@ -154,7 +178,6 @@ DFInstance::~DFInstance() {
     qDeleteAll(m_plants_vector);
     m_plants_vector.clear();
 
-    qDeleteAll(m_pref_counts);
     m_pref_counts.clear();
 
     qDeleteAll(m_emotion_counts);
@@ -249,26 +272,40 @@ QVector<VIRTADDR> DFInstance::enum_vec<VIRTADDR>(VIRTADDR addr) {
 
 void DFInstance::load_game_data()
 {
+    PROFILE_SCOPE("load_game_data");
     emit progress_message(tr("Loading languages"));
     if(m_languages){
         delete m_languages;
         m_languages = 0;
     }
-    m_languages = Languages::get_languages(this);
+    {
+        PROFILE_SCOPE("load_languages");
+        SubsystemScope ss(RS_LANGUAGES);
+        m_languages = Languages::get_languages(this);
+    }
 
     emit progress_message(tr("Loading reactions"));
+    SubsystemScope ss(RS_RAWS);
     qDeleteAll(m_reactions);
     m_reactions.clear();
     load_reactions();
 
     emit progress_message(tr("Loading item and material lists"));
+    {
+        QMutexLocker locker(&m_name_mutex);
+        m_material_names.clear();
+        m_pref_item_names.clear();
+    }
     qDeleteAll(m_plants_vector);
     m_plants_vector.clear();
     qDeleteAll(m_inorganics_vector);
     m_inorganics_vector.clear();
     qDeleteAll(m_base_materials);
     m_base_materials.clear();
-    load_main_vectors();
+    {
+        PROFILE_SCOPE("load_main_vectors");
+        load_main_vectors();
+    }
 
     //load the currently played race before races and castes so we can load additional information for the current race being played
     VIRTADDR dwarf_race_index_addr = m_layout->global_address(this, "dwarf_race_index");
@@ -280,10 +317,16 @@ void DFInstance::load_game_data()
     emit progress_message(tr("Loading races and castes"));
     qDeleteAll(m_races);
     m_races.clear();
-    load_races_castes();
+    {
+        PROFILE_SCOPE("load_races_castes");
+        load_races_castes();
+    }
 
     emit progress_message(tr("Loading item types"));
-    load_item_defs();
+    {
+        PROFILE_SCOPE("load_item_defs");
+        load_item_defs();
+    }
 
     load_fortress_name();
     load_external_flag();
@@ -312,6 +355,7 @@ QString DFInstance::get_name(VIRTADDR addr, bool translate){
 }
 
 QVector<Dwarf*> DFInstance::load_dwarves() {
+    PROFILE_SCOPE("load_dwarves");
     QVector<Dwarf*> dwarves;
     if (m_status < DFS_LAYOUT_OK) {
         LOGE << "Could not load units: disconnected or invalid memory layout";
@@ -347,153 +391,219 @@ QVector<Dwarf*> DFInstance::load_dwarves() {
         QPointer<Dwarf> d;
         int progress_count = 0;
         foreach(VIRTADDR creature_addr, creatures_addrs) {
+            PROFILE_SCOPE("decode_unit");
+            SubsystemScope ss(RS_UNITS);
             d = QPointer<Dwarf>(new Dwarf(this, creature_addr,this));
             if(!d.isNull() && d->is_valid()){
                 dwarves.append(d);
-                if(!d->is_animal()){
-                    m_actual_dwarves.append(d);
-                    //never calculate roles for babies
-                    //only calculate roles for children if labor cheats are enabled
-                    if(!d->is_baby() && (!d->is_child() || DT->labor_cheats_allowed())){
-                        m_labor_capable_dwarves.append(d);
-                    }
-                }
             }else{
                 //delete d;
             }
             emit progress_value(progress_count++);
         }
         LOGI << "read" << dwarves.count() << "units in" << t.elapsed() << "ms";
+    }
+    //everything after this works on the decoded units only, let the game run again
+    detach();
 
-        m_enabled_labor_count.clear();
-        qDeleteAll(m_pref_counts);
-        m_pref_counts.clear();
-        qDeleteAll(m_emotion_counts);
-        m_emotion_counts.clear();
-        qDeleteAll(m_equip_warning_counts);
-        m_equip_warning_counts.clear();
-        m_needs_data.overall_focus.clear();
-        m_needs_data.needs.clear();
-
-        t.restart();
-        load_role_ratings();
-        LOGI << "calculated roles in" << t.elapsed() << "ms";
-
-
-        t.restart();
-        load_population_data();
-        LOGI << "loaded population data in" << t.elapsed() << "ms";
-
-        //calc_done();
-        m_actual_dwarves.clear();
-        m_labor_capable_dwarves.clear();
-
-        DT->emit_labor_counts_updated();
-
+    if (!creatures_addrs.empty()) {
+        process_units(dwarves);
     }else{
         // we lost the fort! reset to disconnected as DF version could potentially change
         send_connection_interrupted();
     }
-    detach();
 
     LOGI << "found" << dwarves.size() << "units out of" << creatures_addrs.size() << "creatures";
 
     return dwarves;
 }
 
-void DFInstance::load_population_data(){
-    int labor_count = 0;
-    int unit_kills = 0;
-    int max_kills = 0;
+void DFInstance::process_units(const QVector<Dwarf*> &units){
+    foreach(Dwarf *d, units){
+        if(!d->is_animal()){
+            m_actual_dwarves.append(d);
+            if(is_labor_capable(d)){
+                m_labor_capable_dwarves.append(d);
+            }
+        }
+    }
 
-    foreach(Dwarf *d, m_actual_dwarves){
+    m_enabled_labor_count.clear();
+    m_pref_counts.clear();
+    qDeleteAll(m_emotion_counts);
+    m_emotion_counts.clear();
+    qDeleteAll(m_equip_warning_counts);
+    m_equip_warning_counts.clear();
+    m_needs_data.overall_focus.clear();
+    m_needs_data.needs.clear();
+
+    QTime t;
+    t.start();
+    load_role_ratings();
+    LOGI << "calculated roles in" << t.elapsed() << "ms";
+
+    t.restart();
+    load_population_data();
+    LOGI << "loaded population data in" << t.elapsed() << "ms";
+
+    //calc_done();
+    m_actual_dwarves.clear();
+    m_labor_capable_dwarves.clear();
+
+    DT->emit_labor_counts_updated();
+}
+
+namespace {
+//! one worker's share of the fort-wide tables, merged back in unit order
+struct population_partial {
+    population_partial() : max_kills(0), needs(UnitNeed::DEGREE_COUNT) {}
+
+    QHash<int,int> labor_counts;
+    int max_kills;
+    QHash<QPair<QString,QString>, DFInstance::pref_stat> prefs;
+    //emotion groups and equipment warnings are QObjects owned by the instance, so only collect them here
+    QHash<int, QVector<QPair<Dwarf*,UnitEmotion*> > > emotions;
+    QHash<ITEM_TYPE, QVector<QPair<Dwarf*,EquipWarn::warn_info> > > equip_warnings;
+    DFInstance::needs_data needs;
+};
+
+void aggregate_population(const QVector<Dwarf*> &units, int start, int end, bool hide_non_adults, population_partial &part){
+    const QString like_creature = Preference::get_pref_desc(LIKE_CREATURE);
+    const QString hate_creature = Preference::get_pref_desc(HATE_CREATURE);
+
+    for(int idx = start; idx < end; idx++){
+        Dwarf *d = units.at(idx);
         //load labor counts
         foreach(int key, d->get_labors().uniqueKeys()){
-            if(d->labor_enabled(key)){
-                if(m_enabled_labor_count.contains(key))
-                    labor_count = m_enabled_labor_count.value(key)+1;
-                else
-                    labor_count = 1;
-                m_enabled_labor_count.insert(key,labor_count);
-            }
+            if(d->labor_enabled(key))
+                part.labor_counts[key]++;
         }
 
         //save highest kill count
-        unit_kills = d->hist_figure()->total_kills();
-        if(unit_kills > max_kills)
-            max_kills = unit_kills;
-
-        if(!m_labor_capable_dwarves.contains(d)){
-            d->calc_attribute_ratings();
+        if(HistFigure *h = d->hist_figure()){
+            part.max_kills = qMax(part.max_kills, h->total_kills());
         }
 
         //load preference/thoughts/item wear totals, excluding babies/children according to settings
-        if(d->is_adult() || (!d->is_adult() && !DT->hide_non_adults())){
-            foreach(QString category_name, d->get_grouped_preferences().uniqueKeys()){
-                for(int i = 0; i < d->get_grouped_preferences().value(category_name)->count(); i++){
-
-                    QString pref = d->get_grouped_preferences().value(category_name)->at(i);
-                    QString cat_name = category_name;
-                    bool is_dislike = false;
-                    //put liked and hated creatures together
-                    if(category_name == Preference::get_pref_desc(HATE_CREATURE)){
-                        cat_name = Preference::get_pref_desc(LIKE_CREATURE);
-                        is_dislike = true;
-                    }
-
-                    QPair<QString,QString> key_pair;
-                    key_pair.first = cat_name;
-                    key_pair.second = pref;
-
-                    pref_stat *p;
-                    if(m_pref_counts.contains(key_pair))
-                        p = m_pref_counts.take(key_pair);
-                    else{
-                        p = new pref_stat();
-                    }
-
-                    if(is_dislike){
-                        p->names_dislikes.append(d->nice_name());
-                    }else{
-                        p->names_likes.append(d->nice_name());
-                    }
-                    p->pref_category = cat_name;
-
-                    m_pref_counts.insert(key_pair,p);
-                }
+        if(!d->is_adult() && hide_non_adults)
+            continue;
+
+        QHash<QString, QStringList*> grouped = d->get_grouped_preferences();
+        for(auto it = grouped.constBegin(); it != grouped.constEnd(); ++it){
+            //put liked and hated creatures together
+            bool is_dislike = (it.key() == hate_creature);
+            const QString &cat_name = is_dislike ? like_creature : it.key();
+            foreach(const QString &pref, *it.value()){
+                DFInstance::pref_stat &p = part.prefs[qMakePair(cat_name, pref)];
+                if(is_dislike)
+                    p.dislikes.append(d->id());
+                else
+                    p.likes.append(d->id());
+                p.pref_category = cat_name;
             }
+        }
 
-            //emotions
-            QList<UnitEmotion*> d_emotions = d->get_emotions();
-            foreach(UnitEmotion *ue, d_emotions){
-                int thought_id = ue->get_thought_id();
-                if(!m_emotion_counts.contains(thought_id)){
-                    m_emotion_counts.insert(thought_id, new EmotionGroup(this));
-                }
-                EmotionGroup *em = m_emotion_counts.value(thought_id);
-                em->add_detail(d,ue);
+        //emotions
+        foreach(UnitEmotion *ue, d->get_emotions()){
+            part.emotions[ue->get_thought_id()].append(qMakePair(d, ue));
+        }
+
+        //inventory wear/missing/uncovered
+        foreach(EquipWarn::warn_info wi, d->get_equip_warnings()){
+            part.equip_warnings[wi.iType].append(qMakePair(d, wi));
+        }
+
+        //needs
+        part.needs.overall_focus.dwarves[d->get_focus_degree()].push_back(d);
+        for (const auto &p: d->get_needs()) {
+            auto need = p.second.get();
+            auto key = std::make_tuple(need->id(), need->deity_id());
+            auto it = part.needs.needs.lower_bound(key);
+            if (it == part.needs.needs.end() || it->first != key)
+                it = part.needs.needs.emplace_hint(it, key, UnitNeed::DEGREE_COUNT);
+            it->second.dwarves[need->focus_degree()].push_back(d);
+        }
+    }
+}
+}
+
+void DFInstance::load_population_data(){
+    PROFILE_SCOPE("load_population_data");
+
+    //labor capable units already had their attributes rated along with their roles
+    foreach(Dwarf *d, m_actual_dwarves){
+        if(d->is_baby() || (d->is_child() && !DT->labor_cheats_allowed()))
+            d->calc_attribute_ratings();
+    }
+
+    //split the units into one slice per thread, small forts aren't worth the overhead
+    const int min_slice = 64;
+    int slices = qBound(1, m_actual_dwarves.size() / min_slice, qMax(1, QThread::idealThreadCount()));
+    int slice_size = (m_actual_dwarves.size() + slices - 1) / qMax(1, slices);
+    QVector<population_partial> partials(slices);
+    QVector<int> slice_ids;
+    for(int i = 0; i < slices; i++)
+        slice_ids.append(i);
+
+    bool hide_non_adults = DT->hide_non_adults();
+    const QVector<Dwarf*> &units = m_actual_dwarves;
+    auto aggregate_slice = [&](int &slice){
+        int start = slice * slice_size;
+        int end = qMin(units.size(), start + slice_size);
+        aggregate_population(units, start, end, hide_non_adults, partials[slice]);
+    };
+    if(slices > 1)
+        QtConcurrent::blockingMap(slice_ids, aggregate_slice);
+    else if(slices == 1)
+        aggregate_slice(slice_ids[0]);
+
+    int max_kills = 0;
+    foreach(const population_partial &part, partials){
+        for(auto it = part.labor_counts.constBegin(); it != part.labor_counts.constEnd(); ++it)
+            m_enabled_labor_count[it.key()] += it.value();
+
+        max_kills = qMax(max_kills, part.max_kills);
+
+        for(auto it = part.prefs.constBegin(); it != part.prefs.constEnd(); ++it){
+            pref_stat &p = m_pref_counts[it.key()];
+            p.likes.append(it.value().likes);
+            p.dislikes.append(it.value().dislikes);
+            p.pref_category = it.value().pref_category;
+        }
+
+        for(auto it = part.emotions.constBegin(); it != part.emotions.constEnd(); ++it){
+            EmotionGroup *em = m_emotion_counts.value(it.key());
+            if(!em){
+                em = new EmotionGroup(this);
+                m_emotion_counts.insert(it.key(), em);
             }
+            for(const auto &detail: it.value())
+                em->add_detail(detail.first, detail.second);
+        }
 
-            //inventory wear/missing/uncovered
-            QList<EquipWarn::warn_info> eq_warnings = d->get_equip_warnings();
-            foreach(EquipWarn::warn_info wi, eq_warnings){
-                ITEM_TYPE i_type = wi.iType;
-                if(!m_equip_warning_counts.contains(i_type)){
-                    m_equip_warning_counts.insert(i_type, new EquipWarn(this));
-                }
-                EquipWarn *eq_warn = m_equip_warning_counts.value(i_type);
-                eq_warn->add_detail(d,wi);
+        for(auto it = part.equip_warnings.constBegin(); it != part.equip_warnings.constEnd(); ++it){
+            EquipWarn *eq_warn = m_equip_warning_counts.value(it.key());
+            if(!eq_warn){
+                eq_warn = new EquipWarn(this);
+                m_equip_warning_counts.insert(it.key(), eq_warn);
             }
+            for(const auto &detail: it.value())
+                eq_warn->add_detail(detail.first, detail.second);
+        }
 
-            //needs
-            m_needs_data.overall_focus.dwarves[d->get_focus_degree()].push_back(d);
-            for (const auto &p: d->get_needs()) {
-                auto need = p.second.get();
-                auto key = std::make_tuple(need->id(), need->deity_id());
-                auto it = m_needs_data.needs.lower_bound(key);
-                if (it == m_needs_data.needs.end() || it->first != key)
-                    it = m_needs_data.needs.emplace_hint(it, key, UnitNeed::DEGREE_COUNT);
-                it->second.dwarves[need->focus_degree()].push_back(d);
+        for(int degree = 0; degree < UnitNeed::DEGREE_COUNT; degree++){
+            auto &dst = m_needs_data.overall_focus.dwarves[degree];
+            const auto &src = part.needs.overall_focus.dwarves[degree];
+            dst.insert(dst.end(), src.begin(), src.end());
+        }
+        for(const auto &need: part.needs.needs){
+            auto it = m_needs_data.needs.lower_bound(need.first);
+            if (it == m_needs_data.needs.end() || it->first != need.first)
+                it = m_needs_data.needs.emplace_hint(it, need.first, UnitNeed::DEGREE_COUNT);
+            for(int degree = 0; degree < UnitNeed::DEGREE_COUNT; degree++){
+                auto &dst = it->second.dwarves[degree];
+                const auto &src = need.second.dwarves[degree];
+                dst.insert(dst.end(), src.begin(), src.end());
             }
         }
     }
@@ -501,11 +611,15 @@ void DFInstance::load_population_data(){
 }
 
 void DFInstance::load_role_ratings(){
+    PROFILE_SCOPE("load_role_ratings");
     if(m_labor_capable_dwarves.size() <= 0)
         return;
 
     DefaultRoleWeight::update_all();
 
+    GameDataReader *gdr = GameDataReader::ptr();
+    RoleKernel kernel(gdr->get_roles().values());
+
     QVector<double> attribute_values;
     QVector<double> attribute_raw_values;
     QVector<double> skill_values;
@@ -514,8 +628,6 @@ void DFInstance::load_role_ratings(){
     QVector<double> need_values;
     QVector<double> pref_values;
 
-    GameDataReader *gdr = GameDataReader::ptr();
-
     foreach(Dwarf *d, m_labor_capable_dwarves){
         foreach(ATTRIBUTES_TYPE id, gdr->get_attributes().keys()){
             attribute_values.append(d->get_attribute(id).get_balanced_value());
@@ -535,12 +647,14 @@ void DFInstance::load_role_ratings(){
 
         for (int i = 0; i < gdr->get_need_count(); ++i)
             need_values.append(d->get_need_type_level(i));
+    }
 
-        foreach(Role *r, gdr->get_roles().values()){
-            if(!r->prefs.empty()){
-                pref_values.append(d->get_role_pref_match_counts(r,true));
-            }
-        }
+    //match the preferences once, the totals are used for the population stats and again for the ratings
+    QVector<double> pref_totals = kernel.match_preferences(m_labor_capable_dwarves);
+    const int role_count = kernel.roles().size();
+    for(int i = 0; i < pref_totals.size(); i++){
+        if(kernel.has_prefs(i % role_count))
+            pref_values.append(pref_totals.at(i));
     }
 
     QTime tr;
@@ -574,15 +688,20 @@ void DFInstance::load_role_ratings(){
     bool calc_role_avg = (DT->get_log_manager()->get_appender("core")->minimum_level() <= LL_VERBOSE);
 
     QVector<double> all_role_ratings;
-    foreach(Dwarf *d, m_labor_capable_dwarves){
-        foreach(double rating, d->calc_role_ratings()){
-            all_role_ratings.append(rating);
-            if(calc_role_avg)
+    {
+        PROFILE_SCOPE("calc_role_ratings");
+        all_role_ratings = kernel.rate(m_labor_capable_dwarves, pref_totals);
+        for(int i = 0; i < m_labor_capable_dwarves.size(); i++)
+            m_labor_capable_dwarves.at(i)->set_raw_role_ratings(kernel.roles(), all_role_ratings.constData() + i * role_count);
+        if(calc_role_avg){
+            foreach(double rating, all_role_ratings)
                 role_rating_avg+=rating;
         }
     }
     LOGV << "Role Display Info:";
-    DwarfStats::roles.init(all_role_ratings);
+    m_sorted_raw_role_ratings = all_role_ratings;
+    std::sort(m_sorted_raw_role_ratings.begin(), m_sorted_raw_role_ratings.end());
+    DwarfStats::roles.init_sorted(m_sorted_raw_role_ratings);
     foreach(Dwarf *d, m_labor_capable_dwarves){
         d->refresh_role_display_ratings();
     }
@@ -592,12 +711,11 @@ void DFInstance::load_role_ratings(){
         float max = 0;
         float min = 0;
         float median = 0;
-        if(all_role_ratings.count() > 0){
-            std::sort(all_role_ratings.begin(), all_role_ratings.end());
-            role_rating_avg /= all_role_ratings.count();
-            max = all_role_ratings.last();
-            min = all_role_ratings.first();
-            median = RoleCalcBase::find_median(all_role_ratings);
+        if(m_sorted_raw_role_ratings.count() > 0){
+            role_rating_avg /= m_sorted_raw_role_ratings.count();
+            max = m_sorted_raw_role_ratings.last();
+            min = m_sorted_raw_role_ratings.first();
+            median = RoleCalcBase::find_median(m_sorted_raw_role_ratings);
         }
         LOGV << "Overall Role Rating Stats";
         LOGV << "     - Min: " << min;
@@ -608,6 +726,71 @@ void DFInstance::load_role_ratings(){
 
 }
 
+QVector<Dwarf*> DFInstance::get_labor_capable_dwarves() const{
+    //the list only lives while a read is processed, afterwards the model owns the units
+    if(!m_labor_capable_dwarves.isEmpty())
+        return m_labor_capable_dwarves;
+    QVector<Dwarf*> units;
+    foreach(Dwarf *d, DT->get_dwarves()){
+        if(!d->is_animal() && is_labor_capable(d))
+            units.append(d);
+    }
+    return units;
+}
+
+bool DFInstance::is_labor_capable(Dwarf *d){
+    //never calculate roles for babies
+    //only calculate roles for children if labor cheats are enabled
+    return !d->is_baby() && (!d->is_child() || DT->labor_cheats_allowed());
+}
+
+void DFInstance::update_role_ratings(const QStringList &role_names){
+    PROFILE_SCOPE("update_role_ratings");
+    const QVector<Dwarf*> units = get_labor_capable_dwarves();
+    if(units.isEmpty() || role_names.isEmpty())
+        return;
+
+    //drop the old ratings of the changed roles, and find the ones that still exist to rate them again
+    GameDataReader *gdr = GameDataReader::ptr();
+    QVector<double> removed;
+    QList<Role*> roles;
+    foreach(QString name, role_names.toSet()){
+        double rating;
+        foreach(Dwarf *d, units){
+            if(d->take_raw_role_rating(name, rating))
+                removed.append(rating);
+        }
+        Role *r = gdr->get_role(name);
+        if(r)
+            roles.append(r);
+    }
+
+    RoleKernel kernel(roles);
+    QVector<double> added = kernel.rate(units);
+    const int role_count = kernel.roles().size();
+    for(int i = 0; i < units.size(); i++){
+        Dwarf *d = units.at(i);
+        for(int r = 0; r < role_count; r++)
+            d->set_raw_role_rating(kernel.roles().at(r)->name(), added.at(i * role_count + r));
+    }
+
+    //update the sorted ratings with two linear passes instead of sorting the whole population again
+    std::sort(removed.begin(), removed.end());
+    std::sort(added.begin(), added.end());
+    QVector<double> kept;
+    kept.reserve(m_sorted_raw_role_ratings.size());
+    std::set_difference(m_sorted_raw_role_ratings.constBegin(), m_sorted_raw_role_ratings.constEnd(),
+                        removed.constBegin(), removed.constEnd(), std::back_inserter(kept));
+    m_sorted_raw_role_ratings.resize(kept.size() + added.size());
+    std::merge(kept.constBegin(), kept.constEnd(), added.constBegin(), added.constEnd(), m_sorted_raw_role_ratings.begin());
+
+    if(!m_sorted_raw_role_ratings.isEmpty())
+        DwarfStats::roles.init_sorted(m_sorted_raw_role_ratings);
+    foreach(Dwarf *d, units){
+        d->refresh_role_display_ratings();
+    }
+    LOGD << "updated ratings of" << role_names.count() << "roles," << removed.size() << "removed" << added.size() << "added";
+}
 
 void DFInstance::load_reactions(){
     attach();
@@ -774,6 +957,10 @@ const QString DFInstance::fortress_name(){
 }
 
 void DFInstance::refresh_data(){
+    PROFILE_SCOPE("refresh_data");
+    //the previous units are gone by now, let their allocation blocks drain
+    GenerationArena::begin_generation();
+    m_item_repo->begin_generation();
     VIRTADDR current_year = m_layout->global_address(this, "current_year");
     LOGD << "loading current year from" << hexify(current_year);
 
@@ -785,12 +972,22 @@ void DFInstance::refresh_data(){
     m_cur_time = df_date_convert<df_time>(date);
     m_cur_date = df_date<df_year, df_month, df_day>::make_date(m_cur_time);
 
-    load_occupations();
-    load_identities();
-    load_activities();
+    {
+        SubsystemScope ss(RS_HIST_FIGURES);
+        load_occupations();
+        load_identities();
+        load_activities();
+    }
     load_fortress();
-    load_squads(true);
-    load_items();
+    {
+        PROFILE_SCOPE("load_squads");
+        SubsystemScope ss(RS_SQUADS);
+        load_squads(true);
+    }
+    {
+        SubsystemScope ss(RS_ITEMS);
+        load_items();
+    }
     load_external_flag();
 }
 
@@ -917,11 +1114,50 @@ Squad* DFInstance::get_squad(int id){
 
 
 void DFInstance::heartbeat() {
-    // simple read attempt that will fail if the DF game isn't running a fort, or isn't running at all
-    // it would be nice to find a less cumbersome read, but for now at least we know this works
-    if(m_status != DFS_DISCONNECTED && get_creatures(false).size() < 1){
+    if(m_status == DFS_DISCONNECTED)
+        return;
+    // check the process first so a dead pid never costs a memory read, then
+    // make sure a fort is still loaded, then look for a swapped fort or a moving clock
+    if(!process_alive() || !probe_game_loaded()){
         send_connection_interrupted();
+        return;
+    }
+    probe_game_state();
+}
+
+//! reads only the bounds of the active unit vector instead of enumerating it
+bool DFInstance::probe_game_loaded(){
+    VIRTADDR units = m_layout->global_address(this, "active_creature_vector");
+    VIRTADDR start = read_addr(units);
+    VIRTADDR end = read_addr(units + m_pointer_size);
+    if(end > start){
+        if(m_status == DFS_LAYOUT_OK)
+            m_status = DFS_GAME_LOADED;
+        return true;
     }
+    // no active units yet, the embark screen keeps its own list
+    return !get_creatures(false).isEmpty();
+}
+
+//! compares the fortress and game clock with the previous heartbeat
+void DFInstance::probe_game_state(){
+    VIRTADDR fortress = read_addr(m_layout->global_address(this, "fortress_entity"));
+    if(m_probe_fortress && fortress != m_probe_fortress){
+        LOGI << "fortress entity changed from" << hexify(m_probe_fortress) << "to" << hexify(fortress);
+        m_probe_fortress = 0;
+        m_probe_time = -1;
+        emit fortress_changed();
+        return;
+    }
+    m_probe_fortress = fortress;
+
+    auto date = std::make_tuple(
+            df_year(read_word(m_layout->global_address(this, "current_year"))),
+            df_tick(read_int(m_layout->global_address(this, "cur_year_tick"))));
+    qint64 now = df_date_convert<df_time>(date).count();
+    if(m_probe_time >= 0 && now != m_probe_time)
+        emit game_time_advanced();
+    m_probe_time = now;
 }
 
 void DFInstance::send_connection_interrupted(){
@@ -1082,6 +1318,62 @@ QString DFInstance::read_dwarf_name(const VIRTADDR addr) {
     return result.trimmed();
 }
 
+QString DFInstance::file_checksum(const QString &path){
+    //identify the file without reading it, any rebuild or replacement of the binary changes the key
+    QString key;
+#ifndef Q_OS_WIN
+    struct stat st;
+    if(stat(QFile::encodeName(path).constData(), &st) == 0){ //follows /proc/<pid>/exe to the executable
+        //whole seconds would miss a rebuild written within the same second
+#ifdef Q_OS_MAC
+        const struct timespec &mtime = st.st_mtimespec;
+#else
+        const struct timespec &mtime = st.st_mtim;
+#endif
+        key = QString("%1-%2-%3-%4.%5").arg((qulonglong)st.st_dev).arg((qulonglong)st.st_ino)
+                .arg((qlonglong)st.st_size).arg((qlonglong)mtime.tv_sec)
+                .arg((qlonglong)mtime.tv_nsec, 9, 10, QChar('0'));
+    }
+#else
+    QFileInfo info(path);
+    if(info.exists())
+        key = QString("%1-%2").arg(info.size()).arg(info.lastModified().toMSecsSinceEpoch());
+#endif
+
+    QSettings *s = DT->user_settings();
+    const int max_entries = 8;
+    s->beginGroup("checksum_cache");
+    QString md5 = key.isEmpty() ? QString() : s->value(key).toString();
+    s->endGroup();
+    if(!md5.isEmpty()){
+        LOGI << "using cached checksum" << md5 << "for" << path;
+        return md5;
+    }
+
+    QFile exe(path);
+    if (!exe.open(QIODevice::ReadOnly)) {
+        LOGE << "FAILED TO READ DF EXECUTABLE:" << path;
+        return QString("UNKNOWN");
+    }
+    QCryptographicHash hash(QCryptographicHash::Md5);
+    if(!hash.addData(&exe)){
+        LOGE << "failed reading DF executable:" << path;
+        return QString("UNKNOWN");
+    }
+    md5 = hexify(hash.result().mid(0, 4)).toLower();
+    TRACE << "GOT MD5:" << md5;
+
+    if(!key.isEmpty()){
+        s->beginGroup("checksum_cache");
+        //only a few versions are ever installed at once, start over rather than tracking age
+        if(s->childKeys().count() >= max_entries)
+            s->remove("");
+        s->setValue(key, md5);
+        s->endGroup();
+    }
+    return md5;
+}
+
 void DFInstance::set_memory_layout(QString checksum){
     if(!checksum.isEmpty()){
         m_df_checksum = checksum.toLower();
@@ -1094,6 +1386,7 @@ void DFInstance::set_memory_layout(QString checksum){
 
     if(layout && layout->is_valid() && layout->is_complete()){
         m_layout = std::make_unique<MemoryLayout>(*layout);
+        m_item_repo->clear();
         m_status = DFS_LAYOUT_OK;
         LOGI << "Detected Dwarf Fortress version"
              << m_layout->game_version() << "using MemoryLayout from"
@@ -1108,6 +1401,89 @@ void DFInstance::set_memory_layout(QString checksum){
     }
 }
 
+QString DFInstance::subsystem_name(READ_SUBSYSTEM sub){
+    switch(sub){
+    case RS_UNITS: return tr("Units");
+    case RS_SOULS: return tr("Souls");
+    case RS_ITEMS: return tr("Items");
+    case RS_SQUADS: return tr("Squads");
+    case RS_HIST_FIGURES: return tr("Historical Figures");
+    case RS_LANGUAGES: return tr("Languages");
+    case RS_RAWS: return tr("Raws");
+    default: return tr("Other");
+    }
+}
+
+DFInstance::READ_SUBSYSTEM &DFInstance::thread_subsystem(){
+    thread_local READ_SUBSYSTEM sub = RS_OTHER;
+    return sub;
+}
+
+DFInstance::access_stats DFInstance::get_access_stats(READ_SUBSYSTEM sub) const{
+    const access_counters &c = m_access_stats[sub];
+    return access_stats{c.read_calls.load(std::memory_order_relaxed),
+                c.read_bytes.load(std::memory_order_relaxed),
+                c.read_failures.load(std::memory_order_relaxed),
+                c.write_calls.load(std::memory_order_relaxed),
+                c.write_bytes.load(std::memory_order_relaxed)};
+}
+
+DFInstance::access_stats DFInstance::total_access_stats() const{
+    access_stats total = {0, 0, 0, 0, 0};
+    for(int i = 0; i < RS_TOTAL_SUBSYSTEMS; i++){
+        const access_stats s = get_access_stats(static_cast<READ_SUBSYSTEM>(i));
+        total.read_calls += s.read_calls;
+        total.read_bytes += s.read_bytes;
+        total.read_failures += s.read_failures;
+        total.write_calls += s.write_calls;
+        total.write_bytes += s.write_bytes;
+    }
+    return total;
+}
+
+void DFInstance::reset_access_stats(){
+    for(int i = 0; i < RS_TOTAL_SUBSYSTEMS; i++){
+        access_counters &c = m_access_stats[i];
+        c.read_calls = 0;
+        c.read_bytes = 0;
+        c.read_failures = 0;
+        c.write_calls = 0;
+        c.write_bytes = 0;
+    }
+    m_freeze_stats = freeze_stats{0, 0, 0};
+}
+
+void DFInstance::freeze_started(){
+    m_freeze_timer.start();
+}
+
+void DFInstance::freeze_ended(){
+    if(!m_freeze_timer.isValid())
+        return;
+    qint64 elapsed = m_freeze_timer.elapsed();
+    m_freeze_timer.invalidate();
+    m_freeze_stats.count++;
+    m_freeze_stats.total_ms += elapsed;
+    m_freeze_stats.longest_ms = qMax(m_freeze_stats.longest_ms, elapsed);
+    LOGD << "game was stopped for" << elapsed << "ms";
+}
+
+void DFInstance::log_access_stats(){
+    for(int i = 0; i < RS_TOTAL_SUBSYSTEMS; i++){
+        const access_stats s = get_access_stats(static_cast<READ_SUBSYSTEM>(i));
+        if(s.read_calls == 0 && s.write_calls == 0)
+            continue;
+        LOGI << "  -" << subsystem_name(static_cast<READ_SUBSYSTEM>(i)) << ":"
+             << s.read_calls << "reads" << s.read_bytes << "bytes" << s.read_failures << "failed"
+             << s.write_calls << "writes" << s.write_bytes << "bytes";
+    }
+    access_stats total = total_access_stats();
+    LOGI << "  - Total:" << total.read_calls << "reads" << total.read_bytes << "bytes"
+         << total.read_failures << "failed" << total.write_calls << "writes";
+    LOGI << "  - Game stopped" << m_freeze_stats.count << "times for" << m_freeze_stats.total_ms
+         << "ms, longest" << m_freeze_stats.longest_ms << "ms";
+}
+
 const QStringList DFInstance::status_err_msg(){
     // return a list of message information for a QMessageBox
     // title, text, informativeText, detailedText
@@ -1170,6 +1546,7 @@ VIRTADDR DFInstance::find_historical_figure(int hist_id){
 }
 
 void DFInstance::load_hist_figures(){
+    SubsystemScope ss(RS_HIST_FIGURES);
     QVector<VIRTADDR> hist_figs = enumerate_vector(m_layout->global_address(this, "historical_figures_vector"));
     foreach(VIRTADDR fig, hist_figs){
         m_hist_figures.insert(read_int(m_layout->hist_figure_field(fig, "id")),fig);
@@ -1253,6 +1630,20 @@ QVector<VIRTADDR> DFInstance::get_itemdef_vector(ITEM_TYPE i){
 }
 
 QString DFInstance::get_preference_item_name(int index, int subtype){
+    quint64 key = (static_cast<quint64>(static_cast<quint32>(index)) << 32) | static_cast<quint32>(subtype);
+    {
+        QMutexLocker locker(&m_name_mutex);
+        auto it = m_pref_item_names.constFind(key);
+        if(it != m_pref_item_names.constEnd())
+            return *it;
+    }
+    QString name = resolve_preference_item_name(index, subtype);
+    QMutexLocker locker(&m_name_mutex);
+    m_pref_item_names.insert(key, name);
+    return name;
+}
+
+QString DFInstance::resolve_preference_item_name(int index, int subtype){
     ITEM_TYPE itype = static_cast<ITEM_TYPE>(index);
 
     if(Item::has_subtypes(itype)){
@@ -1336,6 +1727,27 @@ QString DFInstance::get_preference_other_name(int index, PREF_TYPES p_type){
 }
 
 QString DFInstance::find_material_name(int mat_index, short mat_type, ITEM_TYPE itype, MATERIAL_STATES mat_state){
+    //index(32) type(16) item type(12) state(4)
+    quint64 key = (static_cast<quint64>(static_cast<quint32>(mat_index)) << 32)
+            | (static_cast<quint64>(static_cast<quint16>(mat_type)) << 16)
+            | ((static_cast<quint64>(itype) & 0xFFF) << 4)
+            | (static_cast<quint64>(mat_state) & 0xF);
+    {
+        QMutexLocker locker(&m_name_mutex);
+        auto it = m_material_names.constFind(key);
+        if(it != m_material_names.constEnd())
+            return *it;
+    }
+    QString name = resolve_material_name(mat_index, mat_type, itype, mat_state);
+    //misses aren't kept, historical figures may not have been loaded yet
+    if(!name.isEmpty()){
+        QMutexLocker locker(&m_name_mutex);
+        m_material_names.insert(key, name);
+    }
+    return name;
+}
+
+QString DFInstance::resolve_material_name(int mat_index, short mat_type, ITEM_TYPE itype, MATERIAL_STATES mat_state){
     Material *m = find_material(mat_index, mat_type);
     QString name = "";
 
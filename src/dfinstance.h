@@ -29,6 +29,8 @@ THE SOFTWARE.
 #include "dftime.h"
 
 #include <QDir>
+#include <QElapsedTimer>
+#include <QMutex>
 #include <QPointer>
 #include <memory>
 #include <atomic>
@@ -48,6 +50,7 @@ class Dwarf;
 class FortressEntity;
 class ItemSubtype;
 class ItemWeaponSubtype;
+class ItemRepository;
 class Languages;
 class Material;
 class MemoryLayout;
@@ -69,6 +72,8 @@ public:
 
     virtual void find_running_copy() = 0;
     virtual bool df_running() = 0;
+    //! cheap check that the attached process still exists, used by the heartbeat
+    virtual bool process_alive() {return df_running();}
 
     typedef enum{
         DFS_DISCONNECTED = -1,
@@ -86,6 +91,57 @@ public:
     WORD dwarf_civ_id() {return m_dwarf_civ_id;}
     const QStringList status_err_msg();
 
+    // remote access accounting, every read/write is charged to the calling thread's current subsystem
+    typedef enum {
+        RS_OTHER = 0,
+        RS_UNITS,
+        RS_SOULS,
+        RS_ITEMS,
+        RS_SQUADS,
+        RS_HIST_FIGURES,
+        RS_LANGUAGES,
+        RS_RAWS,
+        RS_TOTAL_SUBSYSTEMS
+    } READ_SUBSYSTEM;
+
+    struct access_stats {
+        quint64 read_calls;
+        quint64 read_bytes;
+        quint64 read_failures;
+        quint64 write_calls;
+        quint64 write_bytes;
+    };
+
+    //! how long the game process was stopped while attached
+    struct freeze_stats {
+        quint64 count;
+        qint64 total_ms;
+        qint64 longest_ms;
+    };
+
+    static QString subsystem_name(READ_SUBSYSTEM sub);
+    access_stats get_access_stats(READ_SUBSYSTEM sub) const;
+    const freeze_stats &get_freeze_stats() const {return m_freeze_stats;}
+    access_stats total_access_stats() const;
+    void reset_access_stats();
+    void log_access_stats();
+    //! the subsystem is tracked per thread, so parallel passes don't charge each other's accesses
+    static READ_SUBSYSTEM current_subsystem() {return thread_subsystem();}
+
+    //! charges remote accesses made by this thread while in scope to a subsystem, restoring the previous one on exit
+    class SubsystemScope {
+    public:
+        explicit SubsystemScope(READ_SUBSYSTEM sub)
+            : m_prev(thread_subsystem())
+        {
+            thread_subsystem() = sub;
+        }
+        ~SubsystemScope() {thread_subsystem() = m_prev;}
+    private:
+        READ_SUBSYSTEM m_prev;
+        Q_DISABLE_COPY(SubsystemScope)
+    };
+
     // memory reading
     template<typename T> T read_mem(VIRTADDR addr) {
         T buf;
@@ -128,6 +184,7 @@ public:
 
     // Memory layouts
     MemoryLayout *memory_layout() {return m_layout.get();}
+    ItemRepository *item_repository() {return m_item_repo.get();}
     void set_memory_layout(QString checksum = QString());
 
     USIZE pointer_size() const { return m_pointer_size; }
@@ -148,10 +205,10 @@ public:
     static DFInstance * newInstance();
 
     // Methods for when we know how the data is layed out
-    void load_game_data();
+    virtual void load_game_data();
     void read_raws();
 
-    QVector<Dwarf*> load_dwarves();
+    virtual QVector<Dwarf*> load_dwarves();
     void load_reactions();
     void load_races_castes();
     void load_main_vectors();
@@ -164,9 +221,15 @@ public:
 
     void load_activities();
 
-    void refresh_data();
+    virtual void refresh_data();
+
+    //! the units which get role ratings, from the current read or the loaded units
+    QVector<Dwarf*> get_labor_capable_dwarves() const;
+
+    //! recalculate the raw ratings of only the given roles (added, edited or removed) and renormalize the display ratings
+    void update_role_ratings(const QStringList &role_names);
 
-    QList<Squad*> load_squads(bool show_progress);
+    virtual QList<Squad*> load_squads(bool show_progress);
     Squad * get_squad(int id);
 
     int get_labor_count(int id) const {return m_enabled_labor_count.value(id,0);}
@@ -192,8 +255,8 @@ public:
     FortressEntity * fortress() {return m_fortress;}
 
     struct pref_stat{
-        QStringList names_likes;
-        QStringList names_dislikes;
+        QList<int> likes; //!< unit ids, see DwarfTherapist::get_unit_names
+        QList<int> dislikes;
         QString pref_category;
     };
 
@@ -235,7 +298,7 @@ public:
         return m_plants_vector.value(index);
     }
     QString find_material_name(int mat_index, short mat_type, ITEM_TYPE itype, MATERIAL_STATES mat_state = SOLID);
-    const QHash<QPair<QString,QString>,pref_stat*> get_preference_stats() {return m_pref_counts;}
+    const QHash<QPair<QString,QString>,pref_stat> get_preference_stats() {return m_pref_counts;}
     const QHash<int, EmotionGroup*> get_emotion_stats() {return m_emotion_counts;}
     const QHash<ITEM_TYPE,EquipWarn*> get_equip_warnings(){return m_equip_warning_counts;}
 
@@ -265,6 +328,7 @@ protected:
     QString m_df_checksum;
     USIZE m_pointer_size;
     std::unique_ptr<MemoryLayout> m_layout;
+    std::unique_ptr<ItemRepository> m_item_repo;
     std::atomic_int m_attach_count;
     QTimer *m_heartbeat_timer;
     short m_dwarf_race_id;
@@ -272,15 +336,42 @@ protected:
     QDir m_df_dir;
     QVector<Dwarf*> m_actual_dwarves;
     QVector<Dwarf*> m_labor_capable_dwarves;
+    QVector<double> m_sorted_raw_role_ratings; //every raw role rating of the labor capable units, ascending
     df_time m_cur_time;
     std::tuple<df_year, df_month, df_day> m_cur_date;
     QHash<int,int> m_enabled_labor_count;
     DFI_STATUS m_status;
+    FortressEntity* m_fortress;
+    QString m_fortress_name;
+    QList<Squad*> m_squads;
 
     virtual bool set_pid() = 0;
 
+    //! truncated md5 of an executable, memoized on disk by device, inode, size and modification time (in nanoseconds)
+    static QString file_checksum(const QString &path);
+
+    //! platform attach/detach implementations report when the process is actually stopped and resumed
+    void freeze_started();
+    void freeze_ended();
+
+    //! platform read_raw/write_raw implementations report every access here
+    void count_read(USIZE requested, USIZE bytes_read) {
+        access_counters &s = m_access_stats[thread_subsystem()];
+        s.read_calls.fetch_add(1, std::memory_order_relaxed);
+        s.read_bytes.fetch_add(bytes_read, std::memory_order_relaxed);
+        if (bytes_read < requested)
+            s.read_failures.fetch_add(1, std::memory_order_relaxed);
+    }
+    void count_write(USIZE bytes_written) {
+        access_counters &s = m_access_stats[thread_subsystem()];
+        s.write_calls.fetch_add(1, std::memory_order_relaxed);
+        s.write_bytes.fetch_add(bytes_written, std::memory_order_relaxed);
+    }
+
+    void process_units(const QVector<Dwarf*> &units);
     void load_population_data();
     void load_role_ratings();
+    static bool is_labor_capable(Dwarf *d);
     bool check_vector(VIRTADDR start, VIRTADDR end, VIRTADDR addr);
 
     static PID select_pid(QSet<PID> pids);
@@ -291,13 +382,16 @@ private slots:
 signals:
     // methods for sending progress information to QWidgets
     void connection_interrupted();
+    //! the fortress entity changed between heartbeats (a different save was loaded)
+    void fortress_changed();
+    //! the in-game clock moved since the last heartbeat
+    void game_time_advanced();
     void progress_message(const QString &message);
     void progress_range(int min, int max);
     void progress_value(int value);
 
 private:
     Languages* m_languages;
-    FortressEntity* m_fortress;
     QHash<QString, Reaction *> m_reactions;
     QVector<Race *> m_races;
 
@@ -330,23 +424,47 @@ private:
     QVector<VIRTADDR> m_all_syndromes;
 
     QHash<ITEM_TYPE,EquipWarn*> m_equip_warning_counts;
-    QHash<QPair<QString,QString>, pref_stat*> m_pref_counts;
+    QHash<QPair<QString,QString>, pref_stat> m_pref_counts;
     QHash<int, EmotionGroup*> m_emotion_counts;
     needs_data m_needs_data;
 
-    QString m_fortress_name;
     QString m_fortress_name_translated;
 
     VIRTADDR m_squad_vector;
-    QList<Squad*> m_squads;
 
     int32_t m_external_flag;
 
+    //! access_stats that can be charged from several threads at once
+    struct access_counters {
+        std::atomic<quint64> read_calls;
+        std::atomic<quint64> read_bytes;
+        std::atomic<quint64> read_failures;
+        std::atomic<quint64> write_calls;
+        std::atomic<quint64> write_bytes;
+    };
+    access_counters m_access_stats[RS_TOTAL_SUBSYSTEMS];
+    static READ_SUBSYSTEM &thread_subsystem();
+    freeze_stats m_freeze_stats;
+    QElapsedTimer m_freeze_timer;
+
+    // display names already resolved from the raws, cleared when the raws are reloaded
+    QHash<quint64, QString> m_material_names;
+    QHash<quint64, QString> m_pref_item_names;
+    QMutex m_name_mutex;
+
+    // state seen by the previous heartbeat probe
+    VIRTADDR m_probe_fortress;
+    qint64 m_probe_time;
+
     void load_hist_figures();
     void load_occupations();
     void load_identities();
     void index_item_vector(ITEM_TYPE itype);
     void send_connection_interrupted();
+    QString resolve_material_name(int mat_index, short mat_type, ITEM_TYPE itype, MATERIAL_STATES mat_state);
+    QString resolve_preference_item_name(int index, int subtype);
+    bool probe_game_loaded();
+    void probe_game_state();
     void load_external_flag();
 };
 
@@ -27,7 +27,6 @@ THE SOFTWARE.
 
 #include <QDirIterator>
 #include <QTextCodec>
-#include <QCryptographicHash>
 
 #include <fstream>
 #include <regex>
@@ -35,6 +34,7 @@ THE SOFTWARE.
 #include <algorithm>
 
 #include <errno.h>
+#include <signal.h>
 #include <sys/mman.h>
 #include <sys/ptrace.h>
 #include <sys/syscall.h>
@@ -86,6 +86,7 @@ bool DFInstanceLinux::attach() {
     }
 
     wait_for_stopped();
+    freeze_started();
 
     TRACE << "FINISHED ATTACH" << attach_count;
     return true;
@@ -105,6 +106,7 @@ bool DFInstanceLinux::detach() {
     }
 
     ptrace(PTRACE_DETACH, m_pid, 0, 0);
+    freeze_ended();
     TRACE << "FINISHED DETACH" << attach_count;
     return true;
 }
@@ -116,8 +118,10 @@ USIZE DFInstanceLinux::read_raw(const VIRTADDR addr, const USIZE bytes, void *bu
     if (bytes_read == -1) {
         LOGE << "READ_RAW:" << QString(strerror(errno)) << "READING" << bytes << "BYTES FROM" << hexify(addr) << "TO" << buffer;
         memset(buffer, 0, bytes);
+        count_read(bytes, 0);
         return 0;
     }
+    count_read(bytes, bytes_read);
 
     TRACE << "Read" << bytes_read << "bytes of" << bytes << "bytes from" << hexify(addr) << "to" << buffer;
 
@@ -132,6 +136,7 @@ USIZE DFInstanceLinux::write_raw(const VIRTADDR addr, const USIZE bytes,
     struct iovec local_iov = {const_cast<void *>(buffer), bytes};
     struct iovec remote_iov = {reinterpret_cast<void *>(addr), bytes};
     SSIZE bytes_written = process_vm_writev(m_pid, &local_iov, 1, &remote_iov, 1, 0);
+    count_write(bytes_written == -1 ? 0 : bytes_written);
     if (bytes_written == -1) {
         LOGE << "WRITE_RAW:" << QString(strerror(errno)) << "WRITING" << bytes << "BYTES FROM" << buffer << "TO" << hexify(addr);
     } else if ((USIZE)bytes_written != bytes) {
@@ -212,14 +217,7 @@ void DFInstanceLinux::find_running_copy() {
         }
 
         // ELF binaries don't seem to store a linker timestamp, so just MD5 the file.
-        QCryptographicHash hash(QCryptographicHash::Md5);
-        char buffer[PAGE_SIZE];
-        exe.seekg(0);
-        while (exe.read(buffer, PAGE_SIZE))
-            hash.addData(buffer, PAGE_SIZE);
-        hash.addData(buffer, exe.gcount());
-        md5 = hexify(hash.result().mid(0, 4)).toLower();
-        TRACE << "GOT MD5:" << md5;
+        md5 = file_checksum(QString::fromStdString(proc_path + "/exe"));
     }
     else {
         LOGE << "Failed to open DF executable";
@@ -240,6 +238,11 @@ bool DFInstanceLinux::df_running(){
     return (set_pid() && cur_pid == m_pid);
 }
 
+bool DFInstanceLinux::process_alive(){
+    // signal 0 only checks that the pid exists, no /proc scan needed
+    return m_pid > 0 && (kill(m_pid, 0) == 0 || errno == EPERM);
+}
+
 static constexpr std::size_t STRING_BUFFER_LENGTH = 16;
 
 QString DFInstanceLinux::read_string(VIRTADDR addr) {
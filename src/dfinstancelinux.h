@@ -42,6 +42,7 @@ public:
     int VM_TYPE_OFFSET() {return 0x5;}
 
     bool df_running();
+    bool process_alive();
 
     bool attach();
     bool detach();
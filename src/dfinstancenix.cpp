@@ -1,8 +1,8 @@
 #include "dfinstancenix.h"
 #include "truncatingfilelogger.h"
-#include <QCryptographicHash>
-#include <QFile>
 #include <QTextCodec>
+#include <errno.h>
+#include <signal.h>
 
 struct STLStringHeader {
     USIZE length;
@@ -17,21 +17,7 @@ DFInstanceNix::DFInstanceNix(QObject *parent)
 
 QString DFInstanceNix::calculate_checksum() {
     // ELF binaries don't seem to store a linker timestamp, so just MD5 the file.
-    QFile proc(m_loc_of_dfexe);
-    QCryptographicHash hash(QCryptographicHash::Md5);
-    if (!proc.open(QIODevice::ReadOnly)) {
-        LOGE << "FAILED TO READ DF EXECUTABLE:" << m_loc_of_dfexe;
-        return QString("UNKNOWN");
-    }
-    // Qt 4 doesn't support QCryptographicHash::addData(QIODevice*)
-    char buf[4096];
-    qint64 len;
-    while ((len = proc.read(buf, sizeof(buf))) > 0) {
-        hash.addData(buf, len);
-    }
-    QString md5 = hexify(hash.result().mid(0, 4)).toLower();
-    TRACE << "GOT MD5:" << md5;
-    return md5;
+    return file_checksum(m_loc_of_dfexe);
 }
 
 QString DFInstanceNix::read_string(VIRTADDR addr) {
@@ -46,6 +32,11 @@ bool DFInstanceNix::df_running(){
     return (set_pid() && cur_pid == m_pid);
 }
 
+bool DFInstanceNix::process_alive(){
+    // signal 0 only checks that the pid exists, no /proc scan needed
+    return m_pid > 0 && (kill(m_pid, 0) == 0 || errno == EPERM);
+}
+
 USIZE DFInstanceNix::write_string(VIRTADDR addr, const QString &str) {
     // Ensure this operation is done as one transaction
     attach();
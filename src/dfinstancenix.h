@@ -14,6 +14,7 @@ public:
     USIZE write_string(const VIRTADDR addr, const QString &str);
 
     bool df_running();
+    bool process_alive();
 
 protected:
     pid_t m_pid;
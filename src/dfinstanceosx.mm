@@ -99,6 +99,7 @@ bool DFInstanceOSX::attach() {
         m_attach_count--;
         return false;
     }
+    freeze_started();
     return true;
 }
 
@@ -118,6 +119,7 @@ bool DFInstanceOSX::detach() {
     if ( result != KERN_SUCCESS ) {
         return false;
     }
+    freeze_ended();
 
     // temporarily drop privileges
     if (!drop_privileges()) {
@@ -134,6 +136,7 @@ USIZE DFInstanceOSX::read_raw(VIRTADDR addr, USIZE bytes, void *buffer) {
     attach();
     vm_read_overwrite(m_task, (vm_address_t)addr, bytes, (vm_address_t)buffer, static_cast<vm_size_t*>(&bytes_read));
     detach();
+    count_read(bytes, bytes_read);
     return bytes_read;
 }
 
@@ -141,6 +144,7 @@ USIZE DFInstanceOSX::write_raw(VIRTADDR addr, USIZE bytes, const void *buffer) {
     attach();
     kern_return_t result = vm_write(m_task, (vm_address_t)addr, (pointer_t)buffer, bytes);
     detach();
+    count_write(result == KERN_SUCCESS ? bytes : 0);
     return result == KERN_SUCCESS ? bytes : 0;
 }
 
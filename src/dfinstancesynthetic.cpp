@@ -0,0 +1,415 @@
+/*
+Dwarf Therapist
+Copyright (c) 2009 Trey Stout (chmod)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+#include "dfinstancesynthetic.h"
+#include "dwarf.h"
+#include "dwarftherapist.h"
+#include "fortressentity.h"
+#include "gamedatareader.h"
+#include "labor.h"
+#include "preference.h"
+#include "profession.h"
+#include "profiler.h"
+#include "role.h"
+#include "rolepreference.h"
+#include "squad.h"
+#include "trait.h"
+#include "truncatingfilelogger.h"
+#include "uniform.h"
+#include "unitneed.h"
+
+#include <QTime>
+#include <cstring>
+
+namespace {
+//! dwarven caste ranges from the creature raws, values are drawn from one of the six bands at random
+const int attribute_ranges[19][7] = {
+    {450, 1050, 1150, 1250, 1350, 1550, 2250}, //strength
+    {150,  600,  700,  800,  900, 1000, 1500}, //agility
+    {450, 1050, 1150, 1250, 1350, 1550, 2250}, //toughness
+    {450, 1050, 1150, 1250, 1350, 1550, 2250}, //endurance
+    {450,  950, 1150, 1250, 1350, 1550, 2250}, //recuperation
+    {450,  950, 1150, 1250, 1350, 1550, 2250}, //disease resistance
+    {450, 1050, 1150, 1250, 1350, 1550, 2250}, //analytical ability
+    {700, 1300, 1400, 1500, 1600, 1800, 2500}, //focus
+    {450, 1050, 1150, 1250, 1350, 1550, 2250}, //willpower
+    {450, 1050, 1150, 1250, 1350, 1550, 2250}, //creativity
+    {450,  950, 1150, 1250, 1350, 1550, 2250}, //intuition
+    {450, 1050, 1150, 1250, 1350, 1550, 2250}, //patience
+    {450, 1050, 1150, 1250, 1350, 1550, 2250}, //memory
+    {150,  600,  800,  900, 1000, 1100, 1500}, //linguistic ability
+    {700, 1300, 1400, 1500, 1600, 1800, 2500}, //spatial sense
+    {450,  950, 1150, 1250, 1350, 1550, 2250}, //musicality
+    {450,  950, 1150, 1250, 1350, 1550, 2250}, //kinesthetic sense
+    {150,  600,  800,  900, 1000, 1100, 1500}, //empathy
+    {150,  600,  800,  900, 1000, 1100, 1500}, //social awareness
+};
+
+const char *name_syllables[] = {
+    "ur", "ist", "dod", "ok", "zul", "bim", "ast", "kad", "mer", "lor",
+    "sib", "rig", "tho", "fath", "ing", "ez", "nish", "kol", "ath", "dum"
+};
+
+const char *pref_colors[] = {
+    "amber", "aquamarine", "cobalt", "crimson", "emerald", "gold", "ochre", "silver", "taupe", "violet"
+};
+
+const char *pref_shapes[] = {
+    "circles", "crescents", "hexagons", "spirals", "squares", "stars", "triangles"
+};
+
+const int squad_size = 10;
+}
+
+DFInstanceSynthetic::DFInstanceSynthetic(int unit_count, quint32 seed, QObject *parent)
+    : DFInstance(parent)
+    , m_unit_count(unit_count)
+    , m_seed(seed)
+    , m_rng(seed)
+{
+    m_df_checksum = QString("synthetic-%1").arg(seed);
+}
+
+DFInstanceSynthetic::~DFInstanceSynthetic() {
+}
+
+void DFInstanceSynthetic::find_running_copy() {
+    LOGI << "using a synthetic fortress of" << m_unit_count << "units (seed" << m_seed << ")";
+    m_status = DFS_GAME_LOADED;
+}
+
+USIZE DFInstanceSynthetic::read_raw(const VIRTADDR addr, const USIZE bytes, void *buffer) {
+    Q_UNUSED(addr);
+    memset(buffer, 0, bytes);
+    count_read(bytes, 0);
+    return 0;
+}
+
+QString DFInstanceSynthetic::read_string(const VIRTADDR addr) {
+    Q_UNUSED(addr);
+    return QString();
+}
+
+USIZE DFInstanceSynthetic::write_raw(const VIRTADDR addr, const USIZE bytes, const void *buffer) {
+    Q_UNUSED(addr);
+    Q_UNUSED(buffer);
+    count_write(bytes);
+    return bytes;
+}
+
+USIZE DFInstanceSynthetic::write_string(const VIRTADDR addr, const QString &str) {
+    Q_UNUSED(addr);
+    count_write(str.length());
+    return str.length();
+}
+
+void DFInstanceSynthetic::load_game_data() {
+    PROFILE_SCOPE("load_game_data");
+    emit progress_message(tr("Generating fortress"));
+    m_rng.seed(m_seed);
+
+    m_fortress_name = QString("%1%2").arg(generate_name()).arg(generate_name().toLower());
+    m_cur_time = df_date_convert<df_time>(std::make_tuple(df_year(250), df_tick(0)));
+    m_cur_date = df_date<df_year, df_month, df_day>::make_date(m_cur_time);
+
+    //the fortress' cultural values, most units share these
+    delete m_fortress;
+    m_fortress = new FortressEntity(this, 0, this);
+    std::normal_distribution<double> culture_dist(0.0, 15.0);
+    for(int i = 0; i < GameDataReader::ptr()->get_total_belief_count(); i++){
+        m_fortress->m_beliefs.insert(i, qBound(-50, (int)culture_dist(m_rng), 50));
+    }
+
+    m_role_prefs.clear();
+    foreach(Role *r, GameDataReader::ptr()->get_roles()){
+        for(const auto &p : r->prefs){
+            m_role_prefs.append(p.first.get());
+        }
+    }
+}
+
+void DFInstanceSynthetic::refresh_data() {
+    //nothing changes in between reads
+}
+
+QList<Squad*> DFInstanceSynthetic::load_squads(bool show_progress) {
+    Q_UNUSED(show_progress);
+    return m_squads;
+}
+
+QVector<Dwarf*> DFInstanceSynthetic::load_dwarves() {
+    PROFILE_SCOPE("load_dwarves");
+    QVector<Dwarf*> dwarves;
+    if (m_status != DFS_GAME_LOADED || !m_fortress) {
+        LOGE << "Could not generate units: synthetic fortress was not loaded";
+        return dwarves;
+    }
+
+    emit progress_message(tr("Generating Units"));
+    emit progress_range(0, m_unit_count-1);
+
+    //restart the sequence so every read returns the same population
+    m_rng.seed(m_seed + 1);
+
+    QTime t;
+    t.start();
+    dwarves.reserve(m_unit_count);
+    for(int i = 0; i < m_unit_count; i++){
+        dwarves.append(generate_unit(i));
+        emit progress_value(i);
+    }
+    generate_squads(dwarves);
+    LOGI << "generated" << dwarves.count() << "units in" << t.elapsed() << "ms";
+
+    process_units(dwarves);
+    return dwarves;
+}
+
+Dwarf *DFInstanceSynthetic::generate_unit(int id) {
+    GameDataReader *gdr = GameDataReader::ptr();
+    Dwarf *d = new Dwarf(this, 0, this);
+
+    d->m_id = id;
+    d->m_histfig_id = id;
+    d->m_race_id = m_dwarf_race_id;
+    d->m_first_name = generate_name();
+    d->m_last_name = generate_name() + generate_name().toLower();
+    d->m_translated_last_name = d->m_last_name;
+    d->m_gender_info.gender = chance(0.5) ? Dwarf::SEX_M : Dwarf::SEX_F;
+    d->m_gender_info.orientation = Dwarf::ORIENT_HETERO;
+    d->m_gender_info.male = Dwarf::COMMIT_UNINTERESTED;
+    d->m_gender_info.female = Dwarf::COMMIT_UNINTERESTED;
+    d->m_unit_flags << 0 << 0 << 0;
+    d->m_pending_flags = d->m_unit_flags;
+    d->m_curse_flags = 0;
+    d->m_pending_squad_id = -1;
+    d->m_pending_squad_position = -1;
+
+    //mostly adults, with a few children and babies
+    int roll = rand_range(0, 99);
+    if(roll < 4)
+        d->m_raw_prof_id = 104;
+    else if(roll < 12)
+        d->m_raw_prof_id = 103;
+    else
+        d->m_raw_prof_id = rand_range(0, 102);
+    d->m_raw_profession = gdr->get_profession(d->m_raw_prof_id);
+    d->m_prof_name = d->m_raw_profession ? d->m_raw_profession->name(d->is_male())
+                                         : tr("Unknown Profession %1").arg(d->m_raw_prof_id);
+    d->m_can_set_labors = d->m_raw_profession && d->m_raw_profession->can_assign_labors();
+
+    generate_attributes(d);
+    generate_skills(d);
+    generate_personality(d);
+    generate_preferences(d);
+    generate_labors(d);
+
+    d->build_names();
+    d->m_is_valid = true;
+    return d;
+}
+
+void DFInstanceSynthetic::generate_attributes(Dwarf *d) {
+    for(int i = 0; i < GameDataReader::ptr()->get_attributes().count(); i++){
+        const int *range = attribute_ranges[qMin(i, 18)];
+        int band = rand_range(0, 5);
+        int value = rand_range(range[band], range[band+1]);
+        Attribute a(static_cast<ATTRIBUTES_TYPE>(i), value, value, qMin(qMax(value * 2, value + 1000), 5000));
+        if(!d->is_baby())
+            a.calculate_balanced_value();
+        d->m_attributes.append(a);
+    }
+}
+
+void DFInstanceSynthetic::generate_skills(Dwarf *d) {
+    const auto &skills = GameDataReader::ptr()->get_ordered_skills();
+    if(skills.empty() || d->is_baby())
+        return;
+
+    //one or two trained skills, plus some dabbling in others
+    std::geometric_distribution<int> trained_dist(0.2);
+    std::geometric_distribution<int> dabbling_dist(0.6);
+    int trained = d->is_child() ? 0 : rand_range(1, 2);
+    int count = trained + rand_range(2, 8);
+    for(int i = 0; i < count; i++){
+        int skill_id = skills.at(rand_range(0, (int)skills.size()-1))->id;
+        if(d->has_skill(skill_id))
+            continue;
+        int level = i < trained ? 3 + trained_dist(m_rng) : dabbling_dist(m_rng);
+        level = qMin(level, 20);
+        int level_xp = Skill::get_xp_for_level(level+1) - Skill::get_xp_for_level(level);
+        int rust = chance(0.1) ? rand_range(0, level) : 0;
+        Skill s(skill_id, rand_range(0, qMax(0, level_xp-1)), level, rust);
+        s.calculate_balanced_level();
+        d->m_total_xp += s.actual_exp();
+        d->add_skill(s);
+        if(s.rust_level() > d->m_worst_rust_level)
+            d->m_worst_rust_level = s.rust_level();
+    }
+}
+
+void DFInstanceSynthetic::generate_personality(Dwarf *d) {
+    GameDataReader *gdr = GameDataReader::ptr();
+
+    //beliefs follow the fortress' culture, with the odd personal conviction
+    for(int belief_id = 0; belief_id < gdr->get_total_belief_count(); belief_id++){
+        int cultural = m_fortress->get_belief_value(belief_id);
+        if(chance(0.15)){
+            int val = qBound(-50, cultural + (chance(0.5) ? 1 : -1) * rand_range(10, 40), 50);
+            d->m_beliefs.insert(belief_id, UnitBelief(belief_id, val, true));
+        }else{
+            d->m_beliefs.insert(belief_id, UnitBelief(belief_id, cultural, false));
+        }
+    }
+
+    std::normal_distribution<double> facet_dist(50.0, 15.0);
+    for(int trait_id = 0; trait_id < gdr->get_total_trait_count(); trait_id++){
+        short val = qBound(0, (int)facet_dist(m_rng), 100);
+        d->m_traits.insert(trait_id, val);
+        foreach(int belief_id, gdr->get_trait(trait_id)->get_conflicting_beliefs()){
+            UnitBelief ub = d->get_unit_belief(belief_id);
+            if((ub.belief_value() > 10 && val < 40)  || (ub.belief_value() < -10 && val > 60)){
+                d->m_beliefs[belief_id].add_trait_conflict(trait_id);
+                d->m_conflicting_beliefs.insertMulti(trait_id, ub);
+            }
+        }
+    }
+    //combat hardened and cave adaptation, scaled as read_personality does
+    d->m_traits.insert(-1, 40);
+    d->m_traits.insert(-2, 40);
+
+    QList<QPair<int,QString> > goals = gdr->get_ordered_goals();
+    if(!goals.isEmpty() && d->is_adult()){
+        short realized = chance(0.1) ? 1 : 0;
+        d->m_goals.insert(goals.at(rand_range(0, goals.count()-1)).first, realized);
+        d->m_goals_realized += realized;
+    }
+
+    //a dozen or so needs, mostly satisfied, some neglected
+    int need_count = gdr->get_need_count();
+    if(need_count > 0 && !d->is_baby()){
+        static const int need_levels[] = {1, 1, 2, 2, 5, 10};
+        int count = rand_range(qMin(8, need_count), qMin(15, need_count));
+        for(int i = 0; i < count; i++){
+            int need_id = rand_range(0, need_count-1);
+            if(d->m_needs.count(need_id))
+                continue;
+            int focus = chance(0.8) ? rand_range(-999, 400) : -rand_range(1000, 150000);
+            auto need = std::make_unique<UnitNeed>(need_id, -1, focus, need_levels[rand_range(0, 5)], d);
+            d->m_needs.emplace(need_id, std::move(need));
+        }
+        d->m_undistracted_focus = 100;
+        d->m_current_focus = qBound(40, (int)std::normal_distribution<double>(105.0, 15.0)(m_rng), 160);
+        d->update_focus_degree();
+    }
+
+    std::normal_distribution<double> stress_dist(-10000.0, 25000.0);
+    d->m_stress_level = (int)stress_dist(m_rng);
+    d->m_happiness = Dwarf::happiness_from_stress(d->m_stress_level);
+}
+
+void DFInstanceSynthetic::generate_preferences(Dwarf *d) {
+    static const int color_count = sizeof(pref_colors) / sizeof(pref_colors[0]);
+    static const int shape_count = sizeof(pref_shapes) / sizeof(pref_shapes[0]);
+
+    std::vector<std::unique_ptr<Preference>> prefs;
+    int count = m_role_prefs.isEmpty() ? 0 : rand_range(2, 6);
+    for(int i = 0; i < count; i++){
+        const RolePreference *rp = m_role_prefs.at(rand_range(0, m_role_prefs.count()-1));
+        if(auto irp = dynamic_cast<const ItemRolePreference*>(rp))
+            prefs.push_back(std::make_unique<ItemPreference>(irp->get_item_type(), rp->get_name().toLower()));
+        else
+            prefs.push_back(std::make_unique<Preference>(rp->get_pref_category(), rp->get_name().toLower()));
+    }
+    prefs.push_back(std::make_unique<Preference>(LIKE_COLOR, pref_colors[rand_range(0, color_count-1)]));
+    if(chance(0.5))
+        prefs.push_back(std::make_unique<Preference>(LIKE_SHAPE, pref_shapes[rand_range(0, shape_count-1)]));
+
+    for(auto &p : prefs){
+        PREF_TYPES pref_type = p->get_pref_category();
+        d->m_pref_names.append(p->get_name());
+        d->m_preferences.emplace(pref_type, std::move(p));
+    }
+    d->group_preferences();
+}
+
+void DFInstanceSynthetic::generate_labors(Dwarf *d) {
+    //labors lean towards the unit's own skills
+    foreach(Labor *l, GameDataReader::ptr()->get_ordered_labors()){
+        bool enabled = false;
+        if(d->m_can_set_labors){
+            if(d->has_skill(l->skill_id))
+                enabled = chance(0.7);
+            else if(l->is_hauling)
+                enabled = chance(0.5);
+            else
+                enabled = chance(0.1);
+        }
+        d->m_labors[l->labor_id] = enabled;
+        d->m_pending_labors[l->labor_id] = enabled;
+    }
+}
+
+void DFInstanceSynthetic::generate_squads(const QVector<Dwarf*> &dwarves) {
+    qDeleteAll(m_squads);
+    m_squads.clear();
+
+    //roughly one adult in ten serves, in squads of ten
+    Squad *s = 0;
+    foreach(Dwarf *d, dwarves){
+        if(!d->is_adult() || !chance(0.1))
+            continue;
+        int position = s ? s->find_position(-1) : -1;
+        if(position < 0){
+            s = new Squad(m_squads.count(), this, 0, this);
+            s->m_name = tr("Squad %1").arg(m_squads.count() + 1);
+            s->m_pending_name = s->m_name;
+            //every position gets an (empty) uniform so units can be moved between squads
+            for(int pos = 0; pos < squad_size; pos++){
+                s->m_members.insert(pos, -1);
+                s->m_uniforms.insert(pos, new Uniform(this, s));
+            }
+            m_squads.append(s);
+            position = 0;
+        }
+        s->m_members.insert(position, d->m_histfig_id);
+        d->m_squad_id = d->m_pending_squad_id = s->id();
+        d->m_squad_position = d->m_pending_squad_position = position;
+        d->m_pending_squad_name = s->name();
+    }
+}
+
+QString DFInstanceSynthetic::generate_name() {
+    static const int count = sizeof(name_syllables) / sizeof(name_syllables[0]);
+    QString name = QString(name_syllables[rand_range(0, count-1)]) + name_syllables[rand_range(0, count-1)];
+    return capitalize(name);
+}
+
+int DFInstanceSynthetic::rand_range(int min, int max) {
+    std::uniform_int_distribution<int> dist(min, max);
+    return dist(m_rng);
+}
+
+bool DFInstanceSynthetic::chance(double probability) {
+    std::bernoulli_distribution dist(probability);
+    return dist(m_rng);
+}
@@ -0,0 +1,90 @@
+/*
+Dwarf Therapist
+Copyright (c) 2009 Trey Stout (chmod)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+#ifndef DFINSTANCE_SYNTHETIC_H
+#define DFINSTANCE_SYNTHETIC_H
+#include "dfinstance.h"
+
+#include <random>
+
+class RolePreference;
+
+//! an instance with no game behind it, units are generated from the game data definitions
+/*!
+  Used to profile and benchmark the model, views, roles and optimizer against fortresses of an
+  arbitrary size (--synthetic <units> or dt_bench). Units get attributes, skills, facets, beliefs,
+  goals, needs, preferences, labors and squads with roughly the spread of a real fortress.
+
+  Generation is deterministic: the same unit count, seed and game data always produce the same
+  fortress, so a run can be replayed by passing the same parameters. All memory access is answered
+  with zeroes and writes are discarded, committed changes last until the next read.
+*/
+class DFInstanceSynthetic : public DFInstance {
+    Q_OBJECT
+public:
+    DFInstanceSynthetic(int unit_count, quint32 seed = 1, QObject *parent=0);
+    virtual ~DFInstanceSynthetic();
+
+    void find_running_copy();
+    bool df_running() {return true;}
+
+    USIZE read_raw(const VIRTADDR addr, const USIZE bytes, void *buffer);
+    QString read_string(const VIRTADDR addr);
+
+    USIZE write_raw(const VIRTADDR addr, const USIZE bytes, const void *buffer);
+    USIZE write_string(const VIRTADDR addr, const QString &str);
+
+    bool attach() {return true;}
+    bool detach() {return true;}
+
+    void load_game_data();
+    void refresh_data();
+    QVector<Dwarf*> load_dwarves();
+    QList<Squad*> load_squads(bool show_progress);
+
+    int unit_count() const {return m_unit_count;}
+    quint32 seed() const {return m_seed;}
+
+protected:
+    bool set_pid() {return true;}
+
+private:
+    int m_unit_count;
+    quint32 m_seed;
+    std::mt19937 m_rng;
+    //! every preference used by a role, units draw their likes from these
+    QVector<const RolePreference*> m_role_prefs;
+
+    Dwarf *generate_unit(int id);
+    void generate_attributes(Dwarf *d);
+    void generate_skills(Dwarf *d);
+    void generate_personality(Dwarf *d);
+    void generate_preferences(Dwarf *d);
+    void generate_labors(Dwarf *d);
+    void generate_squads(const QVector<Dwarf*> &dwarves);
+    QString generate_name();
+
+    int rand_range(int min, int max);
+    bool chance(double probability);
+};
+
+#endif // DFINSTANCE_SYNTHETIC_H
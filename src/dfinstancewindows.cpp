@@ -140,6 +140,7 @@ USIZE DFInstanceWindows::read_raw(VIRTADDR addr, USIZE bytes, void *buffer) {
         DWORD error = GetLastError();
         LOGE << "ReadProcessMemory failed:" << get_error_string(error);
     }
+    count_read(bytes, bytes_read);
     return bytes_read;
 }
 
@@ -150,6 +151,7 @@ USIZE DFInstanceWindows::write_raw(VIRTADDR addr, USIZE bytes, const void *buffe
         DWORD error = GetLastError();
         LOGE << "WriteProcessMemory failed:" << get_error_string(error);
     }
+    count_write(bytes_written);
     Q_ASSERT(bytes_written == bytes);
     return bytes_written;
 }
@@ -231,6 +233,11 @@ bool DFInstanceWindows::df_running(){
     return (set_pid() && cur_pid == m_pid);
 }
 
+bool DFInstanceWindows::process_alive(){
+    DWORD code = 0;
+    return m_proc && GetExitCodeProcess(m_proc, &code) && code == STILL_ACTIVE;
+}
+
 void DFInstanceWindows::find_running_copy() {
     m_status = DFS_DISCONNECTED;
     LOGI << "attempting to find running copy of DF";
@@ -38,6 +38,7 @@ public:
 
     void find_running_copy();
     bool df_running();
+    bool process_alive();
 
     USIZE read_raw(VIRTADDR addr, USIZE bytes, void *buffer);
     QString read_string(VIRTADDR addr);
@@ -0,0 +1,308 @@
+/*
+Dwarf Therapist
+Copyright (c) 2009 Trey Stout (chmod)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+/*! dt_bench: microbenchmarks for the hot paths of a unit refresh and a grid redraw.
+ *
+ * Populations are generated by DFInstanceSynthetic, so no running game is needed. Each case is
+ * repeated until it has run for at least --min-time milliseconds and the results are written as
+ * JSON (to stdout, or --output <path>).
+ */
+
+#include "dwarftherapist.h"
+#include "dfinstancesynthetic.h"
+#include "dwarf.h"
+#include "dwarfmodel.h"
+#include "dwarfmodelproxy.h"
+#include "gamedatareader.h"
+#include "gridview.h"
+#include "laboroptimizer.h"
+#include "laboroptimizerplan.h"
+#include "mainwindow.h"
+#include "role.h"
+#include "rolecalcbase.h"
+#include "rolekernel.h"
+#include "rolestats.h"
+#include "uberdelegate.h"
+#include "viewmanager.h"
+
+#include <QElapsedTimer>
+#include <QFile>
+#include <QImage>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QPainter>
+#include <QTextStream>
+#include <algorithm>
+#include <cstdio>
+
+namespace {
+
+struct bench_options {
+    QList<int> sizes;
+    quint32 seed;
+    qint64 min_time_ms;
+    QStringList views;
+    QString output;
+};
+
+bench_options parse_options(int argc, char **argv) {
+    bench_options opts;
+    opts.sizes << 50 << 500 << 2000 << 10000;
+    opts.seed = 1;
+    opts.min_time_ms = 200;
+    opts.views << "Labors Full" << "Roles";
+
+    for (int i = 1; i < argc; i++) {
+        QString arg = QString::fromLocal8Bit(argv[i]);
+        QString val = (i + 1 < argc) ? QString::fromLocal8Bit(argv[i + 1]) : QString();
+        if (arg == "--sizes") {
+            opts.sizes.clear();
+            foreach(QString s, val.split(",", QString::SkipEmptyParts)) {
+                opts.sizes << s.toInt();
+            }
+            i++;
+        } else if (arg == "--seed") {
+            opts.seed = val.toUInt();
+            i++;
+        } else if (arg == "--min-time") {
+            opts.min_time_ms = val.toLongLong();
+            i++;
+        } else if (arg == "--views") {
+            opts.views = val.split(",", QString::SkipEmptyParts);
+            i++;
+        } else if (arg == "--output") {
+            opts.output = val;
+            i++;
+        } else {
+            fprintf(stderr, "usage: dt_bench [--sizes 50,500,2000,10000] [--seed n] [--min-time ms]"
+                            " [--views name,name] [--output path]\n");
+            exit(arg == "--help" ? 0 : 1);
+        }
+    }
+    return opts;
+}
+
+class Bench {
+public:
+    Bench(const bench_options &opts)
+        : m_opts(opts)
+    {}
+
+    //! repeat fn until the minimum run time has passed, items is the amount of work done per call
+    template<typename F>
+    void run(const QString &name, int units, int items, F fn) {
+        QElapsedTimer t;
+        int iterations = 0;
+        t.start();
+        do {
+            fn();
+            iterations++;
+        } while (t.elapsed() < m_opts.min_time_ms);
+        qint64 ns = t.nsecsElapsed();
+
+        QJsonObject r;
+        r.insert("name", name);
+        r.insert("units", units);
+        r.insert("items", items);
+        r.insert("iterations", iterations);
+        r.insert("total_ms", ns / 1e6);
+        r.insert("mean_us", ns / 1e3 / iterations);
+        r.insert("per_item_ns", items > 0 ? (double)ns / iterations / items : 0.0);
+        m_results.append(r);
+        fprintf(stderr, "%-32s %6d units %10.1f us/iter (%d iterations)\n",
+                qPrintable(name), units, ns / 1e3 / iterations, iterations);
+    }
+
+    QJsonArray results() const {return m_results;}
+
+private:
+    const bench_options &m_opts;
+    QJsonArray m_results;
+};
+
+void bench_roles(Bench &b, int units, const QVector<Dwarf*> &dwarves) {
+    QList<Role*> roles = GameDataReader::ptr()->get_roles().values();
+
+    QVector<double> ratings;
+    foreach(Dwarf *d, dwarves) {
+        foreach(double r, d->calc_role_ratings()) {
+            ratings.append(r);
+        }
+    }
+
+    b.run("RoleStats::set_mode", units, ratings.size(), [&ratings] {
+        RoleStats stats(ratings);
+        Q_UNUSED(stats);
+    });
+
+    QVector<double> sorted = ratings;
+    std::sort(sorted.begin(), sorted.end());
+    RoleCalcBase calc(sorted);
+    b.run("RoleCalcBase::base_rating", units, ratings.size(), [&ratings, &calc] {
+        double sum = 0;
+        foreach(double r, ratings) {
+            sum += calc.base_rating(r);
+        }
+        Q_UNUSED(sum);
+    });
+
+    b.run("Dwarf::calc_role_rating", units, dwarves.size() * roles.size(), [&dwarves, &roles] {
+        foreach(Dwarf *d, dwarves) {
+            foreach(Role *r, roles) {
+                d->calc_role_rating(r);
+            }
+        }
+    });
+
+    RoleKernel kernel(roles);
+    b.run("RoleKernel::rate", units, dwarves.size() * roles.size(), [&dwarves, &kernel] {
+        QVector<double> ratings = kernel.rate(dwarves);
+        Q_UNUSED(ratings);
+    });
+}
+
+void bench_optimizer(Bench &b, int units, const QVector<Dwarf*> &dwarves) {
+    QList<QPair<QString, laborOptimizerPlan*> > plans = GameDataReader::ptr()->get_ordered_opt_plans();
+    if (plans.isEmpty()) {
+        fprintf(stderr, "no optimization plans defined, skipping LaborOptimizer::optimize\n");
+        return;
+    }
+    QList<Dwarf*> candidates;
+    foreach(Dwarf *d, dwarves) {
+        if (d->can_set_labors())
+            candidates.append(d);
+    }
+    LaborOptimizer optimizer(plans.first().second);
+    b.run("LaborOptimizer::optimize", units, candidates.size(), [&optimizer, &candidates] {
+        optimizer.optimize_labors(candidates);
+    });
+}
+
+void bench_view(Bench &b, int units, DFInstance *df, GridView *gv) {
+    DwarfModel model;
+    DwarfModelProxy proxy;
+    proxy.setSourceModel(&model);
+    model.set_instance(df);
+    model.set_grid_view(gv);
+    model.load_dwarves();
+
+    const QString suffix = QString(" [%1]").arg(gv->name());
+    b.run("DwarfModel::build_rows" + suffix, units, units, [&model] {
+        model.build_rows();
+    });
+
+    //every filter change re-runs filterAcceptsRow over all of the rows
+    bool toggle = false;
+    b.run("DwarfModelProxy::filterAcceptsRow" + suffix, units, model.rowCount(), [&proxy, &toggle] {
+        proxy.setFilterFixedString(toggle ? "ur" : "ist");
+        toggle = !toggle;
+    });
+    proxy.setFilterFixedString("");
+
+    UberDelegate delegate;
+    delegate.set_model(&model);
+    delegate.set_proxy(&proxy);
+    const int cell_size = 16;
+    const int rows = qMin(proxy.rowCount(), 60);
+    const int cols = qMin(proxy.columnCount(), 120);
+    QImage canvas(cols * cell_size, rows * cell_size, QImage::Format_ARGB32_Premultiplied);
+    b.run("UberDelegate::paint" + suffix, units, rows * cols, [&] {
+        QPainter p(&canvas);
+        QStyleOptionViewItem opt;
+        for (int r = 0; r < rows; r++) {
+            for (int c = 0; c < cols; c++) {
+                opt.rect = QRect(c * cell_size, r * cell_size, cell_size, cell_size);
+                delegate.paint(&p, opt, proxy.index(r, c));
+            }
+        }
+    });
+
+    model.clear_all(false);
+}
+
+}
+
+int main(int argc, char *argv[]) {
+    bench_options opts = parse_options(argc, argv);
+
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM"))
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+
+    // the application has its own command line, don't hand it ours
+    static int app_argc = 1;
+    DwarfTherapist app(app_argc, argv);
+
+    MainWindow *mw = DT->get_main_window();
+    QJsonArray results;
+    foreach(int units, opts.sizes) {
+        DFInstanceSynthetic *df = new DFInstanceSynthetic(units, opts.seed);
+        df->find_running_copy();
+        df->load_game_data();
+        mw->set_instance(df);
+        mw->get_view_manager()->reload_views();
+
+        Bench b(opts);
+        QVector<Dwarf*> dwarves = df->load_dwarves();
+        b.run("DFInstance::load_dwarves", units, units, [df] {
+            qDeleteAll(df->load_dwarves());
+        });
+        bench_roles(b, units, dwarves);
+        bench_optimizer(b, units, dwarves);
+        qDeleteAll(dwarves);
+
+        foreach(QString name, opts.views) {
+            GridView *gv = mw->get_view_manager()->get_view(name);
+            if (gv)
+                bench_view(b, units, df, gv);
+            else
+                fprintf(stderr, "no grid view named '%s', skipping\n", qPrintable(name));
+        }
+
+        foreach(QJsonValue r, b.results()) {
+            results.append(r);
+        }
+    }
+    mw->set_instance(0);
+
+    QJsonObject root;
+    root.insert("tool", QString("dt_bench"));
+    root.insert("version", QCoreApplication::applicationVersion());
+    root.insert("qt", QString(qVersion()));
+    root.insert("seed", (qint64)opts.seed);
+    root.insert("min_time_ms", opts.min_time_ms);
+    root.insert("results", results);
+    QByteArray json = QJsonDocument(root).toJson();
+
+    if (opts.output.isEmpty()) {
+        fwrite(json.constData(), 1, json.size(), stdout);
+    } else {
+        QFile f(opts.output);
+        if (!f.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+            fprintf(stderr, "could not write %s\n", qPrintable(opts.output));
+            return 1;
+        }
+        f.write(json);
+    }
+    return 0;
+}
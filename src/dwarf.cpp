@@ -124,7 +124,9 @@ Dwarf::Dwarf(DFInstance *df, VIRTADDR addr, QObject *parent)
     , m_curse_type(eCurse::NONE)
 {
     read_settings();
-    read_data();
+    //units without an address are filled in by their creator (synthetic populations)
+    if(m_address)
+        read_data();
     connect(DT, SIGNAL(settings_changed()), this, SLOT(read_settings()));
 
     // setup context actions
@@ -202,8 +204,7 @@ void Dwarf::read_settings() {
        send signals when this stuff changes, or just bite the bullet and
        subclass the QStandardItem for the name items in the main model
        */
-    QSettings *s = DT->user_settings();
-    bool new_show_full_name = s->value("options/show_full_dwarf_names",false).toBool();
+    bool new_show_full_name = DT->settings().show_full_dwarf_names;
     if (new_show_full_name != m_show_full_name) {
         build_names();
         emit name_changed();
@@ -275,7 +276,10 @@ void Dwarf::read_data() {
     }
 
     if(m_is_valid){
-        m_hist_figure = new HistFigure(m_histfig_id,m_df,this);
+        {
+            DFInstance::SubsystemScope ss(DFInstance::RS_HIST_FIGURES);
+            m_hist_figure = new HistFigure(m_histfig_id,m_df,this);
+        }
         // use fake identity to match DF
         find_fake_ident();
         read_squad_info(); //read squad before job
@@ -295,7 +299,7 @@ void Dwarf::read_data() {
         read_noble_position();
         read_preferences();
 
-        m_unit_health = UnitHealth(m_df,this,!DT->user_settings()->value("options/diagnosis_not_required", false).toBool());
+        m_unit_health = UnitHealth(m_df,this,!DT->settings().diagnosis_not_required);
         read_inventory();
 
         if(m_is_animal || m_nice_name == "")
@@ -433,8 +437,7 @@ static const char *sex_interest_icon_suffix (Dwarf::SEX_COMMITMENT interest)
 }
 
 void Dwarf::read_gender_orientation() {
-    QSettings *s = DT->user_settings();
-    auto gender_info_option = s->value("options/gender_info", Option_ShowOrientation).toInt();
+    auto gender_info_option = DT->settings().gender_info;
     bool show_orientation = gender_info_option >= Option_ShowOrientation;
     //bool show_commitment = !m_is_animal && gender_info_option >= Option_ShowCommitment;
     bool show_commitment = false; // hide commitment until it is better understood
@@ -678,7 +681,7 @@ void Dwarf::read_first_name() {
 
 void Dwarf::read_last_name(VIRTADDR name_offset) {
     //Generic
-    bool use_generic = DT->user_settings()->value("options/use_generic_names", false).toBool();
+    bool use_generic = DT->settings().use_generic_names;
 
     m_translated_last_name = m_df->get_translated_word(name_offset);
     if (use_generic)
@@ -897,8 +900,11 @@ void Dwarf::read_preferences(){
         m_pref_names.append(p->get_name());
         m_preferences.emplace(pref_type, std::move(p));
     }
+    group_preferences();
+}
 
-    bool build_tooltip = (!m_is_animal && !m_preferences.empty() && DT->user_settings()->value("options/tooltip_show_preferences",true).toBool());
+void Dwarf::group_preferences(){
+    bool build_tooltip = (!m_is_animal && !m_preferences.empty() && DT->settings().tooltip_show_preferences);
     //group preferences into pref desc - values (string list)
     QString desc_key;
     //lists for the tooltip
@@ -961,7 +967,7 @@ void Dwarf::read_syndromes(){
     m_syndromes.clear();
     QVector<VIRTADDR> active_unit_syns = m_df->enumerate_vector(m_mem->dwarf_field(m_address, "active_syndrome_vector"));
     //when showing syndromes, be sure to exclude 'vampcurse' and 'werecurse' if we're hiding cursed dwarves
-    bool show_cursed = DT->user_settings()->value("options/highlight_cursed",false).toBool();
+    bool show_cursed = DT->settings().highlight_cursed;
     bool is_curse = false;
     foreach(VIRTADDR syn, active_unit_syns){
         Syndrome s = Syndrome(m_df,syn);
@@ -1059,7 +1065,7 @@ QString Dwarf::syndromes(){
 }
 
 QString Dwarf::get_syndrome_names(bool include_buffs, bool include_sick) {
-    short d_type = DT->user_settings()->value("options/syndrome_display_type",0).toInt();
+    short d_type = DT->settings().syndrome_display_type;
     bool show_name = (d_type == 0 || d_type ==2);
     bool show_class = (d_type >= 1);
     QStringList names;
@@ -1151,7 +1157,7 @@ void Dwarf::read_current_job(){
         m_current_job_id = m_df->read_short(m_mem->job_field(current_job_addr, "id"));
 
         //if drinking blood and we're not showing vamps, change job to drink
-        if(m_current_job_id == (int)DwarfJob::JOB_DRINK_BLOOD && DT->user_settings()->value("options/highlight_cursed", false).toBool()==false){
+        if(m_current_job_id == (int)DwarfJob::JOB_DRINK_BLOOD && !DT->settings().highlight_cursed){
             m_current_job_id = 17; //DRINK
         }
 
@@ -1236,6 +1242,7 @@ void Dwarf::read_current_job(){
 }
 
 bool Dwarf::read_soul(){
+    DFInstance::SubsystemScope ss(DFInstance::RS_SOULS);
     VIRTADDR soul_vector = m_mem->dwarf_field(m_address, "souls");
     QVector<VIRTADDR> souls = m_df->enumerate_vector(soul_vector);
     if (souls.size() != 1) {
@@ -1247,6 +1254,7 @@ bool Dwarf::read_soul(){
 }
 
 void Dwarf::read_soul_aspects() {
+    DFInstance::SubsystemScope ss(DFInstance::RS_SOULS);
     if(!m_first_soul){
         if(!read_soul()){
             return;
@@ -1566,6 +1574,7 @@ void Dwarf::read_squad_info() {
 }
 
 void Dwarf::read_uniform(){
+    DFInstance::SubsystemScope ss(DFInstance::RS_ITEMS);
     if(!m_is_animal && is_adult()){
         if(m_pending_squad_id >= 0){
             Squad *s = m_df->get_squad(m_pending_squad_id);
@@ -1598,6 +1607,7 @@ void Dwarf::read_uniform(){
 }
 
 void Dwarf::read_inventory(){
+    DFInstance::SubsystemScope ss(DFInstance::RS_ITEMS);
     LOGD << "reading inventory for" << m_nice_name;
     m_coverage_ratings.clear();
     m_max_inventory_wear.clear();
@@ -1618,7 +1628,7 @@ void Dwarf::read_inventory(){
     short bp_id = -1;
     QString category_name = "";
     int inv_count = 0;
-    bool include_mat_name = DT->user_settings()->value("options/docks/equipoverview_include_mats",false).toBool();
+    bool include_mat_name = DT->settings().equipoverview_include_mats;
     foreach(VIRTADDR inventory_item_addr, m_df->enumerate_vector(m_mem->dwarf_field(m_address, "inventory"))){
         inv_type = m_df->read_short(m_mem->dwarf_field(inventory_item_addr, "inventory_item_mode"));
         bp_id = m_df->read_short(m_mem->dwarf_field(inventory_item_addr, "inventory_item_bodypart"));
@@ -1839,8 +1849,9 @@ void Dwarf::read_skills() {
     if(m_caste)
         m_caste->load_skill_rates();
 
-    QMultiMap<int,Skill> skills_by_level;
+    QMultiMap<int,int> skills_by_level; //raw level, skill_id
 
+    m_skills.resize(GameDataReader::ptr()->get_total_skill_count());
     foreach(VIRTADDR entry, entries) {
         skill_id = m_df->read_short(entry);
         rating = m_df->read_short(entry + 0x04);
@@ -1859,10 +1870,9 @@ void Dwarf::read_skills() {
         }
 
         m_total_xp += s.actual_exp();
-        m_skills.insert(s.id(),s);
-        m_sorted_skills.insertMulti(s.capped_level_precise(), s.id());
+        add_skill(s);
         if(!m_had_mood && GameDataReader::ptr()->moodable_skills().contains(skill_id)){
-            skills_by_level.insertMulti(s.raw_level(),s);
+            skills_by_level.insertMulti(s.raw_level(),s.id());
         }
 
         if(s.rust_level() > m_worst_rust_level)
@@ -1871,16 +1881,23 @@ void Dwarf::read_skills() {
 
     if(!m_had_mood){
         if(skills_by_level.count() > 0){
-            foreach(Skill s, skills_by_level.values(skills_by_level.keys().last())){
-                m_moodable_skills.insert(s.id(),s);
-            }
+            m_moodable_skills = skills_by_level.values(skills_by_level.lastKey()).toVector();
         }
     }else{
         int mood_skill = m_df->read_short(m_mem->dwarf_field(m_address, "mood_skill"));
-        m_moodable_skills.insert(mood_skill, get_skill(mood_skill));
+        if(mood_skill >= 0 && !has_skill(mood_skill))
+            add_skill(blank_skill(mood_skill));
+        m_moodable_skills.append(mood_skill);
     }
 }
 
+void Dwarf::add_skill(const Skill &s){
+    if(s.id() >= m_skills.size())
+        m_skills.resize(qMax(s.id() + 1, GameDataReader::ptr()->get_total_skill_count()));
+    m_skills[s.id()] = s;
+    m_sorted_skills.insertMulti(s.capped_level_precise(), s.id());
+}
+
 void Dwarf::read_emotions(VIRTADDR personality_base){
     QString pronoun = (m_gender_info.gender == SEX_M ? tr("he") : tr("she"));
     //read list of circumstances and emotions, group and build desc
@@ -1925,7 +1942,7 @@ void Dwarf::read_emotions(VIRTADDR personality_base){
         QStringList seasonal_emotions;
         int stress_vuln = m_traits.value(8); //vulnerability to stress
 
-        int max_weeks = DT->user_settings()->value("options/tooltip_thought_weeks",-1).toInt();
+        int max_weeks = DT->settings().tooltip_thought_weeks;
 
         df_time last_week_tick = m_df->current_time() - df_week(abs(max_weeks));
 
@@ -1971,11 +1988,7 @@ void Dwarf::read_emotions(VIRTADDR personality_base){
     }
 
     auto gdr = GameDataReader::ptr();
-    int i = 0;
-    while (i < DH_TOTAL_LEVELS-1 &&
-           m_stress_level < gdr->get_happiness_threshold(static_cast<DWARF_HAPPINESS>(i)))
-         ++i;
-    m_happiness = static_cast<DWARF_HAPPINESS>(i);
+    m_happiness = happiness_from_stress(m_stress_level);
     QString stress_desc = gdr->get_happiness_desc(m_happiness);
     //check for catatonic, it changes the stress desc
     if(m_mood_id == MT_TRAUMA){
@@ -2058,7 +2071,7 @@ void Dwarf::read_personality() {
             if(goal_type >= 0){
                 short val = m_df->read_short(m_mem->soul_field(addr, "goal_realized")); //goal realized
                 //if we're not showing vampires, and this dwarf is a vampire, keep the goal hidden so they can't be identified from that
-                if(goal_type == 11 && m_curse_type == eCurse::VAMPIRE &&  DT->user_settings()->value("options/highlight_cursed", false).toBool()==false)
+                if(goal_type == 11 && m_curse_type == eCurse::VAMPIRE && !DT->settings().highlight_cursed)
                     continue;
 
                 if(val > 0)
@@ -2079,21 +2092,7 @@ void Dwarf::read_personality() {
         }
         m_current_focus = m_df->read_int(personality_addr + m_mem->soul_detail("current_focus"));
         m_undistracted_focus = m_df->read_int(personality_addr + m_mem->soul_detail("undistracted_focus"));
-        int ratio = m_undistracted_focus != 0 ? (m_current_focus*100)/m_undistracted_focus : 100;
-        if (ratio <= 60)
-            m_current_focus_degree = FOCUS_BADLY_DISTRACTED;
-        else if (ratio <= 80)
-            m_current_focus_degree = FOCUS_DISTRACTED;
-        else if (ratio < 100)
-            m_current_focus_degree = FOCUS_UNFOCUSED;
-        else if (ratio == 100)
-            m_current_focus_degree = FOCUS_UNTROUBLED;
-        else if (ratio < 120)
-            m_current_focus_degree = FOCUS_SOMEWHAT_FOCUSED;
-        else if (ratio < 140)
-            m_current_focus_degree = FOCUS_QUITE_FOCUSED;
-        else
-            m_current_focus_degree = FOCUS_VERY_FOCUSED;
+        update_focus_degree();
 
         //add a special preference for like outdoors
         int likes_outdoors = m_df->read_int(m_mem->soul_field(personality_addr, "likes_outdoors"));
@@ -2105,6 +2104,33 @@ void Dwarf::read_personality() {
     }
 }
 
+DWARF_HAPPINESS Dwarf::happiness_from_stress(int stress_level){
+    auto gdr = GameDataReader::ptr();
+    int i = 0;
+    while (i < DH_TOTAL_LEVELS-1 &&
+           stress_level < gdr->get_happiness_threshold(static_cast<DWARF_HAPPINESS>(i)))
+         ++i;
+    return static_cast<DWARF_HAPPINESS>(i);
+}
+
+void Dwarf::update_focus_degree(){
+    int ratio = m_undistracted_focus != 0 ? (m_current_focus*100)/m_undistracted_focus : 100;
+    if (ratio <= 60)
+        m_current_focus_degree = FOCUS_BADLY_DISTRACTED;
+    else if (ratio <= 80)
+        m_current_focus_degree = FOCUS_DISTRACTED;
+    else if (ratio < 100)
+        m_current_focus_degree = FOCUS_UNFOCUSED;
+    else if (ratio == 100)
+        m_current_focus_degree = FOCUS_UNTROUBLED;
+    else if (ratio < 120)
+        m_current_focus_degree = FOCUS_SOMEWHAT_FOCUSED;
+    else if (ratio < 140)
+        m_current_focus_degree = FOCUS_QUITE_FOCUSED;
+    else
+        m_current_focus_degree = FOCUS_VERY_FOCUSED;
+}
+
 bool Dwarf::trait_is_conflicted(const int &trait_id){
     return (m_conflicting_beliefs.values(trait_id).count() > 0);
 }
@@ -2202,18 +2228,23 @@ Attribute Dwarf::get_attribute(ATTRIBUTES_TYPE id){
         return Attribute(id,0,0,0);
 }
 
-Skill Dwarf::get_skill(int skill_id) {
-    if(!m_skills.contains(skill_id)){
-        int skill_rate = 100;
-        if(m_caste){
-            skill_rate = m_caste->get_skill_rate(skill_id);
-        }
-        Skill s = Skill(skill_id, 0, -1, 0, skill_rate);
-        s.get_balanced_level();
-        m_skills.insert(skill_id,s);
-        m_sorted_skills.insertMulti(s.capped_level_precise(), skill_id);
+Skill Dwarf::get_skill(int skill_id) const {
+    if(skill_id < 0)
+        return m_no_skill;
+    //never add the skill here, callers may be iterating or holding on to m_skills
+    if(!has_skill(skill_id))
+        return blank_skill(skill_id);
+    return m_skills.at(skill_id);
+}
+
+Skill Dwarf::blank_skill(int skill_id) const {
+    int skill_rate = 100;
+    if(m_caste){
+        skill_rate = m_caste->get_skill_rate(skill_id);
     }
-    return m_skills.value(skill_id);
+    Skill s = Skill(skill_id, 0, -1, 0, skill_rate);
+    s.get_balanced_level();
+    return s;
 }
 
 float Dwarf::skill_level(int skill_id){
@@ -2231,17 +2262,18 @@ float Dwarf::skill_level_raw_precise(int skill_id){
 
 float Dwarf::get_skill_level(int skill_id, bool raw, bool precise) {
     float retval = -1;
-    if(m_skills.contains(skill_id)){
+    if(has_skill(skill_id)){
+        const Skill &s = m_skills.at(skill_id);
         if(raw){
             if(precise)
-                retval = m_skills.value(skill_id).raw_level_precise();
+                retval = s.raw_level_precise();
             else
-                retval = m_skills.value(skill_id).raw_level();
+                retval = s.raw_level();
         }else{
             if(precise)
-                retval = m_skills.value(skill_id).capped_level_precise();
+                retval = s.capped_level_precise();
             else
-                retval = m_skills.value(skill_id).capped_level();
+                retval = s.capped_level();
         }
     }
     return retval;
@@ -2343,7 +2375,7 @@ void Dwarf::set_labor(int labor_id, bool enabled, bool update_cols_realtime) {
     }
 
     //user is turning a labor on, so we must turn off exclusives
-    if (enabled && DT->user_settings()->value("options/labor_exclusions",true).toBool()) {
+    if (enabled && DT->settings().labor_exclusions) {
         foreach(int excluded, l->get_excluded_labors()) {
             if(labor_enabled(excluded)){
                 m_df->update_labor_count(excluded, -1);
@@ -2426,6 +2458,18 @@ void Dwarf::clear_pending_labors() {
 }
 
 void Dwarf::commit_pending(bool single) {
+    //units without an address (synthetic populations) have nothing to write to, just keep the pending state
+    if (!m_address) {
+        m_labors = m_pending_labors;
+        m_nick_name = m_pending_nick_name;
+        m_custom_prof_name = m_pending_custom_profession;
+        m_unit_flags = m_pending_flags;
+        m_squad_id = m_pending_squad_id;
+        m_squad_position = m_pending_squad_position;
+        build_names();
+        return;
+    }
+
     VIRTADDR addr = m_mem->dwarf_field(m_address, "labors");
 
     QByteArray buf(94, 0);
@@ -2648,7 +2692,7 @@ QString Dwarf::tooltip_text() {
         max_roles = sorted_role_ratings().count();
 
     //in some mods animals may have skills
-    if(!m_skills.isEmpty() && s->value("tooltip_show_skills",true).toBool()){
+    if(!m_sorted_skills.isEmpty() && s->value("tooltip_show_skills",true).toBool()){
         int max_level = s->value("min_tooltip_skill_level", true).toInt();
         bool check_social = !s->value("tooltip_show_social_skills",true).toBool();
         bool include_level = s->value("tooltip_show_skills_level",true).toBool();
@@ -2660,10 +2704,11 @@ QString Dwarf::tooltip_text() {
         i.toBack();
         while(i.hasPrevious()){
             i.previous();
-            if(m_skills.value(i.value()).capped_level() < max_level || (check_social && gdr->social_skills().contains(i.value()))) {
+            const Skill &sk = m_skills.at(i.value());
+            if(sk.capped_level() < max_level || (check_social && gdr->social_skills().contains(i.value()))) {
                 continue;
             }
-            skill_summary.append(QString("<li>%1</li>").arg(m_skills.value(i.value()).to_string(include_level, include_exp_summary, use_color)));
+            skill_summary.append(QString("<li>%1</li>").arg(sk.to_string(include_level, include_exp_summary, use_color)));
             if (top_skills_only && --top_skill_count == 0)
                 break;
         }
@@ -2805,7 +2850,7 @@ QString Dwarf::tooltip_text() {
     if(!m_is_animal && s->value("tooltip_show_mood",false).toBool() && !had_mood()){
         QStringList skill_names;
         if (!m_moodable_skills.isEmpty()) {
-            foreach(int skill_id, m_moodable_skills.keys()){
+            foreach(int skill_id, m_moodable_skills){
                 skill_names << gdr->get_skill_name(skill_id, true);
             }
             skill_names.removeDuplicates();
@@ -2960,19 +3005,19 @@ void Dwarf::copy_address_to_clipboard() {
     qApp->clipboard()->setText(hexify(m_address));
 }
 
-Skill Dwarf::highest_skill() {
-    Skill highest = Skill(-1, 0, -1, 0);
-    foreach(Skill s, m_skills.values()) {
-        if (s.actual_exp() > highest.actual_exp()) {
-            highest = s;
+const Skill &Dwarf::highest_skill() const {
+    const Skill *highest = &m_no_skill;
+    for(const Skill &s : m_skills) {
+        if (s.actual_exp() > highest->actual_exp()) {
+            highest = &s;
         }
     }
-    return highest;
+    return *highest;
 }
 
 int Dwarf::total_skill_levels() {
     int ret_val = 0;
-    foreach(Skill s, m_skills.values()) {
+    for(const Skill &s : m_skills) {
         if(s.raw_level() > 0)
             ret_val += s.raw_level();
     }
@@ -3019,6 +3064,25 @@ QList<double> Dwarf::calc_role_ratings(){
     return m_raw_role_ratings.values();
 }
 
+void Dwarf::set_raw_role_ratings(const QVector<Role*> &roles, const double *ratings){
+    m_role_ratings.clear();
+    m_raw_role_ratings.clear();
+    m_sorted_role_ratings.clear();
+    m_sorted_custom_role_ratings.clear();
+    for(int i = 0; i < roles.size(); i++){
+        m_raw_role_ratings.insert(roles.at(i)->name(), ratings[i]);
+    }
+}
+
+bool Dwarf::take_raw_role_rating(const QString &role_name, double &rating){
+    auto it = m_raw_role_ratings.find(role_name);
+    if(it == m_raw_role_ratings.end())
+        return false;
+    rating = it.value();
+    m_raw_role_ratings.erase(it);
+    return true;
+}
+
 template<typename T, typename F>
 static double calc_rating(const std::vector<std::pair<T, Role::aspect_weight>> &aspects, F get_rating)
 {
@@ -3114,7 +3178,7 @@ double Dwarf::calc_role_rating(Role *m_role){
     //SKILLS
     float total_skill_rates = 0.0;
     rating_aspect[Skills] = calc_rating(m_role->skills, [this, &total_skill_rates] (int id) {
-        auto s = get_skill(id);
+        const Skill &s = get_skill(id);
         total_skill_rates += s.skill_rate();
 
         LOGV << "      * skill:" << s.name() << "lvl:" << s.capped_level_precise() << "sim. lvl:" << s.get_simulated_level() << "balanced lvl:" << s.get_balanced_level()
@@ -3170,6 +3234,8 @@ float Dwarf::get_raw_role_rating(QString role_name){
 
 void Dwarf::refresh_role_display_ratings(){
     GameDataReader *gdr = GameDataReader::ptr();
+    m_role_ratings.clear();
+    m_sorted_role_ratings.clear();
     //keep a sorted list of the display ratings for tooltips, detail pane, etc.
     foreach(QString name, m_raw_role_ratings.uniqueKeys()){
         Role::simple_rating sr;
@@ -3180,19 +3246,19 @@ void Dwarf::refresh_role_display_ratings(){
         sr.name = name;
         m_sorted_role_ratings.append(sr);
     }
-    if(DT->user_settings()->value("options/show_custom_roles",false).toBool()){
+    if(DT->settings().show_custom_roles){
         std::sort(m_sorted_role_ratings.begin(),m_sorted_role_ratings.end(),&Dwarf::sort_ratings_custom);
     }else{
         std::sort(m_sorted_role_ratings.begin(),m_sorted_role_ratings.end(),&Dwarf::sort_ratings);
     }
 }
 
-double Dwarf::get_role_pref_match_counts(const Role *r, bool load_map){
+double Dwarf::get_role_pref_match_counts(const Role *r){
     double total_rating = 0.0;
     for (const auto &p: r->prefs) {
         const auto *role_pref = p.first.get();
         const auto &w = p.second;
-        double matches = get_role_pref_match_counts(role_pref,(load_map ? r : 0));
+        double matches = get_role_pref_match_counts(role_pref);
         if(matches > 0){
             double rating = matches * w.weight;
             if(w.is_neg)
@@ -3203,19 +3269,12 @@ double Dwarf::get_role_pref_match_counts(const Role *r, bool load_map){
     return total_rating;
 }
 
-double Dwarf::get_role_pref_match_counts(const RolePreference *role_pref, const Role *r){
+double Dwarf::get_role_pref_match_counts(const RolePreference *role_pref){
     double matches = 0;
     int key = role_pref->get_pref_category();
     auto range = m_preferences.equal_range(key);
     for (auto it = range.first; it != range.second; ++it) {
-        auto p = it->second.get();
-        double match = (double)role_pref->match(p,this);
-        if(match > 0){
-            if(r){
-                m_role_pref_map[r->name()].append(qMakePair(role_pref->get_name(), p->get_name()));
-            }
-        }
-        matches += match;
+        matches += (double)role_pref->match(it->second.get(),this);
     }
     //give a 0.1 bonus for each match after the first, this only applies when getting matches for groups
     if(matches > 1.0)
@@ -3224,6 +3283,29 @@ double Dwarf::get_role_pref_match_counts(const RolePreference *role_pref, const
     return matches;
 }
 
+void Dwarf::set_role_pref_matches(const QString &role_name, const QVector<QPair<int,int> > &matches){
+    if(matches.isEmpty())
+        m_role_pref_map.remove(role_name);
+    else
+        m_role_pref_map.insert(role_name, matches);
+}
+
+QList<QPair<QString,QString> > Dwarf::get_role_pref_matches(QString role_name){
+    QList<QPair<QString,QString> > names;
+    auto it = m_role_pref_map.constFind(role_name);
+    Role *r = GameDataReader::ptr()->get_role(role_name);
+    if(it == m_role_pref_map.constEnd() || !r)
+        return names;
+    int pref_count = static_cast<int>(m_preferences.size());
+    foreach(const auto &m, it.value()){
+        if(m.first < 0 || m.first >= static_cast<int>(r->prefs.size()) || m.second < 0 || m.second >= pref_count)
+            continue;
+        names.append(qMakePair(r->prefs.at(m.first).first->get_name(),
+                               std::next(m_preferences.begin(), m.second)->second->get_name()));
+    }
+    return names;
+}
+
 Reaction *Dwarf::get_reaction()
 {
     if(m_current_sub_job_id.isEmpty())
@@ -3267,5 +3349,6 @@ void Dwarf::update_squad_info(int squad_id, int position, QString name){
     m_pending_squad_name = name;
     //try to update the uniform and inventory
     read_uniform();
-    read_inventory();
+    if(m_address)
+        read_inventory();
 }
@@ -55,6 +55,7 @@ class Dwarf : public QObject
 {
     Q_OBJECT
     friend class Squad;
+    friend class DFInstanceSynthetic;
 
 public:
     Dwarf(DFInstance *df, VIRTADDR addr, QObject *parent=0);
@@ -348,7 +349,7 @@ public:
     bool has_invalid_flags(QHash<uint, QString> invalid_flags, quint32 dwarf_flags);
 
     //! return this dwarf's highest skill
-    Skill highest_skill();
+    const Skill &highest_skill() const;
 
     Q_INVOKABLE int rust_level() {return m_worst_rust_level;}
 
@@ -376,19 +377,21 @@ public:
 
     Q_INVOKABLE bool active_military() {return m_active_military;}
 
-    //! return a hash of skill_id,Skill objects that this dwarf has experience in
-    QHash<int, Skill> *get_skills() {return &m_skills;}
-    QHash<int, Skill> get_moodable_skills() {return m_moodable_skills;}
+    //! return this dwarf's skills indexed by skill_id, slots that were never read or requested have an id of -1
+    const QVector<Skill> &get_skills() const {return m_skills;}
+    //! return the ids of the skills a strange mood would use
+    const QVector<int> &get_moodable_skills() const {return m_moodable_skills;}
+    bool has_skill(int skill_id) const {return skill_id >= 0 && skill_id < m_skills.size() && m_skills.at(skill_id).id() >= 0;}
     QVector<Attribute> *get_attributes() {return &m_attributes;}
     QHash<int, short> *get_traits(){return &m_traits;}
     void load_trait_values(QVector<double> &list);
     std::multimap<int, std::unique_ptr<Preference>> *get_preferences(){return &m_preferences;}
 
-    double get_role_pref_match_counts(const Role *r, bool load_map = false);
-    double get_role_pref_match_counts(const RolePreference *role_pref, const Role *r = 0);
+    double get_role_pref_match_counts(const Role *r);
+    double get_role_pref_match_counts(const RolePreference *role_pref);
 
-    //! return a skill object by skill_id
-    Skill get_skill(int skill_id);
+    //! return a skill object by skill_id, unknown skills get a blank copy which isn't stored
+    Skill get_skill(int skill_id) const;
 
     //! return all labors that the user has toggled, but not comitted to DF yet
     QVector<int> get_dirty_labors(); // returns labor ids
@@ -493,9 +496,19 @@ public:
 
     QList<double> calc_role_ratings();
     double calc_role_rating(Role *);
+    //! replace the raw role ratings with ratings calculated elsewhere (RoleKernel), one per role
+    void set_raw_role_ratings(const QVector<Role*> &roles, const double *ratings);
+    //! replace or add the raw rating of a single role
+    void set_raw_role_rating(const QString &role_name, double rating){m_raw_role_ratings.insert(role_name, rating);}
+    //! remove the raw rating of a single role, returns false if the role hasn't been rated
+    bool take_raw_role_rating(const QString &role_name, double &rating);
     Q_INVOKABLE float get_role_rating(QString role_name);
     Q_INVOKABLE float get_raw_role_rating(QString role_name);
-    QList<QPair<QString,QString> > get_role_pref_matches(QString role_name){return m_role_pref_map.value(role_name);}
+    //! the role preferences matched by this unit's preferences as (role preference name, preference name), built on demand for tooltips
+    QList<QPair<QString,QString> > get_role_pref_matches(QString role_name);
+    int role_pref_match_count(const QString &role_name) const {return m_role_pref_map.value(role_name).count();}
+    //! replace the matches of a role as (index in the role's preferences, position in this unit's preferences)
+    void set_role_pref_matches(const QString &role_name, const QVector<QPair<int,int> > &matches);
     void refresh_role_display_ratings();
 
     void calc_attribute_ratings();
@@ -682,9 +695,10 @@ private:
     short m_current_job_id;
     QString m_current_job;
     QString m_current_sub_job_id;
-    QHash<int,Skill> m_skills;
+    QVector<Skill> m_skills; //indexed by skill_id
+    Skill m_no_skill;
     QMultiMap<float, int> m_sorted_skills; //level, skill_id
-    QHash<int,Skill> m_moodable_skills;
+    QVector<int> m_moodable_skills;
     QHash<int, short> m_traits;
     QHash<int, short> m_goals;
     QHash<int, UnitBelief> m_beliefs;
@@ -706,7 +720,7 @@ private:
     QHash<QString, double> m_raw_role_ratings;
     QList<Role::simple_rating> m_sorted_role_ratings;
     QList<QPair<QString,float> > m_sorted_custom_role_ratings;
-    QHash<QString,QList<QPair<QString,QString> > > m_role_pref_map;
+    QHash<QString,QVector<QPair<int,int> > > m_role_pref_map;
     QHash<short, int> m_states;
     std::tuple<df_year, df_tick> m_birth_date;
     df_time m_age;
@@ -784,14 +798,19 @@ private:
     bool read_soul();
     void read_soul_aspects();
     void read_skills();
+    void add_skill(const Skill &s);
+    Skill blank_skill(int skill_id) const;
     void read_attributes();
     void load_attribute(VIRTADDR &addr, ATTRIBUTES_TYPE id);
     void read_personality();
+    void update_focus_degree();
+    static DWARF_HAPPINESS happiness_from_stress(int stress_level);
     void read_emotions(VIRTADDR personality_base);
     void read_turn_count();
     void read_animal_type();
     void read_noble_position();
     void read_preferences();
+    void group_preferences();
     void read_syndromes();
     void read_squad_info();
     void read_inventory();
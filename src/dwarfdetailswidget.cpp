@@ -351,15 +351,14 @@ void DwarfDetailsWidget::show_dwarf(Dwarf *d) {
     bold_item_font.setBold(true);
 
     // SKILLS TABLE
-    QHash<int,Skill> *skills = d->get_skills();
     ui->tw_skills->setSortingEnabled(false);
     int real_count = 0;
     int raw_bonus_xp = 100;
     int bonus_xp = 0;
     QString tooltip = "";
     bool no_bonuses = true;
-    foreach(Skill s, skills->values()){
-        if(s.capped_level() > -1)
+    for(const Skill &s : d->get_skills()){
+        if(s.id() > -1 && s.capped_level() > -1)
         {
             real_count = ui->tw_skills->rowCount();
             ui->tw_skills->insertRow(real_count);
@@ -27,7 +27,6 @@ THE SOFTWARE.
 #include "squad.h"
 #include "truncatingfilelogger.h"
 #include "dwarftherapist.h"
-#include "defaultfonts.h"
 #include "dwarfmodelproxy.h"
 
 #include "columntypes.h"
@@ -43,8 +42,11 @@ THE SOFTWARE.
 #include "unithealth.h"
 #include "customprofession.h"
 #include "defines.h"
+#include "profiler.h"
 
 #include <QTime>
+#include <QtConcurrent>
+#include <QTimer>
 #include <QFontMetrics>
 
 DwarfModel::DwarfModel(QObject *parent)
@@ -55,6 +57,10 @@ DwarfModel::DwarfModel(QObject *parent)
     , m_gridview(0x0)
     , m_total_row_count(0)
     , m_clearing_data(false)
+    , m_group_keys_valid(false)
+    , m_rows_group_by(-1)
+    , m_rows_view(0)
+    , m_flush_scheduled(false)
 {
     connect(DT, SIGNAL(settings_changed()), this, SLOT(read_settings()));
     read_settings();
@@ -72,6 +78,11 @@ void DwarfModel::clear_all(bool clr_pend) {
     qDeleteAll(m_dwarves);
     m_dwarves.clear();
     m_grouped_dwarves.clear();
+    invalidate_group_keys();
+    m_rows_group_by = -1;
+    m_rows_view = 0;
+    m_dirty_rows.clear();
+    m_dirty_labor_headers.clear();
 
     if(m_gridview){
         foreach(ViewColumnSet *set, m_gridview->sets()) {
@@ -100,11 +111,10 @@ void DwarfModel::load_dwarves() {
     // clear id->dwarf map
     clear_all(false);
 
-    m_df->attach();
+    //load_dwarves attaches only while reading the units, roles and population stats are computed with the game running
     foreach(Dwarf *d, m_df->load_dwarves()) {
         m_dwarves[d->id()] = d;
     }
-    m_df->detach();
 
     emit units_refreshed();
 }
@@ -117,30 +127,73 @@ Squad* DwarfModel::get_squad(int id){
 }
 
 void DwarfModel::update_header_info(int id, COLUMN_TYPE type){
-    int index = 0;
-    foreach(ViewColumnSet *set, m_gridview->sets()) {
-        foreach(ViewColumn *col, set->columns()) {
-            index ++;
-            if(col->type() == type){
-                if(col->type()==CT_LABOR){
-                    LaborColumn *l = static_cast<LaborColumn*>(col);
-                    if(l->labor_id()==id){
-                        l->update_count(); //tell this column to update it's count
-                        QStandardItem* header = this->horizontalHeaderItem(index);
-                        header->setData(col->bg_color(), Qt::BackgroundColorRole);
-                        header->setData(set->name(), Qt::UserRole);
-                        if(m_show_labor_counts){
-                            header->setText(QString("%1 %2")
-                                            .arg(l->count(),2,10,QChar('0'))
-                                            .arg(col->title()).trimmed());
-                        }
-                        header->setToolTip(build_col_tooltip(col));
-                        return;
-                    }
-                }
-            }
+    if(type != CT_LABOR || !m_labor_headers.contains(id))
+        return;
+    m_dirty_labor_headers.insert(id);
+    schedule_flush();
+}
+
+void DwarfModel::invalidate_rows(const QModelIndex &parent, int first, int last){
+    if(first < 0 || last < first)
+        return;
+    QPersistentModelIndex key(parent);
+    QHash<QPersistentModelIndex, QPair<int,int> >::iterator it = m_dirty_rows.find(key);
+    if(it == m_dirty_rows.end()){
+        m_dirty_rows.insert(key, qMakePair(first, last));
+    }else{
+        it.value().first = qMin(it.value().first, first);
+        it.value().second = qMax(it.value().second, last);
+    }
+    schedule_flush();
+}
+
+void DwarfModel::schedule_flush(){
+    if(m_flush_scheduled)
+        return;
+    m_flush_scheduled = true;
+    QTimer::singleShot(0, this, SLOT(flush_invalidations()));
+}
+
+void DwarfModel::flush_invalidations(){
+    PROFILE_SCOPE_CAT("flush_invalidations", "view");
+    m_flush_scheduled = false;
+
+    foreach(int labor_id, m_dirty_labor_headers){
+        foreach(int col_idx, m_labor_headers.values(labor_id)){
+            refresh_labor_header(col_idx);
         }
     }
+    m_dirty_labor_headers.clear();
+
+    QHash<QPersistentModelIndex, QPair<int,int> > dirty;
+    dirty.swap(m_dirty_rows);
+    for(QHash<QPersistentModelIndex, QPair<int,int> >::const_iterator it = dirty.constBegin(); it != dirty.constEnd(); ++it){
+        QModelIndex parent = it.key();
+        int last = qMin(it.value().second, rowCount(parent) - 1);
+        if(last < it.value().first)
+            continue;
+        emit dataChanged(index(it.value().first, 0, parent), index(last, columnCount(parent) - 1, parent));
+    }
+}
+
+void DwarfModel::refresh_labor_header(int col_idx){
+    if(!m_gridview)
+        return;
+    ViewColumn *col = m_gridview->get_column(col_idx);
+    QStandardItem* header = this->horizontalHeaderItem(col_idx);
+    if(!col || !header || col->type() != CT_LABOR)
+        return;
+
+    LaborColumn *l = static_cast<LaborColumn*>(col);
+    l->update_count(); //tell this column to update it's count
+    header->setData(col->bg_color(), Qt::BackgroundColorRole);
+    header->setData(col->set()->name(), Qt::UserRole);
+    if(m_show_labor_counts){
+        header->setText(QString("%1 %2")
+                        .arg(l->count(),2,10,QChar('0'))
+                        .arg(col->title()).trimmed());
+    }
+    header->setToolTip(build_col_tooltip(col));
 }
 
 void DwarfModel::draw_headers(){
@@ -149,6 +202,8 @@ void DwarfModel::draw_headers(){
     name_col->setToolTip(tr("Right click to sort."));
     setHorizontalHeaderItem(0, name_col);
     emit clear_spacers();
+    m_labor_headers.clear();
+    m_dirty_labor_headers.clear();
 
     QString max_title = "";
     foreach(ViewColumnSet *set, m_gridview->sets()) {
@@ -174,6 +229,8 @@ void DwarfModel::draw_headers(){
             header->setToolTip(build_col_tooltip(col));
             header->setData(col->bg_color(), Qt::BackgroundColorRole);
             header->setData(set->name(), Qt::UserRole);
+            if(col->type() == CT_LABOR)
+                m_labor_headers.insert(static_cast<LaborColumn*>(col)->labor_id(), start_col);
             setHorizontalHeaderItem(start_col++, header);
             switch (col->type()) {
             case CT_SPACER:
@@ -217,7 +274,9 @@ QString DwarfModel::build_col_tooltip(ViewColumn *col){
 }
 
 void DwarfModel::build_rows() {
+    PROFILE_SCOPE("build_rows");
     m_grouped_dwarves.clear();
+    m_dirty_rows.clear(); //every row is rebuilt
 
     foreach(ViewColumnSet *set, m_gridview->sets()) {
         foreach(ViewColumn *col, set->columns()) {
@@ -241,183 +300,314 @@ void DwarfModel::build_rows() {
     int n_adults=0;
     int n_children=0;
     int n_babies=0;
-    QString race_name = "";
+    QString race_name = only_animals ? tr("Animals") : fortress_race_name();
 
-    GameDataReader *gdr = GameDataReader::ptr();
+    if(!m_group_keys_valid)
+        build_group_keys();
+    m_grouped_dwarves = group_index(m_group_by, only_animals);
 
-    if(only_animals)
-        race_name = tr("Animals");
-    else if(!m_df.isNull()){
+    foreach(Dwarf *d, m_dwarves) {
+        if(d->is_animal() != only_animals)
+            continue;
+        //update our counts for the display
+        if(d->is_child())
+            n_children ++;
+        else if(d->is_baby())
+            n_babies ++;
+        else
+            n_adults ++;
+    }
+
+    foreach(QString key, m_grouped_dwarves.uniqueKeys()) {
+        build_row(key);
+    }
+    m_rows_group_by = m_group_by;
+    m_rows_view = m_gridview;
+
+    emit new_creatures_count(n_adults,n_children,n_babies,race_name);
+}
+
+QString DwarfModel::fortress_race_name() const {
+    if(!m_df.isNull()){
         Race* r = m_df->get_race(m_df->dwarf_race_id());
         if(r)
-            race_name = r->plural_name();
+            return r->plural_name();
     }
+    return "";
+}
 
-    foreach(Dwarf *d, m_dwarves) {
-        //shared groupings for both animals and the fortress race
-        if((only_animals && d->is_animal()) || (!d->is_animal() && !only_animals)){
-            if(m_group_by == GB_NOTHING){
-                m_grouped_dwarves[0].append(d);
-            }else if(m_group_by == GB_PROFESSION){
-                m_grouped_dwarves[d->profession()].append(d);
-            }else if(m_group_by == GB_SEX){
-                m_grouped_dwarves[Dwarf::get_gender_desc(d->get_gender())].append(d);
-            } else if (m_group_by == GB_SEX_ORIENT){
-                auto group = QString("%1 - %2")
-                        .arg(Dwarf::get_gender_desc(d->get_gender()))
-                        .arg(Dwarf::get_orientation_desc(d->get_orientation()));
-                m_grouped_dwarves[group].append(d);
-            }else if(m_group_by == GB_MIGRATION_WAVE){
-                m_grouped_dwarves[d->get_migration_desc()].append(d);
-            }else if(m_group_by == GB_AGE){
-                if(d->is_baby()){
-                    m_grouped_dwarves[d->profession()].append(d);
-                }else{
-                    int age = d->get_age();
-                    if(age < 10){
-                        m_grouped_dwarves[d->get_age_formatted()].append(d);
-                    }else{
-                        int base = (age / 10) * 10;
-                        QString age_range = tr("%1 - %2 Years").arg(base)
-                                .arg(base + 9);
-                        m_grouped_dwarves[age_range].append(d);
-                    }
-                }
-            }else if(m_group_by == GB_CASTE){
-                m_grouped_dwarves[d->caste_name(true)].append(d);
-            }else if(m_group_by == GB_CASTE_TAG){
-                //strip off the underscores, male and female parts of the tag to group genders together
-                QString tag = d->caste_tag();
-                tag.replace("_", " ");
-                tag.replace(tr("FEMALE")," ");
-                tag.replace(tr("MALE")," ");
-                if(tag.trimmed().isEmpty())
-                    tag = race_name;
-                m_grouped_dwarves[capitalizeEach(tag.toLower())].append(d);
-            }else if(m_group_by == GB_RACE){
-                m_grouped_dwarves[capitalizeEach(d->race_name(true,true))].append(d);
-            }else if(m_group_by == GB_HAS_NICKNAME){
-                if (d->nickname().isEmpty()) {
-                    m_grouped_dwarves[tr("No Nickname")].append(d);
-                } else {
-                    m_grouped_dwarves[tr("Has Nickname")].append(d);
-                }
-            }else if(m_group_by == GB_HEALTH){
-                int treatments = d->get_unit_health().get_treatment_summary(false,false).count();
-                int statuses = d->get_unit_health().get_status_summary(false,false).count();
-                int wounds = d->get_unit_health().get_wound_details().count();
-
-                bool critical_wounds = d->get_unit_health().has_critical_wounds();
-                if(critical_wounds){
-                    m_grouped_dwarves[tr("Critical Health Issues")].append(d);
-                }else if(treatments || statuses || wounds){
-                    m_grouped_dwarves[tr("Minor Health Issues")].append(d);
-                }else{
-                    m_grouped_dwarves[tr("No Health Issues")].append(d);
-                }
+QString DwarfModel::group_name(Dwarf *d, GROUP_BY group_by, const QString &race_name) const{
+    GameDataReader *gdr = GameDataReader::ptr();
+    QString name;
+
+    //shared groupings for both animals and the fortress race
+    if(group_by == GB_NOTHING){
+        //everyone in a single unnamed group
+    }else if(group_by == GB_PROFESSION){
+        name = d->profession();
+    }else if(group_by == GB_SEX){
+        name = Dwarf::get_gender_desc(d->get_gender());
+    } else if (group_by == GB_SEX_ORIENT){
+        name = QString("%1 - %2")
+                .arg(Dwarf::get_gender_desc(d->get_gender()))
+                .arg(Dwarf::get_orientation_desc(d->get_orientation()));
+    }else if(group_by == GB_MIGRATION_WAVE){
+        name = d->get_migration_desc();
+    }else if(group_by == GB_AGE){
+        if(d->is_baby()){
+            name = d->profession();
+        }else{
+            int age = d->get_age();
+            if(age < 10){
+                name = d->get_age_formatted();
             }else{
-                if(only_animals && d->is_animal())
-                    m_grouped_dwarves["N/A"].append(d);
+                int base = (age / 10) * 10;
+                name = tr("%1 - %2 Years").arg(base)
+                        .arg(base + 9);
             }
+        }
+    }else if(group_by == GB_CASTE){
+        name = d->caste_name(true);
+    }else if(group_by == GB_CASTE_TAG){
+        //strip off the underscores, male and female parts of the tag to group genders together
+        QString tag = d->caste_tag();
+        tag.replace("_", " ");
+        tag.replace(tr("FEMALE")," ");
+        tag.replace(tr("MALE")," ");
+        if(tag.trimmed().isEmpty())
+            tag = race_name;
+        name = capitalizeEach(tag.toLower());
+    }else if(group_by == GB_RACE){
+        name = capitalizeEach(d->race_name(true,true));
+    }else if(group_by == GB_HAS_NICKNAME){
+        if (d->nickname().isEmpty()) {
+            name = tr("No Nickname");
+        } else {
+            name = tr("Has Nickname");
+        }
+    }else if(group_by == GB_HEALTH){
+        int treatments = d->get_unit_health().get_treatment_summary(false,false).count();
+        int statuses = d->get_unit_health().get_status_summary(false,false).count();
+        int wounds = d->get_unit_health().get_wound_details().count();
+
+        bool critical_wounds = d->get_unit_health().has_critical_wounds();
+        if(critical_wounds){
+            name = tr("Critical Health Issues");
+        }else if(treatments || statuses || wounds){
+            name = tr("Minor Health Issues");
+        }else{
+            name = tr("No Health Issues");
+        }
+    }else if(d->is_animal()){
+        name = "N/A";
+
+    //groups specific to the actual race we're playing (ie. dwarfs)
+    }else if(group_by == GB_LEGENDARY){
+        int legendary_skills = 0;
+        for(const Skill &s : d->get_skills()) {
+            if (s.capped_level() >= 15)
+                legendary_skills++;
+        }
+        if (legendary_skills)
+            name = tr("Legends");
+        else
+            name = tr("Losers");
+    }else if(group_by == GB_HAPPINESS){
+        name = d->happiness_name(d->get_happiness());
+    }else if(group_by == GB_GOAL_TYPE){
+        name = d->get_goal_summary();
+    }else if(group_by == GB_GOALS_REALIZED){
+        name = tr("%1 Goals Realized").arg(d->goals_realized());
+    }else if(group_by == GB_OCCUPATION){
+        name = d->occupation();
+    }else if(group_by == GB_SKILL_RUST){
+        name = Skill::get_rust_level_desc(d->rust_level());
+    }else if(group_by == GB_CURRENT_JOB){
+        name = d->current_job();
+        if(name.length() > 50 || name.contains("<"))
+            name = gdr->get_job(d->current_job_id())->group_name();
+    }else if(group_by == GB_JOB_TYPE){
+        DwarfJob *job = gdr->get_job(d->current_job_id());
+        name = job->group_name();
+    }else if(group_by == GB_MILITARY_STATUS){
+        if (d->is_baby() || d->is_child()) {
+            name = tr("Juveniles");
+        } else if (!d->noble_position().isEmpty()) {
+            name = tr("Nobles");
+        } else if (d->active_military()) {
+            name = tr("Military (On Duty)");
+        } else if (d->squad_id() > -1) {
+            name = tr("Military (Off Duty)");
+        } else if (!d->is_citizen() && d->can_assign_military()) {
+            name = tr("Mercenaries");
+        } else if (d->can_assign_military()) {
+            name = tr("Can Activate");
+        } else {
+            name = tr("Cannot Activate");
+        }
+    }else if(group_by == GB_HIGHEST_MOODABLE){
+        const QVector<int> &skills = d->get_moodable_skills();
+        if (skills.count() > 1)
+            name = "~Random~";
+        else if(d->had_mood())
+            name = "~Had Mood~";
+        else if(skills.isEmpty())
+            name = "~Craft (Bone/Stone/Wood)~";
+        else
+            name = gdr->get_skill_name(skills.first());
+    }else if(group_by == GB_HIGHEST_SKILL){
+        name = gdr->get_skill_level_name(d->highest_skill().capped_level());
+    }else if(group_by == GB_TOTAL_SKILL_LEVELS){
+        name = tr("Levels: %1").arg(d->total_skill_levels());
+    }else if(group_by == GB_ASSIGNED_LABORS || group_by == GB_ASSIGNED_SKILLED_LABORS){
+        bool include_hauling = (group_by == GB_ASSIGNED_LABORS);
+        name = tr("%1 Assigned Labors")
+                .arg(d->total_assigned_labors(include_hauling));
+    }else if(group_by == GB_SQUAD){
+        if(d->squad_name().isEmpty()) {
+            name = tr("No Squad");
+        } else {
+            name = d->squad_name();
+        }
+    }
+    return name;
+}
 
-            //update our counts for the display
-            if(d->is_child())
-                n_children ++;
-            else if(d->is_baby())
-                n_babies ++;
-            else
-                n_adults ++;
-        }
-
-        //groups specific to the actual race we're playing (ie. dwarfs)
-        if(!d->is_animal() && !only_animals)
-        {
-            if(m_group_by == GB_LEGENDARY){
-                int legendary_skills = 0;
-                foreach(Skill s, d->get_skills()->values()) {
-                    if (s.capped_level() >= 15)
-                        legendary_skills++;
-                }
-                if (legendary_skills)
-                    m_grouped_dwarves[tr("Legends")].append(d);
-                else
-                    m_grouped_dwarves[tr("Losers")].append(d);
-            }else if(m_group_by == GB_HAPPINESS){
-                m_grouped_dwarves[d->happiness_name(d->get_happiness())].append(d);
-            }else if(m_group_by == GB_GOAL_TYPE){
-                m_grouped_dwarves[d->get_goal_summary()].append(d);
-            }else if(m_group_by == GB_GOALS_REALIZED){
-                m_grouped_dwarves[tr("%1 Goals Realized").arg(d->goals_realized())].append(d);
-            }else if(m_group_by == GB_OCCUPATION){
-                m_grouped_dwarves[d->occupation()].append(d);
-            }else if(m_group_by == GB_SKILL_RUST){
-                m_grouped_dwarves[Skill::get_rust_level_desc(d->rust_level())].append(d);
-            }else if(m_group_by == GB_CURRENT_JOB){
-                QString title = d->current_job();
-                if(title.length() > 50 || title.contains("<"))
-                    title = gdr->get_job(d->current_job_id())->group_name();
-                m_grouped_dwarves[title].append(d);
-            }else if(m_group_by == GB_JOB_TYPE){
-                DwarfJob *job = GameDataReader::ptr()->get_job(d->current_job_id());
-                m_grouped_dwarves[job->group_name()].append(d);
-            }else if(m_group_by == GB_MILITARY_STATUS){
-                if (d->is_baby() || d->is_child()) {
-                    m_grouped_dwarves[tr("Juveniles")].append(d);
-                } else if (!d->noble_position().isEmpty()) {
-                    m_grouped_dwarves[tr("Nobles")].append(d);
-                } else if (d->active_military()) {
-                    m_grouped_dwarves[tr("Military (On Duty)")].append(d);
-                } else if (d->squad_id() > -1) {
-                    m_grouped_dwarves[tr("Military (Off Duty)")].append(d);
-                } else if (!d->is_citizen() && d->can_assign_military()) {
-                    m_grouped_dwarves[tr("Mercenaries")].append(d);
-                } else if (d->can_assign_military()) {
-                    m_grouped_dwarves[tr("Can Activate")].append(d);
-                } else {
-                    m_grouped_dwarves[tr("Cannot Activate")].append(d);
-                }
-            }else if(m_group_by == GB_HIGHEST_MOODABLE){
-                QList<Skill> skills = d->get_moodable_skills().values();
-                if (skills.count() > 1)
-                    m_grouped_dwarves["~Random~"].append(d);
-                else if(d->had_mood())
-                    m_grouped_dwarves["~Had Mood~"].append(d);
-                else if(skills.isEmpty())
-                    m_grouped_dwarves["~Craft (Bone/Stone/Wood)~"].append(d);
-                else
-                    m_grouped_dwarves[skills[0].name()].append(d);
-            }else if(m_group_by == GB_HIGHEST_SKILL){
-                Skill highest = d->highest_skill();
-                QString level = gdr->get_skill_level_name(highest.capped_level());
-                m_grouped_dwarves[level].append(d);
-            }else if(m_group_by == GB_TOTAL_SKILL_LEVELS){
-                m_grouped_dwarves[tr("Levels: %1").arg(d->total_skill_levels())]
-                        .append(d);
-            }else if(m_group_by == GB_ASSIGNED_LABORS || m_group_by == GB_ASSIGNED_SKILLED_LABORS){
-                bool include_hauling = (m_group_by == GB_ASSIGNED_LABORS);
-                m_grouped_dwarves[tr("%1 Assigned Labors")
-                        .arg(d->total_assigned_labors(include_hauling))].append(d);
-            }else if(m_group_by == GB_SQUAD){
-                if(d->squad_name().isEmpty()) {
-                    m_grouped_dwarves[tr("No Squad")].append(d);
-                } else {
-                    m_grouped_dwarves[d->squad_name()].append(d);
-                }
+void DwarfModel::build_group_keys() {
+    PROFILE_SCOPE("build_group_keys");
+    m_group_keys.clear();
+    m_group_names.clear();
+    m_group_index.clear();
+
+    QString race_name = fortress_race_name();
+    QString animals_name = tr("Animals");
+    QVector<Dwarf*> units = m_dwarves.values().toVector();
+
+    //every grouping's name for every unit, the units are split between the threads
+    QVector<QStringList> names(units.count());
+    QVector<int> unit_ids;
+    for(int i = 0; i < units.count(); i++)
+        unit_ids.append(i);
+    auto name_unit = [&](int &i){
+        Dwarf *d = units.at(i);
+        const QString &race = d->is_animal() ? animals_name : race_name;
+        QStringList &unit_names = names[i];
+        for(int gb = 0; gb < GB_TOTAL; gb++)
+            unit_names.append(group_name(d, static_cast<GROUP_BY>(gb), race));
+    };
+    QtConcurrent::blockingMap(unit_ids, name_unit);
+
+    //intern the names so each grouping of a unit is a single id
+    QHash<QString,int> name_ids;
+    for(int i = 0; i < units.count(); i++){
+        QVector<int> keys(GB_TOTAL);
+        for(int gb = 0; gb < GB_TOTAL; gb++){
+            const QString &name = names.at(i).at(gb);
+            QHash<QString,int>::const_iterator it = name_ids.constFind(name);
+            if(it == name_ids.constEnd()){
+                it = name_ids.insert(name, m_group_names.count());
+                m_group_names.append(name);
             }
+            keys[gb] = it.value();
         }
+        m_group_keys.insert(units.at(i)->id(), keys);
     }
+    m_group_keys_valid = true;
+    LOGD << "built" << m_group_names.count() << "group names for" << units.count() << "units";
+}
+
+const QMap<QString, QVector<Dwarf*> > &DwarfModel::group_index(GROUP_BY group_by, bool only_animals) {
+    int index_key = group_by * 2 + (only_animals ? 1 : 0);
+    QHash<int, QMap<QString, QVector<Dwarf*> > >::iterator it = m_group_index.find(index_key);
+    if(it == m_group_index.end()){
+        QMap<QString, QVector<Dwarf*> > groups;
+        foreach(Dwarf *d, m_dwarves) {
+            if(d->is_animal() != only_animals)
+                continue;
+            groups[m_group_names.at(m_group_keys.value(d->id()).at(group_by))].append(d);
+        }
+        it = m_group_index.insert(index_key, groups);
+    }
+    return it.value();
+}
+
+void DwarfModel::invalidate_group_keys() {
+    m_group_keys_valid = false;
+    m_group_index.clear();
+}
+
+bool DwarfModel::regroup() {
+    PROFILE_SCOPE("regroup");
+    if(!m_group_keys_valid)
+        build_group_keys();
+    const QMap<QString, QVector<Dwarf*> > &groups = group_index(m_group_by, m_gridview->show_animals());
+
+    //the same units are shown with every grouping, anything else needs new rows
+    int old_count = 0;
+    int new_count = 0;
+    foreach(const QVector<Dwarf*> &members, m_grouped_dwarves)
+        old_count += members.count();
+    foreach(const QVector<Dwarf*> &members, groups)
+        new_count += members.count();
+    if(old_count != new_count)
+        return false;
+
+    flush_invalidations();
+
+    //rows move one at a time, let the views catch up once at the end instead
+    beginResetModel();
+    blockSignals(true);
+
+    //detach the unit rows from their groups, keeping their cells
+    QHash<int, QList<QStandardItem*> > unit_rows;
+    for(int r = rowCount() - 1; r >= 0; r--){
+        QStandardItem *first = item(r, 0);
+        if(first->data(DR_IS_AGGREGATE).toBool()){
+            while(first->rowCount() > 0){
+                QList<QStandardItem*> row = first->takeRow(0);
+                unit_rows.insert(row.at(0)->data(DR_ID).toInt(), row);
+            }
+        }else{
+            QList<QStandardItem*> row = takeRow(r);
+            unit_rows.insert(row.at(0)->data(DR_ID).toInt(), row);
+        }
+    }
+    removeRows(0, rowCount());
 
+    m_grouped_dwarves = groups;
+    m_total_row_count = 0;
     foreach(QString key, m_grouped_dwarves.uniqueKeys()) {
-        build_row(key);
+        QList<QStandardItem*> agg_items = build_aggregate_row(key);
+        QStandardItem *agg_first_col = agg_items.isEmpty() ? 0 : agg_items.at(0);
+        foreach(Dwarf *d, m_grouped_dwarves.value(key)) {
+            QList<QStandardItem*> items = unit_rows.take(d->id());
+            if(items.isEmpty()){
+                LOGW << "no row to regroup for" << d->nice_name();
+                continue;
+            }
+            apply_grouping(d, items);
+            if (agg_first_col) {
+                agg_first_col->appendRow(items);
+            } else {
+                appendRow(items);
+            }
+            d->m_name_idx = indexFromItem(items.at(0));
+            m_total_row_count += 1;
+        }
+        if (agg_first_col) {
+            appendRow(agg_items);
+        }
     }
+    blockSignals(false);
+    endResetModel();
 
-    emit new_creatures_count(n_adults,n_children,n_babies,race_name);
+    m_rows_group_by = m_group_by;
+    return true;
 }
 
 void DwarfModel::build_row(const QString &key) {
+    PROFILE_SCOPE("build_row");
     QIcon icn_gender;
-    QStandardItem *agg_first_col = 0;
-    QList<QStandardItem*> agg_items;
     if(!m_grouped_dwarves.contains(key)){
         LOGE << "Group by failed because key " << key << " wasn't found.";
         return;
@@ -432,6 +622,93 @@ void DwarfModel::build_row(const QString &key) {
         return;
     }
 
+    QList<QStandardItem*> agg_items = build_aggregate_row(key);
+    QStandardItem *agg_first_col = agg_items.isEmpty() ? 0 : agg_items.at(0);
+
+    foreach(Dwarf *d, m_grouped_dwarves.value(key)) {
+        if(!d)
+            continue;
+
+        QStandardItem *i_name = new QStandardItem(d->nice_name());
+
+        //background gradients for nobles
+        if(m_highlight_nobles){
+            if(d->noble_position() != ""){
+                QColor col = m_df->fortress()->get_noble_color(d->historical_id());
+                i_name->setData(build_gradient_brush(col,col.alpha(),0,QPoint(0,0),QPoint(1,0)),Qt::BackgroundRole);
+                i_name->setData(complement(col,0.25),Qt::ForegroundRole);
+            }
+        }
+
+        //set cursed colors
+        if(m_highlight_cursed){
+            switch(d->get_curse_type()){
+            case eCurse::VAMPIRE:
+            case eCurse::WEREBEAST:
+            {
+                i_name->setData(m_cursed_bg,Qt::BackgroundRole);
+                i_name->setData(complement(m_curse_col,0.25),Qt::ForegroundRole);
+            }
+                break;
+            case eCurse::OTHER:
+            {
+                i_name->setData(m_cursed_bg_light,Qt::BackgroundRole);
+            }
+                break;
+            default:
+                break;
+            }
+        }
+
+        if(m_show_tooltips){
+            i_name->setToolTip(d->tooltip_text());
+        }else{
+            i_name->setData(d->tooltip_text(),DwarfModel::DR_TOOLTIP);
+        }
+
+        i_name->setStatusTip(d->nice_name());
+        i_name->setData(false, DR_IS_AGGREGATE);
+        i_name->setData(0, DR_RATING);
+        i_name->setData(d->id(), DR_ID);
+
+        //set the roles for the special right click sorting
+        i_name->setData(d->get_age_in_ticks(), DR_AGE);
+        i_name->setData(d->body_size(), DR_SIZE);
+        i_name->setData(d->nice_name(), DR_NAME);
+
+        //set gender icons
+        if(m_show_gender){
+            icn_gender.addFile(d->gender_icon_path());
+            i_name->setIcon(icn_gender);
+        }
+
+        QList<QStandardItem*> items;
+        items << i_name;
+        foreach(ViewColumnSet *set, m_gridview->sets()) {
+            foreach(ViewColumn *col, set->columns()) {
+                items << col->build_cell(d);
+            }
+        }
+        apply_grouping(d, items);
+
+        if (agg_first_col) {
+            agg_first_col->appendRow(items);
+        } else {
+            appendRow(items);
+        }
+        d->m_name_idx = indexFromItem(i_name);
+        m_total_row_count += 1;
+    }
+    if (agg_first_col) {
+        appendRow(agg_items);
+    }
+}
+
+QList<QStandardItem*> DwarfModel::build_aggregate_row(const QString &key) {
+    QList<QStandardItem*> agg_items;
+    QStandardItem *agg_first_col = 0;
+    Dwarf *first_dwarf = m_grouped_dwarves.value(key).at(0);
+
     if (m_group_by != GB_NOTHING) {
         // we need a root element to hold group members...
         QString title = QString("%1 (%2)").arg(key).arg(m_grouped_dwarves.value(key).size());
@@ -451,11 +728,11 @@ void DwarfModel::build_row(const QString &key) {
             agg_first_col->setData(first_dwarf->highest_skill().actual_exp(), DR_SORT_VALUE);
         } else if (m_group_by == GB_HIGHEST_MOODABLE) {
             //show generic mood, random and had mood at the top/bottom
-            QList<Skill> skills = first_dwarf->get_moodable_skills().values();
+            const QVector<int> &skills = first_dwarf->get_moodable_skills();
             if(first_dwarf->had_mood() || skills.isEmpty() || skills.count() > 1){
                 agg_first_col->setData(QChar(128), DR_SORT_VALUE);
             }else{
-                agg_first_col->setData(skills[0].name(), DR_SORT_VALUE);
+                agg_first_col->setData(GameDataReader::ptr()->get_skill_name(skills.first()), DR_SORT_VALUE);
             }
         } else if (m_group_by == GB_TOTAL_SKILL_LEVELS) {
             agg_first_col->setData(first_dwarf->total_skill_levels(), DR_SORT_VALUE);
@@ -519,9 +796,8 @@ void DwarfModel::build_row(const QString &key) {
         }
         agg_first_col->setData(agg_first_col->data(DR_SORT_VALUE),DR_GLOBAL);
         agg_items << agg_first_col;
-    }
 
-    if (agg_first_col) { // we have a parent, so we should draw an aggregate row
+        // we have a parent, so we should draw an aggregate row
         m_total_row_count += 1;
         foreach(ViewColumnSet *set, m_gridview->sets()) {
             foreach(ViewColumn *col, set->columns()) {
@@ -531,129 +807,60 @@ void DwarfModel::build_row(const QString &key) {
         }
     }
 
-    foreach(Dwarf *d, m_grouped_dwarves.value(key)) {
-        if(!d)
-            continue;
-
-        QStandardItem *i_name = new QStandardItem(d->nice_name());
-        bool name_italic = false;
-
-        if(m_decorate_nobles){
-            if((m_group_by==GB_SQUAD && (m_df->get_squad(d->squad_id()) && d->squad_position()==0)) || d->noble_position() != ""){
-                i_name->setText(QString("%1 %2 %1").arg(m_symbol).arg(i_name->text()));
-                name_italic = true;
-            }
-        }
-
-        //background gradients for nobles
-        if(m_highlight_nobles){
-            if(d->noble_position() != ""){
-                QColor col = m_df->fortress()->get_noble_color(d->historical_id());
-                i_name->setData(build_gradient_brush(col,col.alpha(),0,QPoint(0,0),QPoint(1,0)),Qt::BackgroundRole);
-                i_name->setData(complement(col,0.25),Qt::ForegroundRole);
-            }
-        }
+    return agg_items;
+}
 
-        //set cursed colors
-        if(m_highlight_cursed){
-            switch(d->get_curse_type()){
-            case eCurse::VAMPIRE:
-            case eCurse::WEREBEAST:
-            {
-                name_italic = true;
-                i_name->setData(m_cursed_bg,Qt::BackgroundRole);
-                i_name->setData(complement(m_curse_col,0.25),Qt::ForegroundRole);
-            }
-                break;
-            case eCurse::OTHER:
-            {
-                name_italic = true;
-                i_name->setData(m_cursed_bg_light,Qt::BackgroundRole);
-            }
-                break;
-            default:
-                break;
-            }
-        }
+void DwarfModel::apply_grouping(Dwarf *d, const QList<QStandardItem*> &items) {
+    QStandardItem *i_name = items.at(0);
+    QString name = d->nice_name();
+    bool name_italic = false;
 
-        i_name->setData(get_font(d->active_military(),name_italic),Qt::FontRole);
-        if(m_show_tooltips){
-            i_name->setToolTip(d->tooltip_text());
-        }else{
-            i_name->setData(d->tooltip_text(),DwarfModel::DR_TOOLTIP);
+    if(m_decorate_nobles){
+        if((m_group_by==GB_SQUAD && (m_df->get_squad(d->squad_id()) && d->squad_position()==0)) || d->noble_position() != ""){
+            name = QString("%1 %2 %1").arg(m_symbol).arg(name);
+            name_italic = true;
         }
+    }
+    if(m_highlight_cursed && d->get_curse_type() != eCurse::NONE)
+        name_italic = true;
 
-        i_name->setStatusTip(d->nice_name());
-        i_name->setData(false, DR_IS_AGGREGATE);
-        i_name->setData(0, DR_RATING);
-        i_name->setData(d->id(), DR_ID);
+    i_name->setText(name);
+    i_name->setData(get_font(d->active_military(),name_italic),Qt::FontRole);
 
-        //set the roles for the special right click sorting
-        i_name->setData(d->get_age_in_ticks(), DR_AGE);
-        i_name->setData(d->body_size(), DR_SIZE);
-        i_name->setData(d->nice_name(), DR_NAME);
+    //every cell of the row carries the global sort value, the hidden global sort column reads it
+    QVariant global_key = d->get_global_sort_key(m_group_by);
+    foreach(QStandardItem *item, items){
+        item->setData(global_key, DR_GLOBAL);
+    }
 
-        i_name->setData(d->get_global_sort_key(m_group_by), DR_GLOBAL);
-
-        //set the sorting within groups when grouping
-        QVariant sort_val;
-        switch(m_group_by) {
-        case GB_PROFESSION:
-            sort_val = d->raw_profession();
-            break;
-        case GB_HAPPINESS:
-            sort_val = d->get_raw_happiness();
-            break;
-        case GB_SQUAD:
-        {
-            sort_val = d->squad_position();
-            if(sort_val.toInt() < 0)
-                sort_val = d->nice_name();
-        }
-            break;
-        case GB_AGE:
-            sort_val = d->get_age_in_ticks();
-            break;
-        case GB_SEX_ORIENT:
-            sort_val = d->get_gender_orient_desc();
-            break;
-        case GB_NOTHING:
-        default:
+    //set the sorting within groups when grouping
+    QVariant sort_val;
+    switch(m_group_by) {
+    case GB_PROFESSION:
+        sort_val = d->raw_profession();
+        break;
+    case GB_HAPPINESS:
+        sort_val = d->get_raw_happiness();
+        break;
+    case GB_SQUAD:
+    {
+        sort_val = d->squad_position();
+        if(sort_val.toInt() < 0)
             sort_val = d->nice_name();
-            break;
-        }
-        i_name->setData(sort_val, DR_SORT_VALUE);
-        //        i_name->setData(sort_val, DR_GLOBAL);
-
-        //set gender icons
-        if(m_show_gender){
-            icn_gender.addFile(d->gender_icon_path());
-            i_name->setIcon(icn_gender);
-        }
-
-        QList<QStandardItem*> items;
-        items << i_name;
-        int col_idx = 1;
-        foreach(ViewColumnSet *set, m_gridview->sets()) {
-            foreach(ViewColumn *col, set->columns()) {
-                QStandardItem *item = col->build_cell(d);
-                if(col_idx == GLOBAL_SORT_COL_IDX)//update the hidden global sort column's related cell global sort value
-                    item->setData(d->get_global_sort_key(m_group_by),DwarfModel::DR_GLOBAL);
-                items << item;
-            }
-        }
-
-        if (agg_first_col) {
-            agg_first_col->appendRow(items);
-        } else {
-            appendRow(items);
-        }
-        d->m_name_idx = indexFromItem(i_name);
-        m_total_row_count += 1;
     }
-    if (agg_first_col) {
-        appendRow(agg_items);
+        break;
+    case GB_AGE:
+        sort_val = d->get_age_in_ticks();
+        break;
+    case GB_SEX_ORIENT:
+        sort_val = d->get_gender_orient_desc();
+        break;
+    case GB_NOTHING:
+    default:
+        sort_val = d->nice_name();
+        break;
     }
+    i_name->setData(sort_val, DR_SORT_VALUE);
 }
 void DwarfModel::set_global_group_sort_info(int role, Qt::SortOrder order){
     m_global_group_sort_info.insert(m_group_by,qMakePair(role,order));
@@ -708,13 +915,11 @@ void DwarfModel::cell_activated(const QModelIndex &idx, DwarfModelProxy *proxy)
         int settable_dwarves = 0;
         QString group_name = idx.data(DwarfModel::DR_GROUP_NAME).toString();
 
-        QList<Dwarf*> filtered;
+        QSet<Dwarf*> filtered;
         bool filter = false;
-        int row_count = rowCount(first_col)-1;
         if(proxy && proxy->has_filters()){
             filter = true;
-            filtered = proxy->get_filtered_dwarves();
-            row_count = filtered.count()-1;
+            filtered = proxy->get_filtered_dwarves().toSet();
         }
 
         foreach(Dwarf *d, m_grouped_dwarves.value(group_name)) {
@@ -737,11 +942,9 @@ void DwarfModel::cell_activated(const QModelIndex &idx, DwarfModelProxy *proxy)
             }
         }
 
-        // tell the view what we touched...
-        emit dataChanged(idx, idx);
-        QModelIndex left = index(0, 0, first_col);
-        QModelIndex right = index(row_count, columnCount(first_col) - 1, first_col);
-        emit dataChanged(left, right); // tell the view we changed every dwarf under this agg to pick up implicit exclusive changes
+        // tell the view what we touched, including every dwarf under this agg to pick up implicit exclusive changes
+        invalidate_rows(idx.parent(), idx.row(), idx.row());
+        invalidate_rows(first_col, 0, rowCount(first_col) - 1);
     } else {
         if (type == CT_LABOR)
             m_dwarves[dwarf_id]->toggle_labor(labor_id);
@@ -781,13 +984,9 @@ void DwarfModel::cell_activated(const QModelIndex &idx, DwarfModelProxy *proxy)
             }
         }
 
-        QModelIndex left = index(idx.parent().row(), 0, idx.parent().parent());
-        QModelIndex right = index(idx.parent().row(), columnCount(idx.parent()) - 1, idx.parent().parent());
-        emit dataChanged(left, right); // update the agg row
-
-        left = index(idx.row(), 0, idx.parent());
-        right = index(idx.row(), columnCount(idx.parent()) - 1, idx.parent());
-        emit dataChanged(left, right); // update the dwarf row
+        if(idx.parent().isValid())
+            invalidate_rows(idx.parent().parent(), idx.parent().row(), idx.parent().row()); // update the agg row
+        invalidate_rows(idx.parent(), idx.row(), idx.row()); // update the dwarf row
     }
 }
 
@@ -797,12 +996,19 @@ void DwarfModel::set_group_by(int group_by) {
     if(!m_df.isNull()){
         QTime t;
         t.start();
-        build_rows();
-        LOGI << "loaded rows for" << m_gridview->name() << t.elapsed() << "ms";
+        //only the grouping changed, move the existing rows instead of building new cells
+        if(m_rows_view == m_gridview && m_rows_group_by >= 0 && m_rows_group_by != m_group_by && regroup()){
+            LOGI << "regrouped rows for" << m_gridview->name() << t.elapsed() << "ms";
+        }else{
+            build_rows();
+            LOGI << "loaded rows for" << m_gridview->name() << t.elapsed() << "ms";
+        }
     }
 }
 
 void DwarfModel::calculate_pending() {
+    //pending changes can move units to other groups (labors, professions, squads)
+    invalidate_group_keys();
     int changes = 0;
     foreach(Dwarf *d, m_dwarves) {
         changes += d->pending_changes();
@@ -934,9 +1140,10 @@ QBrush DwarfModel::build_gradient_brush(QColor base_col, int alpha_start, int al
 
 void DwarfModel::read_settings(){
     QSettings *s = DT->user_settings();
+    const SettingsSnapshot &opts = DT->settings();
 
     //font
-    m_font = s->value("options/grid/font", QFont(DefaultFonts::getRowFontName(), DefaultFonts::getRowFontSize())).value<QFont>();
+    m_font = opts.grid_font;
 
     //noble symbol
     QFontMetrics fm(m_font);
@@ -950,15 +1157,15 @@ void DwarfModel::read_settings(){
     m_show_gender = s->value("options/grid/show_gender_icons",true).toBool();
     m_decorate_nobles = s->value("options/grid/decorate_noble_names",false).toBool();
     m_highlight_nobles = s->value("options/highlight_nobles",true).toBool();
-    m_highlight_cursed = s->value("options/highlight_cursed",false).toBool();
+    m_highlight_cursed = opts.highlight_cursed;
     m_curse_col = s->value("options/colors/cursed", FortressEntity::get_default_color(FortressEntity::CURSED)).value<QColor>();
     m_cursed_bg = build_gradient_brush(m_curse_col,m_curse_col.alpha(),0,QPoint(0,0),QPoint(1,0));
     m_cursed_bg_light = build_gradient_brush(m_curse_col, 50,0,QPoint(0,0),QPoint(1,0)); //keep a weakly highlighted version
     m_show_labor_counts = s->value("options/grid/show_labor_counts",false).toBool();
-    m_show_tooltips = s->value("options/grid/show_tooltips",true).toBool();
+    m_show_tooltips = opts.show_tooltips;
 
-    m_cell_width = s->value("options/grid/cell_size", DEFAULT_CELL_SIZE).toInt();
-    m_cell_padding = s->value("options/grid/cell_padding", 0).toInt();
+    m_cell_width = opts.cell_size;
+    m_cell_padding = opts.cell_padding;
     m_cell_width += (m_cell_padding*2)+2;
 }
 
@@ -24,6 +24,7 @@ THE SOFTWARE.
 #define DWARF_MODEL_H
 
 #include <QStandardItemModel>
+#include <QSet>
 #include "columntypes.h"
 #include "dfinstance.h"
 
@@ -143,7 +144,10 @@ public:
 
 public slots:
     void draw_headers();
+    //! queue a refresh of the headers showing id, applied once per event loop turn
     void update_header_info(int id, COLUMN_TYPE type);
+    //! apply the queued header and cell updates
+    void flush_invalidations();
 
     void build_row(const QString &key);
     void build_rows();
@@ -170,6 +174,35 @@ private:
     int m_total_row_count;
     bool m_clearing_data;
 
+    //group names of every unit for every grouping, computed once per refresh
+    QHash<int, QVector<int> > m_group_keys; //unit id -> index in m_group_names per GROUP_BY
+    QStringList m_group_names;
+    QHash<int, QMap<QString, QVector<Dwarf*> > > m_group_index; //sorted groups, built on first use of a grouping
+    bool m_group_keys_valid;
+    int m_rows_group_by; //grouping of the rows currently in the model, -1 if none
+    GridView *m_rows_view;
+
+    QString fortress_race_name() const;
+    QString group_name(Dwarf *d, GROUP_BY group_by, const QString &race_name) const;
+    void build_group_keys();
+    void invalidate_group_keys();
+    const QMap<QString, QVector<Dwarf*> > &group_index(GROUP_BY group_by, bool only_animals);
+    //! move the existing unit rows into the groups of the current grouping
+    bool regroup();
+    QList<QStandardItem*> build_aggregate_row(const QString &key);
+    //! update the parts of a unit's row that depend on the grouping
+    void apply_grouping(Dwarf *d, const QList<QStandardItem*> &items);
+
+    //changes gathered during an operation and emitted together by flush_invalidations
+    QMultiHash<int,int> m_labor_headers; //labor id -> header index of the labor's columns
+    QSet<int> m_dirty_labor_headers;
+    QHash<QPersistentModelIndex, QPair<int,int> > m_dirty_rows; //parent -> first and last changed row
+    bool m_flush_scheduled;
+
+    void schedule_flush();
+    void invalidate_rows(const QModelIndex &parent, int first, int last);
+    void refresh_labor_header(int col_idx);
+
     //options
     QFont m_font;
     QChar m_symbol;
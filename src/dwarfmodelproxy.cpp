@@ -26,9 +26,9 @@ THE SOFTWARE.
 #include "dwarf.h"
 #include "defines.h"
 #include "dwarftherapist.h"
+#include "profiler.h"
 
 #include <QJSEngine>
-#include <QSettings>
 
 DwarfModelProxy::DwarfModelProxy(QObject *parent)
     :QSortFilterProxyModel(parent)
@@ -42,7 +42,7 @@ DwarfModelProxy::DwarfModelProxy(QObject *parent)
 }
 
 void DwarfModelProxy::read_settings(){
-    m_show_tooltips = DT->user_settings()->value("options/grid/show_tooltips",true).toBool();
+    m_show_tooltips = DT->settings().show_tooltips;
 }
 
 DwarfModel* DwarfModelProxy::get_dwarf_model() const {
@@ -129,6 +129,7 @@ void DwarfModelProxy::clear_script(const FILTER_SCRIPT_TYPE sType, const bool re
 }
 
 bool DwarfModelProxy::filterAcceptsRow(int source_row, const QModelIndex &source_parent) const {
+    PROFILE_SCOPE_CAT("filterAcceptsRow", "view");
     bool matches = true;
 
     int dwarf_id = 0;
@@ -77,6 +77,14 @@ void DwarfStats::init(const QVector<double> &values)
         m_stats->set_list(values);
 }
 
+void DwarfStats::init_sorted(const QVector<double> &sorted_values)
+{
+    if (!m_stats)
+        m_stats = std::make_unique<RoleStats>(sorted_values, m_invalid_value, m_override);
+    else
+        m_stats->set_sorted_list(sorted_values);
+}
+
 double DwarfStats::rating(double val) const
 {
     if (m_stats)
@@ -52,6 +52,8 @@ public:
     static DwarfStats roles;
 
     void init(const QVector<double> &values);
+    //! same as init for values which are already in ascending order
+    void init_sorted(const QVector<double> &sorted_values);
     double rating(double val) const;
 
 private:
@@ -43,6 +43,8 @@ THE SOFTWARE.
 #include "cellcolordef.h"
 #include "standardpaths.h"
 #include "memorylayoutmanager.h"
+#include "profiler.h"
+#include "headlessrunner.h"
 #include <QMessageBox>
 #include <QSettings>
 #include <QStyleFactory>
@@ -56,6 +58,7 @@ const QString DwarfTherapist::m_url_homepage = QString("https://github.com/%1/%2
 DwarfTherapist::DwarfTherapist(int &argc, char **argv)
     : QApplication(argc, argv)
     , m_main_window(0)
+    , m_headless(0)
     , m_options_menu(0)
     , m_allow_labor_cheats(false)
     , m_hide_non_adults(false)
@@ -66,6 +69,8 @@ DwarfTherapist::DwarfTherapist(int &argc, char **argv)
     , m_multiple_castes(false)
     , m_show_skill_learn_rates(false)
     , m_arena_mode(false) //manually set this to true to do arena testing (very hackish, all units will be animals)
+    , m_synthetic_units(0)
+    , m_synthetic_seed(1)
     , m_log_mgr(0)
 {
 #ifdef Q_OS_LINUX
@@ -96,6 +101,26 @@ DwarfTherapist::DwarfTherapist(int &argc, char **argv)
     parser.addOption(portable_option);
     QCommandLineOption devmode_option("devmode", tr("Start in developer mode (look for data and config files relatively to the executable and for static data in <source_datadir>)."), tr("source_datadir"));
     parser.addOption(devmode_option);
+    QCommandLineOption profile_option("profile", tr("Record a performance trace and write it to <path> (Chrome trace format) on exit."), tr("path"));
+    parser.addOption(profile_option);
+    QCommandLineOption synthetic_option("synthetic", tr("Do not connect to the game, generate a fortress of <units> units instead."), tr("units"));
+    parser.addOption(synthetic_option);
+    QCommandLineOption synthetic_seed_option("synthetic-seed", tr("Seed used to generate the synthetic fortress, the same seed always produces the same units."), tr("seed"));
+    parser.addOption(synthetic_seed_option);
+    QCommandLineOption headless_option("headless", tr("Run without a user interface: read the units, optionally apply an optimization plan, export the requested views and exit."));
+    parser.addOption(headless_option);
+    QCommandLineOption plan_option("plan", tr("Headless: apply the optimization plan <name> to all units."), tr("name"));
+    parser.addOption(plan_option);
+    QCommandLineOption commit_option("commit", tr("Headless: write the labor changes made by --plan to the game."));
+    parser.addOption(commit_option);
+    QCommandLineOption export_option("export-view", tr("Headless: export the grid view <name>, can be given several times."), tr("name"));
+    parser.addOption(export_option);
+    QCommandLineOption export_dir_option("export-dir", tr("Headless: directory the exported views are written to (default: current directory)."), tr("path"));
+    parser.addOption(export_dir_option);
+    QCommandLineOption format_option("format", tr("Headless: export format, csv (default) or jsonl (one JSON object per unit)."), tr("format"));
+    parser.addOption(format_option);
+    QCommandLineOption gzip_option("gzip", tr("Headless: gzip the exported files."));
+    parser.addOption(gzip_option);
     parser.process(*this);
 
     {
@@ -113,12 +138,42 @@ DwarfTherapist::DwarfTherapist(int &argc, char **argv)
             parser.isSet(trace_option));
     load_translator();
 
+    if (parser.isSet(profile_option)) {
+        m_trace_path = parser.value(profile_option);
+        Profiler::ptr()->set_enabled(true);
+    }
+
+    if (parser.isSet(synthetic_option)) {
+        m_synthetic_units = qMax(0, parser.value(synthetic_option).toInt());
+        if (parser.isSet(synthetic_seed_option))
+            m_synthetic_seed = parser.value(synthetic_seed_option).toUInt();
+        LOGI << "using a synthetic fortress of" << m_synthetic_units << "units";
+    }
+
     TRACE << "Creating settings object";
     m_user_settings = StandardPaths::settings();
+    publish_settings();
 
     TRACE << "Loading memory layouts";
     m_memory_layouts = std::make_unique<MemoryLayoutManager>();
 
+    if (parser.isSet(headless_option)) {
+        HeadlessRunner::options opts;
+        opts.plan = parser.value(plan_option);
+        opts.commit = parser.isSet(commit_option);
+        opts.views = parser.values(export_option);
+        opts.export_dir = parser.value(export_dir_option);
+        opts.format = parser.value(format_option).toLower();
+        opts.gzip = parser.isSet(gzip_option);
+
+        LOGI << "running headless";
+        m_headless = new HeadlessRunner(opts, this);
+        read_settings();
+        load_customizations();
+        QTimer::singleShot(0, m_headless, SLOT(run()));
+        return;
+    }
+
     TRACE << "Creating options menu";
     m_options_menu = new OptionsMenu;
 
@@ -147,6 +202,9 @@ DwarfTherapist::DwarfTherapist(int &argc, char **argv)
 }
 
 DwarfTherapist::~DwarfTherapist(){
+    if (!m_trace_path.isEmpty())
+        Profiler::ptr()->write_chrome_trace(m_trace_path);
+
     UnitHealth::cleanup();
 
     qDeleteAll(m_language);
@@ -158,9 +216,13 @@ DwarfTherapist::~DwarfTherapist(){
     qDeleteAll(m_super_labors);
     m_super_labors.clear();
 
+    delete m_headless;
     delete m_options_menu;
     delete m_main_window;
     delete m_log_mgr;
+
+    qDeleteAll(m_retired_settings);
+    delete m_settings.fetchAndStoreOrdered(0);
 }
 
 MainWindow* DwarfTherapist::get_main_window(){
@@ -177,6 +239,8 @@ MainWindow* DwarfTherapist::get_main_window(){
 DFInstance* DwarfTherapist::get_DFInstance(){
     if (m_main_window)
         return m_main_window->get_DFInstance();
+    else if (m_headless)
+        return m_headless->get_DFInstance();
     else
         return nullptr;
 }
@@ -228,6 +292,8 @@ void DwarfTherapist::setup_logging(const QString &path, bool debug_logging, bool
 }
 
 QList<Dwarf*> DwarfTherapist::get_dwarves(){
+    if (m_headless)
+        return m_headless->get_model()->get_dwarves();
     return m_main_window->get_model()->get_dwarves();
 }
 
@@ -246,16 +312,23 @@ void DwarfTherapist::read_settings() {
     if (m_user_settings->value("it_feels_like_the_first_time", true).toBool() ||
             !m_user_settings->contains("options/colors/happiness/1") ||
             !m_user_settings->contains("options/colors/nobles/1")) {
-        m_options_menu->write_settings(); //write it out so that we can get default colors loaded
+        //write it out so that we can get default colors loaded
+        if (m_options_menu)
+            m_options_menu->write_settings();
+        else
+            OptionsMenu::write_default_settings();
+        publish_settings();
         emit settings_changed(); // this will cause delegates to get the right default colors
         m_user_settings->setValue("it_feels_like_the_first_time", false);
     }
 
     m_user_settings->beginGroup("options");
-    if (m_user_settings->value("show_toolbutton_text", true).toBool()) {
-        m_main_window->get_toolbar()->setToolButtonStyle(Qt::ToolButtonTextUnderIcon);
-    } else {
-        m_main_window->get_toolbar()->setToolButtonStyle(Qt::ToolButtonIconOnly);
+    if (m_main_window) {
+        if (m_user_settings->value("show_toolbutton_text", true).toBool()) {
+            m_main_window->get_toolbar()->setToolButtonStyle(Qt::ToolButtonTextUnderIcon);
+        } else {
+            m_main_window->get_toolbar()->setToolButtonStyle(Qt::ToolButtonIconOnly);
+        }
     }
 
     m_allow_labor_cheats = m_user_settings->value("allow_labor_cheats", false).toBool();
@@ -295,6 +368,7 @@ void DwarfTherapist::read_settings() {
     DTStandardItem::set_show_tooltips(DT->user_settings()->value("grid/show_tooltips",true).toBool());
 
     m_user_settings->endGroup();
+    publish_settings();
     LOGI << "finished reading settings";
     //emit the settings_changed to everything else after we've refreshed our global settings
     emit settings_changed();
@@ -342,7 +416,8 @@ void DwarfTherapist::load_customizations(){
     }
     m_user_settings->endArray();
 
-    m_main_window->load_customizations();
+    if (m_main_window)
+        m_main_window->load_customizations();
 }
 
 void DwarfTherapist::emit_units_refreshed(){
@@ -610,9 +685,21 @@ void DwarfTherapist::del_custom_profession(CustomProfession *cp){
 
 //! convenience method
 Dwarf *DwarfTherapist::get_dwarf_by_id(int dwarf_id) {
+    if (m_headless)
+        return m_headless->get_model()->get_dwarf_by_id(dwarf_id);
     return m_main_window->get_model()->get_dwarf_by_id(dwarf_id);
 }
 
+QStringList DwarfTherapist::get_unit_names(const QList<int> &ids) {
+    QStringList names;
+    foreach(int id, ids) {
+        if (Dwarf *d = get_dwarf_by_id(id))
+            names.append(d->nice_name());
+    }
+    names.sort();
+    return names;
+}
+
 void DwarfTherapist::load_game_translation_tables(DFInstance *df) {
     LOGI << "Loading language translation tables";
     qDeleteAll(m_language);
@@ -661,10 +748,18 @@ void DwarfTherapist::load_game_translation_tables(DFInstance *df) {
 
 void DwarfTherapist::emit_customizations_changed(){
     emit customizations_changed();
-    m_main_window->get_view_manager()->redraw_current_tab();
+    if (m_main_window)
+        m_main_window->get_view_manager()->redraw_current_tab();
+}
+
+void DwarfTherapist::publish_settings(){
+    const SettingsSnapshot *old = m_settings.fetchAndStoreOrdered(new SettingsSnapshot(m_user_settings.get()));
+    if(old)
+        m_retired_settings.append(old);
 }
 
 void DwarfTherapist::emit_settings_changed(){
+    publish_settings();
     emit settings_changed();
 }
 
@@ -673,14 +768,14 @@ void DwarfTherapist::emit_roles_changed(){
 }
 
 void DwarfTherapist::emit_labor_counts_updated(){
-    if(m_main_window->get_DFInstance()){
+    if(get_DFInstance()){
         emit labor_counts_updated();
-        if(get_main_window()->get_view_manager())
-            get_main_window()->get_view_manager()->redraw_current_tab_headers();
+        if(m_main_window && m_main_window->get_view_manager())
+            m_main_window->get_view_manager()->redraw_current_tab_headers();
     }
 }
 
 void DwarfTherapist::update_specific_header(int id, COLUMN_TYPE type){
-    if(m_main_window->get_DFInstance() && get_main_window()->get_view_manager())
+    if(m_main_window && m_main_window->get_DFInstance() && m_main_window->get_view_manager())
         get_main_window()->get_view_manager()->redraw_specific_header(id,type);
 }
@@ -32,8 +32,10 @@ THE SOFTWARE.
 #include <QSharedPointer>
 #include <QVariant>
 #include <QColor>
+#include <QAtomicPointer>
 #include <memory>
 #include "global_enums.h"
+#include "settingssnapshot.h"
 
 class QTreeWidgetItem;
 class OptionsMenu;
@@ -47,6 +49,7 @@ class CellColorDef;
 class MainWindow;
 class DFInstance;
 class MemoryLayoutManager;
+class HeadlessRunner;
 
 class DwarfTherapist : public QApplication {
     Q_OBJECT
@@ -64,9 +67,16 @@ public:
     QList<SuperLabor*> get_super_labors();
 
     MainWindow *get_main_window();
+    bool headless() const {return m_headless != 0;}
     QSettings *user_settings() {return m_user_settings.get();}
+    //! typed copy of the settings, safe to read from any thread
+    const SettingsSnapshot &settings() const {return *m_settings.loadAcquire();}
+    //! rebuild the snapshot, needed after writing settings without read_settings
+    void publish_settings();
     OptionsMenu *get_options_menu() {return m_options_menu;}
     Dwarf *get_dwarf_by_id(int dwarf_id);
+    //! sorted display names of the given units, population stats only keep ids
+    QStringList get_unit_names(const QList<int> &ids);
 
     void load_game_translation_tables(DFInstance *df);
     QString get_generic_word(const uint &offset) {return m_generic_words.value(offset, "UNKNOWN");}
@@ -92,6 +102,8 @@ public:
     bool show_skill_learn_rates() const {return m_show_skill_learn_rates;}
     void show_skill_learn_rates(const bool val) {m_show_skill_learn_rates = val;}
     bool arena_mode() const {return m_arena_mode;}
+    int synthetic_units() const {return m_synthetic_units;}
+    quint32 synthetic_seed() const {return m_synthetic_seed;}
 
     void emit_settings_changed();
     void emit_roles_changed();
@@ -135,7 +147,10 @@ private:
     QMap<int, CustomProfession*> m_custom_prof_icns;
     QMap<QString,SuperLabor*> m_super_labors;
     std::unique_ptr<QSettings> m_user_settings;
+    QAtomicPointer<const SettingsSnapshot> m_settings;
+    QList<const SettingsSnapshot*> m_retired_settings; //!< previous snapshots, readers may still hold them
     MainWindow *m_main_window;
+    HeadlessRunner *m_headless; //!< drives the run instead of the main window when started with --headless
     OptionsMenu *m_options_menu;
     std::unique_ptr<MemoryLayoutManager> m_memory_layouts;
 
@@ -149,8 +164,11 @@ private:
     bool m_multiple_castes;
     bool m_show_skill_learn_rates;
     bool m_arena_mode;
+    int m_synthetic_units; //!< generate a fortress of this many units instead of connecting (--synthetic)
+    quint32 m_synthetic_seed;
 
     LogManager *m_log_mgr;
+    QString m_trace_path; //!< performance trace written on exit when started with --profile
     QHash<GLOBAL_COLOR_TYPES,QSharedPointer<CellColorDef> > m_colors;
     QHash<DWARF_HAPPINESS,QColor> m_happiness_colors;
 
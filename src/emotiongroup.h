@@ -27,8 +27,10 @@ THE SOFTWARE.
 
 #include <QObject>
 #include <QMap>
+#include <QSet>
 #include <QString>
 #include <QVariant>
+#include "generationarena.h"
 
 class UnitEmotion;
 class Dwarf;
@@ -38,6 +40,7 @@ class EmotionGroup : public QObject
     Q_OBJECT
 
 public:
+    GENERATION_ALLOCATED
     EmotionGroup(QObject *parent = 0)
         : QObject(parent)
         , m_stress_count(0)
@@ -47,8 +50,9 @@ public:
     }
 
     struct emotion_count{
+        emotion_count() : count(0) {}
         int count;
-        QMap<QString,QVariant> unit_ids;
+        QSet<int> unit_ids; //!< names are only resolved when displayed
     };
 
     int get_stress_count() {return m_stress_count;}
@@ -73,9 +77,9 @@ private:
     int m_unaffected_count;
     int m_eustress_count;
 
-    QList<int> m_stress_ids;
-    QList<int> m_eustress_ids;
-    QList<int> m_unaffected_ids;
+    QSet<int> m_stress_ids;
+    QSet<int> m_eustress_ids;
+    QSet<int> m_unaffected_ids;
 };
 
 #endif // EMOTIONGROUP_H
@@ -24,24 +24,195 @@ THE SOFTWARE.
 #include "dfinstance.h"
 #include "dwarftherapist.h"
 #include "equipmentoverviewwidget.h"
-#include "equipwarn.h"
 #include "item.h"
 #include "adaptivecolorfactory.h"
+#include "searchfiltertreeview.h"
+#include "utils.h"
 
 #include <QCheckBox>
+#include <QCloseEvent>
 #include <QLabel>
 #include <QLayout>
 #include <QPainter>
+#include <QPushButton>
 #include <QSettings>
+#include <QTreeView>
+#include <QVBoxLayout>
 
 QString EquipmentOverviewWidget::m_option_name = "options/docks/equipoverview_include_mats";
 
+EquipWarnModel::EquipWarnModel(QObject *parent)
+    : StatsTreeModel(QStringList() << tr("Item") << tr("Status") << tr("Count"), parent)
+{
+    m_wear_level_desc.insert(Item::IS_MISSING,Item::missing_group_name());
+    m_wear_level_desc.insert(Item::IS_UNCOVERED,Item::uncovered_group_name());
+    m_wear_level_desc.insert(Item::IS_CLOTHED,tr("No Worn/Missing Equipment"));
+    m_wear_level_desc.insert(Item::IS_WORN,tr("Some Wear"));
+    m_wear_level_desc.insert(Item::IS_THREADBARE,tr("Threadbare"));
+    m_wear_level_desc.insert(Item::IS_TATTERED,tr("Tattered"));
+}
+
+void EquipWarnModel::refresh(DFInstance *df){
+    m_item_types.clear();
+    std::vector<group_layout> layout;
+    if(df){
+        QHash<ITEM_TYPE,EquipWarn*> eq_warnings = df->get_equip_warnings();
+        for(auto it = eq_warnings.constBegin(); it != eq_warnings.constEnd(); ++it){
+            EquipWarn *ew = it.value();
+            //copy the counts, the warnings are rebuilt by the next read
+            item_type_row row;
+            row.total_count = ew->get_total_count();
+            row.wear_counts = ew->get_wear_counts();
+
+            group_layout g;
+            g.key = QString::number(it.key());
+            QHash<QPair<QString,Item::ITEM_STATE>, EquipWarn::warn_count> details = ew->get_details();
+            for(auto d = details.constBegin(); d != details.constEnd(); ++d){
+                QString child = QString("%1\n%2").arg((int)d.key().second).arg(d.key().first);
+                row.details.insert(child, qMakePair(d.key(), d.value()));
+                g.children.append(child);
+            }
+            m_item_types.insert(g.key, row);
+            layout.push_back(g);
+        }
+    }
+    set_layout(layout);
+}
+
+QVariant EquipWarnModel::group_data(const QString &group, int column, int role) const{
+    auto it = m_item_types.find(group);
+    if(it == m_item_types.end())
+        return QVariant();
+    const item_type_row &row = *it;
+    ITEM_TYPE i_type = static_cast<ITEM_TYPE>(group.toInt());
+    QString item_name = Item::get_item_generic_name(i_type);
+
+    switch(role){
+    case Qt::DisplayRole:
+        if(column == 0)
+            return capitalize(item_name);
+        break;
+    case Qt::ToolTipRole:
+    {
+        QStringList warn_desc;
+        foreach(Item::ITEM_STATE i_status, row.wear_counts.keys()){
+            warn_desc.append(tr("<font color=%1>%2 %3</font>")
+                             .arg(Item::get_color(i_status).name())
+                             .arg(row.wear_counts.value(i_status))
+                             .arg(m_wear_level_desc.value(i_status)));
+        }
+        return QString("<center><h4>%1 %2</h4></center>%3")
+                .arg(QString::number(row.total_count))
+                .arg(capitalize(item_name))
+                .arg(warn_desc.join("<br/><br/>"));
+    }
+    case Qt::UserRole:
+        return i_type;
+    case WearCountsRole:
+    {
+        QVariantMap warn_counts;
+        for(auto w = row.wear_counts.constBegin(); w != row.wear_counts.constEnd(); ++w)
+            warn_counts.insert(QString::number((int)w.key()),QVariant(w.value()));
+        return warn_counts;
+    }
+    case SortRole:
+        if(column == 0)
+            return item_name.toLower();
+        else if(column == 2)
+            return row.total_count;
+        break;
+    case UnitIdsRole:
+    {
+        QVariantList ids;
+        for(auto d = row.details.constBegin(); d != row.details.constEnd(); ++d){
+            foreach(int id, d.value().second.unit_ids)
+                ids.append(id);
+        }
+        return ids;
+    }
+    }
+    return QVariant();
+}
+
+QVariant EquipWarnModel::child_data(const QString &group, const QString &child, int column, int role) const{
+    auto it = m_item_types.find(group);
+    if(it == m_item_types.end() || !it->details.contains(child))
+        return QVariant();
+    const auto &detail = it->details[child];
+    const QString &detail_name = detail.first.first;
+    Item::ITEM_STATE i_status = detail.first.second;
+    const EquipWarn::warn_count &wc = detail.second;
+    QString wear_desc = m_wear_level_desc.value(i_status);
+
+    switch(role){
+    case Qt::DisplayRole:
+        if(column == 0)
+            return detail_name;
+        else if(column == 1)
+            return wear_desc;
+        else
+            return QString("%1").arg(wc.count,2,10,QChar('0'));
+    case Qt::TextColorRole:
+        if(column == 1)
+            return AdaptiveColorFactory().color(Item::get_color(i_status));
+        break;
+    case Qt::TextAlignmentRole:
+        if(column == 2)
+            return Qt::AlignRight;
+        break;
+    case Qt::ToolTipRole:
+    {
+        //only resolve the names when they're shown
+        QColor col = Item::get_color(i_status);
+        QStringList unit_names = DT->get_unit_names(wc.unit_ids.toList());
+        return QString("<center><h4><font color=%1>%2 %3 (%4)</font></h4></center>%5%6")
+                .arg(col.name())
+                .arg(wc.count)
+                .arg(detail_name)
+                .arg(wear_desc)
+                .arg(wc.count != wc.unit_ids.count() ? tr("%1 items (<font color=%2>%3</font>) among %4 citizens.<br/><br/>")
+                                                       .arg(wc.count)
+                                                       .arg(col.name())
+                                                       .arg(wear_desc)
+                                                       .arg(wc.unit_ids.count()) : "")
+                .arg(unit_names.join(unit_names.size() < 20 ? "<br/>" : ", "));
+    }
+    case Qt::UserRole:
+        return detail_name;
+    case SortRole:
+        if(column == 0)
+            return detail_name.toLower();
+        else if(column == 1)
+            return wear_desc;
+        else
+            return wc.count;
+    case UnitIdsRole:
+    {
+        QVariantList ids;
+        foreach(int id, wc.unit_ids)
+            ids.append(id);
+        return ids;
+    }
+    }
+    return QVariant();
+}
+
 EquipmentOverviewWidget::EquipmentOverviewWidget(QWidget *parent)
-    : BaseTreeWidget(true, parent)
+    : QWidget(parent)
+    , m_model(new EquipWarnModel(this))
 {
-    m_tree_view->setColumnCount(3);
-    m_tree_view->setHeaderLabels(QStringList() << tr("Item") << tr("Status") << tr("Count"));
-    m_tree_view->setItemDelegate(new EquipWarnItemDelegate(m_tree_view));
+    QVBoxLayout *l = new QVBoxLayout();
+    setLayout(l);
+
+    m_tree = new SearchFilterTreeView(this);
+    m_tree->set_filter_mode(SortFilterProxyModel::RecursiveMode);
+    m_tree->set_model(m_model);
+    m_tree->filter_proxy().setSortRole(EquipWarnModel::SortRole);
+    m_tree->view()->setSelectionMode(QAbstractItemView::ExtendedSelection);
+    m_tree->view()->setItemDelegate(new EquipWarnItemDelegate(m_tree->view()));
+    m_tree->view()->sortByColumn(2,Qt::DescendingOrder); //count
+
+    QPushButton *btn = new QPushButton(tr("Clear Filter"),this);
 
     QCheckBox *chk_mats = new QCheckBox(tr("Include item materials"),this);
     chk_mats->setChecked(DT->user_settings()->value(m_option_name,false).toBool());
@@ -50,149 +221,71 @@ EquipmentOverviewWidget::EquipmentOverviewWidget(QWidget *parent)
     lbl_read->setSizePolicy(QSizePolicy::Preferred,QSizePolicy::Minimum);
     lbl_read->hide();
 
-    layout()->addWidget(chk_mats);
-    layout()->addWidget(lbl_read);
+    l->addWidget(m_tree);
+    l->addWidget(btn);
+    l->addWidget(chk_mats);
+    l->addWidget(lbl_read);
 
+    connect(btn, SIGNAL(clicked()), this, SLOT(clear_filter()));
     connect(chk_mats, SIGNAL(clicked(bool)),this,SLOT(check_changed(bool)));
+    connect(m_tree, SIGNAL(item_selection_changed(const QItemSelection &, const QItemSelection &)),
+            this, SLOT(selection_changed()));
+    //item types span the whole row, their wear totals are drawn by the delegate
+    connect(&m_tree->filter_proxy(), SIGNAL(rowsInserted(QModelIndex,int,int)), this, SLOT(span_item_types()));
+    connect(&m_tree->filter_proxy(), SIGNAL(layoutChanged()), this, SLOT(span_item_types()));
+    connect(&m_tree->filter_proxy(), SIGNAL(modelReset()), this, SLOT(span_item_types()));
 
     m_option_state = chk_mats->isChecked();
 
-    m_wear_level_desc.insert(Item::IS_MISSING,Item::missing_group_name());
-    m_wear_level_desc.insert(Item::IS_UNCOVERED,Item::uncovered_group_name());
-    m_wear_level_desc.insert(Item::IS_CLOTHED,tr("No Worn/Missing Equipment"));
-    m_wear_level_desc.insert(Item::IS_WORN,tr("Some Wear"));
-    m_wear_level_desc.insert(Item::IS_THREADBARE,tr("Threadbare"));
-    m_wear_level_desc.insert(Item::IS_TATTERED,tr("Tattered"));
+    if(DT){
+        connect(DT,SIGNAL(units_refreshed()),this,SLOT(refresh()));
+    }
 }
 
-void EquipmentOverviewWidget::build_tree(){
+void EquipmentOverviewWidget::refresh(){
     lbl_read->hide();
-
-    if(DT && DT->get_DFInstance()){
-        QString tooltip;
-
-        m_option_state = DT->user_settings()->value(m_option_name,false).toBool();
-        QHash<ITEM_TYPE,EquipWarn*> eq_warnings = DT->get_DFInstance()->get_equip_warnings();
-
-        foreach(ITEM_TYPE i_type, eq_warnings.uniqueKeys()){
-            EquipWarn *ew = eq_warnings.value(i_type);
-            QString item_name = Item::get_item_generic_name(i_type);
-            QStringList warn_desc;
-            QVariantMap warn_counts;
-            foreach(Item::ITEM_STATE i_status, ew->get_wear_counts().uniqueKeys()){
-                int count = ew->get_wear_counts().value(i_status);
-                warn_desc.append(tr("<font color=%1>%2 %3</font>")
-                                 .arg(Item::get_color(i_status).name())
-                                 .arg(count)
-                                 .arg(m_wear_level_desc.value(i_status)));
-                warn_counts.insert(QString::number((int)i_status),QVariant(count));
-            }
-            tooltip = QString("<center><h4>%1 %2</h4></center>%3")
-                    .arg(QString::number(ew->get_total_count()))
-                    .arg(capitalize(item_name))
-                    .arg(warn_desc.join("<br/><br/>"));
-
-            SortableTreeItem* item_type_node = new SortableTreeItem();
-            item_type_node->setData(0, Qt::UserRole, i_type);
-            item_type_node->setText(0, capitalize(item_name));
-            item_type_node->setToolTip(0,tooltip);
-            item_type_node->setData(0,Qt::UserRole+1, warn_counts);
-
-            //custom sorting
-            item_type_node->setData(0,SortableTreeItem::TREE_SORT_COL,item_name.toLower());
-            item_type_node->setData(2,SortableTreeItem::TREE_SORT_COL+2,ew->get_total_count());
-
-            AdaptiveColorFactory adaptive;
-            QPair<QString,Item::ITEM_STATE> warn_key;
-            foreach(warn_key, ew->get_details().uniqueKeys()){
-                EquipWarn::warn_count wc = ew->get_details().value(warn_key);
-
-                QString detail_name = warn_key.first;
-                Item::ITEM_STATE i_status = warn_key.second;
-                QString wear_desc = m_wear_level_desc.value(i_status);
-
-                QColor col = Item::get_color(i_status);
-                SortableTreeItem *item_node = new SortableTreeItem(item_type_node);
-                QStringList unit_names = wc.unit_ids.keys();
-                tooltip = QString("<center><h4><font color=%1>%2 %3 (%4)</font></h4></center>%5%6")
-                        .arg(col.name())
-                        .arg(wc.count)
-                        .arg(detail_name)
-                        .arg(wear_desc)
-                        .arg(wc.count != wc.unit_ids.count() ? tr("%1 items (<font color=%2>%3</font>) among %4 citizens.<br/><br/>")
-                                                               .arg(wc.count)
-                                                               .arg(col.name())
-                                                               .arg(wear_desc)
-                                                               .arg(wc.unit_ids.count()) : "")
-                        .arg(unit_names.join(unit_names.size() < 20 ? "<br/>" : ", "));
-
-                item_node->setData(0, Qt::UserRole, detail_name);
-                item_node->setToolTip(0, tooltip);
-                item_node->setText(0, detail_name);
-
-                item_node->setToolTip(1, tooltip);
-                item_node->setData(1,Qt::TextColorRole, adaptive.color(col));
-                item_node->setText(1,wear_desc);
-
-                item_node->setData(2, Qt::UserRole, wc.unit_ids.values());
-                item_node->setToolTip(2, tooltip);
-                item_node->setText(2,QString("%1").arg(wc.count,2,10,QChar('0')));
-                item_node->setTextAlignment(2,Qt::AlignRight);
-
-                //custom sorting
-                item_node->setData(0,SortableTreeItem::TREE_SORT_COL,detail_name.toLower());
-                item_node->setData(1,SortableTreeItem::TREE_SORT_COL+1,wear_desc);
-                item_node->setData(2,SortableTreeItem::TREE_SORT_COL+2,wc.count);
-
-            }
-            m_tree_view->addTopLevelItem(item_type_node);
-            item_type_node->setFirstColumnSpanned(true);
-        }
+    if(!DT)
+        return;
+    m_option_state = DT->user_settings()->value(m_option_name,false).toBool();
+    m_model->refresh(DT->get_DFInstance());
+    for(int i = 1; i < m_model->columnCount(); i++){
+        m_tree->view()->resizeColumnToContents(i);
     }
-        m_tree_view->sortByColumn(2,Qt::DescendingOrder); //count
 }
 
-void EquipmentOverviewWidget::search_tree(QString val){
-    val = "(" + val.replace(" ", "|") + ")";
-    QRegExp filter = QRegExp(val,Qt::CaseInsensitive, QRegExp::RegExp);
-    int hidden;
-    bool parent_matches;
-    for(int i = 0; i < m_tree_view->topLevelItemCount(); i++){
-        hidden = 0;
-        parent_matches = m_tree_view->topLevelItem(i)->text(0).contains(filter);
-        int count;
-        for(count = 0; count < m_tree_view->topLevelItem(i)->childCount(); count++){
-            if(!parent_matches && !m_tree_view->topLevelItem(i)->child(count)->text(0).contains(filter)){
-                m_tree_view->topLevelItem(i)->child(count)->setHidden(true);
-                hidden++;
-            }else{
-                m_tree_view->topLevelItem(i)->child(count)->setHidden(false);
-            }
-        }
-        if(hidden == count){
-            m_tree_view->topLevelItem(i)->setHidden(true);
-        }else{
-            m_tree_view->topLevelItem(i)->setHidden(false);
-        }
+void EquipmentOverviewWidget::clear(){
+    m_model->clear();
+}
+
+void EquipmentOverviewWidget::span_item_types(){
+    const QSortFilterProxyModel &proxy = m_tree->filter_proxy();
+    for(int row = 0; row < proxy.rowCount(); row++){
+        m_tree->view()->setFirstColumnSpanned(row, QModelIndex(), true);
     }
 }
 
 void EquipmentOverviewWidget::selection_changed(){
     QVariantList ids; //dwarf ids
-    foreach(QTreeWidgetItem *item, m_tree_view->selectedItems()){
-        if(item->childCount() <= 0){
-            ids.append(item->data(2,Qt::UserRole).toList());
-        }else{
-            for(int idx=0;idx < item->childCount();idx++){
-                ids.append(item->child(idx)->data(2,Qt::UserRole).toList());
-            }
-        }
+    foreach(QModelIndex index, m_tree->get_selection().indexes()){
+        if(index.column() == 0)
+            ids.append(index.data(EquipWarnModel::UnitIdsRole).toList());
     }
     emit item_selected(ids);
 }
 
+void EquipmentOverviewWidget::clear_filter(){
+    m_tree->view()->clearSelection();
+}
+
+void EquipmentOverviewWidget::closeEvent(QCloseEvent *event){
+    m_tree->clear_search();
+    clear_filter();
+    event->accept();
+}
+
 void EquipmentOverviewWidget::check_changed(bool val){
     DT->user_settings()->setValue(m_option_name,val);
+    DT->publish_settings();
     if(val != m_option_state){
         lbl_read->show();
     }else{
@@ -208,7 +301,7 @@ void EquipWarnItemDelegate::paint(QPainter *painter, const QStyleOptionViewItem
     {
         painter->save();
 
-        QVariantMap counts = index.data(Qt::UserRole+1).toMap();
+        QVariantMap counts = index.data(EquipWarnModel::WearCountsRole).toMap();
         QColor default_pen = painter->pen().color();
         QString curr_text = "";
 
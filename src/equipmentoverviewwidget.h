@@ -23,26 +23,60 @@ THE SOFTWARE.
 #ifndef EQUIPMENTOVERVIEWWIDGET_H
 #define EQUIPMENTOVERVIEWWIDGET_H
 
-#include "basetreewidget.h"
+#include "statstreemodel.h"
+#include "equipwarn.h"
 
 #include <QStyledItemDelegate>
+#include <QWidget>
 
 class QLabel;
 class QPainter;
+class DFInstance;
+class SearchFilterTreeView;
 
-class EquipmentOverviewWidget : public BaseTreeWidget {
+class EquipWarnModel: public StatsTreeModel {
+    Q_OBJECT
+public:
+    EquipWarnModel(QObject *parent = nullptr);
+
+    void refresh(DFInstance *df);
+
+    static constexpr auto WearCountsRole = Qt::UserRole+1; //!< item count per wear level of an item type
+    static constexpr auto SortRole = Qt::UserRole+2;
+    static constexpr auto UnitIdsRole = Qt::UserRole+3;
+
+protected:
+    QVariant group_data(const QString &group, int column, int role) const override;
+    QVariant child_data(const QString &group, const QString &child, int column, int role) const override;
+
+private:
+    struct item_type_row {
+        int total_count;
+        QHash<Item::ITEM_STATE,int> wear_counts;
+        QHash<QString, QPair<QPair<QString,Item::ITEM_STATE>, EquipWarn::warn_count> > details;
+    };
+    QHash<QString, item_type_row> m_item_types;
+    QHash<int,QString> m_wear_level_desc;
+};
+
+class EquipmentOverviewWidget : public QWidget {
     Q_OBJECT
 public:
     EquipmentOverviewWidget(QWidget *parent = nullptr);
 
 protected:
     QLabel *lbl_read;
-    void search_tree(QString val);
-    void build_tree();
+    void closeEvent(QCloseEvent *event);
 
 public slots:
+    void refresh();
+    void clear();
     void check_changed(bool);
     void selection_changed();
+    void clear_filter();
+
+protected slots:
+    void span_item_types();
 
 signals:
     void item_selected(QVariantList);
@@ -50,8 +84,8 @@ signals:
 private:
     bool m_option_state;
     static QString m_option_name;
-    QHash<int,QString> m_wear_level_desc;
-
+    EquipWarnModel *m_model;
+    SearchFilterTreeView *m_tree;
 };
 
 class EquipWarnItemDelegate : public QStyledItemDelegate {
@@ -8,20 +8,10 @@ EquipWarn::EquipWarn(QObject *parent)
 }
 
 void EquipWarn::add_detail(Dwarf *d, warn_info wi){
-    if(m_details.contains(wi.key)){
-        m_details[wi.key].count += wi.count;
-        m_details[wi.key].unit_ids.insert(d->nice_name(),d->id());
-    }else{
-        warn_count wc;
-        wc.count = wi.count;
-        wc.unit_ids.insert(d->nice_name(),d->id());
-        m_details.insert(wi.key,wc);
-    }
+    warn_count &wc = m_details[wi.key];
+    wc.count += wi.count;
+    wc.unit_ids.insert(d->id());
 
-    if(!m_wear_counts.contains(wi.key.second)){
-        m_wear_counts[wi.key.second] = wi.count;
-    }else{
-        m_wear_counts[wi.key.second] += wi.count;
-    }
+    m_wear_counts[wi.key.second] += wi.count;
     m_total_count += wi.count;
 }
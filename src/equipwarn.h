@@ -25,8 +25,10 @@ THE SOFTWARE.
 
 #include "global_enums.h"
 #include <QPair>
+#include <QSet>
 #include <QVariant>
 #include "item.h"
+#include "generationarena.h"
 
 class Dwarf;
 
@@ -35,6 +37,7 @@ class EquipWarn : public QObject
     Q_OBJECT
 
 public:
+    GENERATION_ALLOCATED
     EquipWarn(QObject *parent = 0);
 
     struct warn_info{
@@ -44,8 +47,9 @@ public:
     };
 
     struct warn_count{
+        warn_count() : count(0) {}
         int count;
-        QMap<QString,QVariant> unit_ids;
+        QSet<int> unit_ids; //!< names are only resolved when displayed
     };
 
     int get_total_count() {return m_total_count;}
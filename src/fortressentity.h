@@ -30,6 +30,7 @@ class MemoryLayout;
 
 class FortressEntity : public QObject {
     Q_OBJECT
+    friend class DFInstanceSynthetic;
 public:
     FortressEntity(DFInstance *df, VIRTADDR address, QObject *parent = 0);
     virtual ~FortressEntity();
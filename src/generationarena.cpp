@@ -0,0 +1,130 @@
+/*
+Dwarf Therapist
+Copyright (c) 2009 Trey Stout (chmod)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+#include "generationarena.h"
+#include "truncatingfilelogger.h"
+
+#include <QMutex>
+#include <new>
+
+namespace {
+    //every allocation is preceded by a pointer to its block, padded to keep the object aligned
+    constexpr std::size_t header_size = alignof(std::max_align_t) > sizeof(void*) ? alignof(std::max_align_t) : sizeof(void*);
+    constexpr std::size_t block_size = 64 * 1024;
+    //anything larger than this goes straight to the heap
+    constexpr std::size_t max_object_size = block_size / 8;
+
+    struct arena_block {
+        char *begin;
+        char *cursor;
+        char *end;
+        int live;
+    };
+
+    QBasicMutex arena_mutex;
+    arena_block *current_block = nullptr;
+    int total_blocks = 0;
+
+    std::size_t align_up(std::size_t size){
+        return (size + header_size - 1) & ~(header_size - 1);
+    }
+
+    arena_block *new_block(){
+        char *mem = static_cast<char*>(::operator new(block_size));
+        arena_block *b = reinterpret_cast<arena_block*>(mem);
+        b->begin = mem + align_up(sizeof(arena_block));
+        b->cursor = b->begin;
+        b->end = mem + block_size;
+        b->live = 0;
+        total_blocks++;
+        return b;
+    }
+
+    void free_block(arena_block *b){
+        ::operator delete(b);
+        total_blocks--;
+    }
+
+    arena_block *&block_of(char *mem){
+        return *reinterpret_cast<arena_block**>(mem);
+    }
+}
+
+void *GenerationArena::allocate(std::size_t size){
+    std::size_t needed = header_size + align_up(size);
+    if(size > max_object_size){
+        char *mem = static_cast<char*>(::operator new(needed));
+        block_of(mem) = nullptr;
+        return mem + header_size;
+    }
+
+    QMutexLocker locker(&arena_mutex);
+    if(!current_block || static_cast<std::size_t>(current_block->end - current_block->cursor) < needed){
+        //a full block stays around until its last object is deleted
+        if(current_block && current_block->live == 0)
+            free_block(current_block);
+        current_block = new_block();
+    }
+    char *mem = current_block->cursor;
+    current_block->cursor += needed;
+    current_block->live++;
+    block_of(mem) = current_block;
+    return mem + header_size;
+}
+
+void GenerationArena::release(void *ptr){
+    if(!ptr)
+        return;
+    char *mem = static_cast<char*>(ptr) - header_size;
+    arena_block *b = block_of(mem);
+    if(!b){
+        ::operator delete(mem);
+        return;
+    }
+
+    QMutexLocker locker(&arena_mutex);
+    if(--b->live > 0)
+        return;
+    if(b == current_block){
+        //nothing left in the block being filled, start over from the top
+        b->cursor = b->begin;
+    }else{
+        free_block(b);
+    }
+}
+
+void GenerationArena::begin_generation(){
+    int blocks = 0;
+    {
+        QMutexLocker locker(&arena_mutex);
+        if(current_block && current_block->live == 0)
+            free_block(current_block);
+        current_block = nullptr;
+        blocks = total_blocks;
+    }
+    LOGD << "starting a new allocation generation," << blocks << "blocks still in use";
+}
+
+int GenerationArena::block_count(){
+    QMutexLocker locker(&arena_mutex);
+    return total_blocks;
+}
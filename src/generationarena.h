@@ -0,0 +1,61 @@
+/*
+Dwarf Therapist
+Copyright (c) 2009 Trey Stout (chmod)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+#ifndef GENERATION_ARENA_H
+#define GENERATION_ARENA_H
+
+#include <cstddef>
+
+/**
+ * Bump allocator for the small objects rebuilt on every refresh (items,
+ * uniforms, emotions, needs, preferences and the population summaries).
+ *
+ * Objects are carved out of large blocks belonging to the current
+ * generation. Deleting an object only decrements its block's live count;
+ * once a block is no longer being filled and its last object is gone, the
+ * whole block is released at once. A new generation is started at the
+ * beginning of each refresh, right after the previous units were deleted,
+ * so the old blocks drain and are returned together.
+ *
+ * Classes opt in with GENERATION_ALLOCATED, which keeps plain new/delete
+ * (and therefore QObject parents and unique_ptr) working unchanged.
+ */
+class GenerationArena
+{
+public:
+    static void *allocate(std::size_t size);
+    static void release(void *ptr);
+
+    //! stop filling the current block, later allocations go to fresh blocks
+    static void begin_generation();
+
+    //! number of blocks that still hold live objects
+    static int block_count();
+};
+
+#define GENERATION_ALLOCATED \
+    static void *operator new(std::size_t size) {return GenerationArena::allocate(size);} \
+    static void operator delete(void *ptr) {GenerationArena::release(ptr);} \
+    static void *operator new(std::size_t, void *ptr) noexcept {return ptr;} \
+    static void operator delete(void *, void *) noexcept {}
+
+#endif // GENERATION_ARENA_H
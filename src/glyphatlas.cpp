@@ -0,0 +1,94 @@
+/*
+Dwarf Therapist
+Copyright (c) 2009 Trey Stout (chmod)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+#include "glyphatlas.h"
+#include "truncatingfilelogger.h"
+
+#include <QPainter>
+
+GlyphAtlas::GlyphAtlas(int slots_per_side)
+    : m_slots_per_side(slots_per_side)
+    , m_dpr(1.0)
+    , m_painter(0)
+{
+}
+
+GlyphAtlas::~GlyphAtlas(){
+    delete m_painter;
+}
+
+void GlyphAtlas::clear(){
+    m_slots.clear();
+    m_glyph_size = QSize();
+    m_atlas = QPixmap();
+}
+
+bool GlyphAtlas::prepare(const QSize &glyph_size, qreal dpr){
+    if(glyph_size.isEmpty())
+        return false;
+    if(m_glyph_size.isEmpty() || dpr != m_dpr){
+        clear();
+        m_glyph_size = glyph_size;
+        m_dpr = dpr;
+    }
+    return glyph_size == m_glyph_size;
+}
+
+QRect GlyphAtlas::slot_rect(int slot) const {
+    //in device pixels
+    QSize sz = m_glyph_size * m_dpr;
+    return QRect((slot % m_slots_per_side) * sz.width(), (slot / m_slots_per_side) * sz.height(),
+                 sz.width(), sz.height());
+}
+
+QPainter *GlyphAtlas::begin_glyph(const key &k, int &slot){
+    if(m_atlas.isNull()){
+        m_atlas = QPixmap(m_glyph_size * m_dpr * m_slots_per_side);
+        m_atlas.fill(Qt::transparent);
+    }
+    if(m_slots.size() >= m_slots_per_side * m_slots_per_side){
+        LOGD << "glyph atlas full, starting over";
+        m_slots.clear();
+    }
+    slot = m_slots.size();
+    m_slots.insert(k, slot);
+
+    QRect r = slot_rect(slot);
+    m_painter = new QPainter(&m_atlas);
+    m_painter->setCompositionMode(QPainter::CompositionMode_Source);
+    m_painter->fillRect(r, Qt::transparent);
+    m_painter->setCompositionMode(QPainter::CompositionMode_SourceOver);
+    m_painter->setClipRect(r);
+    m_painter->translate(r.topLeft());
+    m_painter->scale(m_dpr, m_dpr);
+    return m_painter;
+}
+
+void GlyphAtlas::end_glyph(){
+    m_painter->end();
+    delete m_painter;
+    m_painter = 0;
+}
+
+void GlyphAtlas::blit(QPainter *p, const QPoint &target, int slot) const {
+    p->drawPixmap(QRectF(target, m_glyph_size), m_atlas, QRectF(slot_rect(slot)));
+}
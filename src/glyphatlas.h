@@ -0,0 +1,116 @@
+/*
+Dwarf Therapist
+Copyright (c) 2009 Trey Stout (chmod)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+#ifndef GLYPH_ATLAS_H
+#define GLYPH_ATLAS_H
+
+#include <QHash>
+#include <QPixmap>
+#include <QRgb>
+#include <QString>
+
+class QPainter;
+
+/**
+ * Cache of small same sized images (grid cell backgrounds and rating glyphs)
+ * packed into a single pixmap.
+ *
+ * A glyph is rendered once the first time its key is seen and blitted from
+ * the atlas afterwards. All glyphs have the same size, the size of the first
+ * one requested after the atlas is cleared. When it is full it's cleared and
+ * refilled with the glyphs still in use.
+ */
+class GlyphAtlas
+{
+public:
+    struct key {
+        int kind;
+        int a;
+        int b;
+        QRgb color_a;
+        QRgb color_b;
+        QString text;
+
+        key(int kind = 0, int a = 0, int b = 0, QRgb color_a = 0, QRgb color_b = 0, const QString &text = QString())
+            : kind(kind), a(a), b(b), color_a(color_a), color_b(color_b), text(text)
+        {}
+
+        bool operator==(const key &other) const {
+            return kind == other.kind && a == other.a && b == other.b
+                    && color_a == other.color_a && color_b == other.color_b && text == other.text;
+        }
+    };
+
+    GlyphAtlas(int slots_per_side = 48);
+    ~GlyphAtlas();
+
+    //! drop every glyph, they'll be rendered again when needed
+    void clear();
+
+    //! true if glyphs of this size can be cached, the atlas starts over when the pixel ratio changes
+    bool prepare(const QSize &glyph_size, qreal dpr);
+
+    /*!
+      Draw the glyph for k at target. If it isn't cached yet, render is called
+      with a painter and the rect to paint the glyph into first.
+      */
+    template<typename F>
+    void draw(QPainter *p, const QPoint &target, const key &k, F render) {
+        QHash<key,int>::const_iterator it = m_slots.constFind(k);
+        int slot;
+        if(it == m_slots.constEnd()){
+            QPainter *gp = begin_glyph(k, slot);
+            render(gp, QRect(QPoint(0, 0), m_glyph_size));
+            end_glyph();
+        }else{
+            slot = it.value();
+        }
+        blit(p, target, slot);
+    }
+
+    int count() const {return m_slots.size();}
+
+private:
+    int m_slots_per_side;
+    QSize m_glyph_size;
+    qreal m_dpr;
+    QPixmap m_atlas;
+    QHash<key,int> m_slots;
+    QPainter *m_painter;
+
+    QPainter *begin_glyph(const key &k, int &slot);
+    void end_glyph();
+    void blit(QPainter *p, const QPoint &target, int slot) const;
+    QRect slot_rect(int slot) const;
+};
+
+inline uint qHash(const GlyphAtlas::key &k, uint seed = 0) {
+    uint h = qHash(k.text, seed);
+    h ^= qHash(k.kind) + 0x9e3779b9 + (h << 6) + (h >> 2);
+    h ^= qHash(k.a) + 0x9e3779b9 + (h << 6) + (h >> 2);
+    h ^= qHash(k.b) + 0x9e3779b9 + (h << 6) + (h >> 2);
+    h ^= qHash(k.color_a) + 0x9e3779b9 + (h << 6) + (h >> 2);
+    h ^= qHash(k.color_b) + 0x9e3779b9 + (h << 6) + (h >> 2);
+    return h;
+}
+
+#endif // GLYPH_ATLAS_H
@@ -0,0 +1,322 @@
+/*
+Dwarf Therapist
+Copyright (c) 2009 Trey Stout (chmod)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+#include "gridexporter.h"
+#include "gridview.h"
+#include "viewcolumnset.h"
+#include "viewcolumn.h"
+#include "dwarf.h"
+#include "profiler.h"
+#include "truncatingfilelogger.h"
+
+#include <QFile>
+#include <QHash>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonValue>
+#include <QRegExp>
+#include <QThread>
+#include <QtConcurrent>
+#include <memory>
+
+#ifdef HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+namespace {
+
+//! units formatted per task
+const int CHUNK_ROWS = 256;
+
+//! streams everything written through it to the device, gzipped when enabled
+class chunk_writer {
+public:
+    chunk_writer(QIODevice *dev)
+        : m_dev(dev)
+        , m_gzip(false)
+        , m_ok(true)
+    {}
+
+    ~chunk_writer(){
+#ifdef HAVE_ZLIB
+        if(m_gzip)
+            deflateEnd(&m_zs);
+#endif
+    }
+
+    bool start_gzip(){
+#ifdef HAVE_ZLIB
+        m_zs = z_stream();
+        //15 window bits + 16 for a gzip header instead of a zlib one
+        if(deflateInit2(&m_zs, Z_DEFAULT_COMPRESSION, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+            return false;
+        m_gzip = true;
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    bool write(const QByteArray &data){
+        if(!m_gzip)
+            return write_raw(data.constData(), data.size());
+        return deflate_chunk(data, false);
+    }
+
+    bool finish(){
+        if(m_gzip)
+            return deflate_chunk(QByteArray(), true);
+        return m_ok;
+    }
+
+private:
+    QIODevice *m_dev;
+    bool m_gzip;
+    bool m_ok;
+#ifdef HAVE_ZLIB
+    z_stream m_zs;
+#endif
+
+    bool write_raw(const char *data, qint64 size){
+        if(m_ok && size > 0 && m_dev->write(data, size) != size){
+            LOGE << "export write failed:" << m_dev->errorString();
+            m_ok = false;
+        }
+        return m_ok;
+    }
+
+    bool deflate_chunk(const QByteArray &data, bool last){
+#ifdef HAVE_ZLIB
+        char out[16384];
+        m_zs.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data.constData()));
+        m_zs.avail_in = data.size();
+        int ret;
+        do{
+            m_zs.next_out = reinterpret_cast<Bytef*>(out);
+            m_zs.avail_out = sizeof(out);
+            ret = deflate(&m_zs, last ? Z_FINISH : Z_NO_FLUSH);
+            if(ret == Z_STREAM_ERROR){
+                LOGE << "gzip compression failed";
+                return m_ok = false;
+            }
+            if(!write_raw(out, sizeof(out) - m_zs.avail_out))
+                return false;
+        }while(m_zs.avail_out == 0);
+        return m_ok;
+#else
+        Q_UNUSED(data);
+        Q_UNUSED(last);
+        return false;
+#endif
+    }
+};
+
+QByteArray csv_field(const QString &val){
+    QString s = val;
+    if(s.contains(QRegExp("[,\"\\r\\n]")))
+        s = "\"" + s.replace("\"", "\"\"") + "\"";
+    return s.toUtf8();
+}
+
+//! cells holding numbers are exported as numbers, everything else as text (even if it looks numeric)
+QJsonValue json_value(const QVariant &v){
+    switch(static_cast<QMetaType::Type>(v.type())){
+    case QMetaType::Bool:
+        return v.toBool();
+    case QMetaType::Int:
+    case QMetaType::UInt:
+    case QMetaType::Short:
+    case QMetaType::UShort:
+    case QMetaType::Char:
+    case QMetaType::UChar:
+    case QMetaType::Long:
+    case QMetaType::ULong:
+    case QMetaType::LongLong:
+    case QMetaType::ULongLong:
+    case QMetaType::Float:
+    case QMetaType::Double:
+        return v.toDouble();
+    default:
+        break;
+    }
+    if(!v.isValid())
+        return QJsonValue();
+    return v.toString();
+}
+
+}
+
+GridExporter::GridExporter(GridView *gv, const QList<Dwarf*> &dwarves)
+{
+    QVector<ViewColumn*> cols;
+    foreach(ViewColumnSet *set, gv->sets()){
+        int set_idx = m_set_names.size();
+        m_set_names.append(set->name());
+        QHash<QString,int> title_counts;
+        foreach(ViewColumn *col, set->columns()){
+            if(col->type() == CT_SPACER)
+                continue;
+            column_t c;
+            c.set = set_idx;
+            c.title = col->title();
+            //a set can repeat a title, number the repeats so they don't overwrite each other in json
+            int count = ++title_counts[c.title];
+            c.key = count > 1 ? QString("%1 (%2)").arg(c.title).arg(count) : c.title;
+            m_columns.append(c);
+            cols.append(col);
+        }
+    }
+
+    m_rows.reserve(dwarves.size());
+    foreach(Dwarf *d, dwarves){
+        // The model list all creatures without regard to the gridview animal flags, add a filter here
+        if(gv->show_animals() != d->is_animal())
+            continue;
+        row_t r;
+        r.id = d->id();
+        r.name = d->nice_name();
+        r.values.reserve(cols.size());
+        foreach(ViewColumn *col, cols){
+            r.values.append(col->get_export_value(d));
+        }
+        m_rows.append(r);
+    }
+}
+
+bool GridExporter::gzip_supported(){
+#ifdef HAVE_ZLIB
+    return true;
+#else
+    return false;
+#endif
+}
+
+bool GridExporter::format_from_name(const QString &name, FORMAT &fmt){
+    QString n = name.toLower();
+    if(n == "csv"){
+        fmt = FMT_CSV;
+    }else if(n == "jsonl"){
+        fmt = FMT_JSONL;
+    }else{
+        return false;
+    }
+    return true;
+}
+
+QByteArray GridExporter::header(FORMAT fmt) const {
+    if(fmt != FMT_CSV)
+        return QByteArray();
+    QByteArray line = csv_field(QObject::tr("Name"));
+    foreach(const column_t &c, m_columns){
+        line.append(',');
+        line.append(csv_field(c.title));
+    }
+    line.append('\n');
+    return line;
+}
+
+QByteArray GridExporter::format_rows(FORMAT fmt, int start, int end) const {
+    QByteArray out;
+    for(int i = start; i < end; i++){
+        const row_t &r = m_rows.at(i);
+        if(fmt == FMT_CSV){
+            out.append(csv_field(r.name));
+            foreach(const QVariant &v, r.values){
+                out.append(',');
+                out.append(csv_field(v.toString()));
+            }
+        }else{
+            QJsonObject values;
+            QJsonObject set_values;
+            int set = -1;
+            for(int col = 0; col < m_columns.size(); col++){
+                const column_t &c = m_columns.at(col);
+                if(c.set != set){
+                    if(set >= 0)
+                        values.insert(m_set_names.at(set), set_values);
+                    set_values = QJsonObject();
+                    set = c.set;
+                }
+                set_values.insert(c.key, json_value(r.values.at(col)));
+            }
+            if(set >= 0)
+                values.insert(m_set_names.at(set), set_values);
+
+            QJsonObject unit;
+            unit.insert("id", r.id);
+            unit.insert("name", r.name);
+            unit.insert("values", values);
+            out.append(QJsonDocument(unit).toJson(QJsonDocument::Compact));
+        }
+        out.append('\n');
+    }
+    return out;
+}
+
+bool GridExporter::write(const QString &path, FORMAT fmt, bool gzip) const {
+    QFile f(path);
+    if(!f.open(QIODevice::WriteOnly | QIODevice::Truncate)){
+        LOGE << "unable to write" << path << f.errorString();
+        return false;
+    }
+    bool ok = write(&f, fmt, gzip);
+    f.close();
+    return ok;
+}
+
+bool GridExporter::write(QIODevice *dev, FORMAT fmt, bool gzip) const {
+    PROFILE_SCOPE("grid_export");
+    chunk_writer out(dev);
+    if(gzip && !out.start_gzip()){
+        LOGE << "gzip output is not available in this build";
+        return false;
+    }
+
+    if(!out.write(header(fmt)))
+        return false;
+
+    //format a few chunks per thread at a time and write them in order before the next batch
+    QVector<int> chunks;
+    for(int start = 0; start < m_rows.size(); start += CHUNK_ROWS){
+        chunks.append(start);
+    }
+    int batch_size = qMax(1, QThread::idealThreadCount()) * 2;
+    QVector<QByteArray> formatted(batch_size);
+    QByteArray *results = formatted.data();
+    for(int b = 0; b < chunks.size(); b += batch_size){
+        QVector<int> batch;
+        for(int i = 0; i < batch_size && b + i < chunks.size(); i++){
+            batch.append(i);
+        }
+        auto format_chunk = [this, fmt, b, &chunks, results](int &i) {
+            int start = chunks.at(b + i);
+            results[i] = format_rows(fmt, start, qMin(start + CHUNK_ROWS, m_rows.size()));
+        };
+        QtConcurrent::blockingMap(batch, format_chunk);
+        foreach(int i, batch){
+            if(!out.write(results[i]))
+                return false;
+            results[i].clear();
+        }
+    }
+    return out.finish();
+}
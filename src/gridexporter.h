@@ -0,0 +1,88 @@
+/*
+Dwarf Therapist
+Copyright (c) 2009 Trey Stout (chmod)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+#ifndef GRID_EXPORTER_H
+#define GRID_EXPORTER_H
+
+#include <QList>
+#include <QStringList>
+#include <QVariant>
+#include <QVector>
+
+class Dwarf;
+class GridView;
+class QIODevice;
+
+/**
+ * Writes the cells of a grid view for a list of units as csv or json lines.
+ *
+ * The cell values are copied when the exporter is created, which has to happen
+ * on the gui thread since the columns read the model's cells. write() only
+ * formats that copy, in chunks on the global thread pool, and writes them in
+ * order a few chunks at a time so the formatted text doesn't grow with the
+ * population.
+ *
+ * Json lines hold one object per unit and keep cells holding numbers as
+ * numbers. Output can be gzipped when the build has zlib.
+ */
+class GridExporter
+{
+public:
+    typedef enum{
+        FMT_CSV,
+        FMT_JSONL
+    } FORMAT;
+
+    GridExporter(GridView *gv, const QList<Dwarf*> &dwarves);
+
+    //! write to path, gzipped if requested (a .gz suffix isn't added)
+    bool write(const QString &path, FORMAT fmt, bool gzip = false) const;
+    //! write to an already opened device
+    bool write(QIODevice *dev, FORMAT fmt, bool gzip = false) const;
+
+    int row_count() const {return m_rows.size();}
+
+    static bool gzip_supported();
+    //! csv or jsonl, returns false for anything else
+    static bool format_from_name(const QString &name, FORMAT &fmt);
+
+private:
+    struct column_t {
+        int set; //!< index into m_set_names
+        QString title;
+        QString key; //!< title made unique within its set
+    };
+    struct row_t {
+        int id;
+        QString name;
+        QVector<QVariant> values; //!< export value of each column
+    };
+
+    QStringList m_set_names;
+    QVector<column_t> m_columns;
+    QVector<row_t> m_rows;
+
+    QByteArray header(FORMAT fmt) const;
+    QByteArray format_rows(FORMAT fmt, int start, int end) const;
+};
+
+#endif // GRID_EXPORTER_H
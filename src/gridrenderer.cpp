@@ -0,0 +1,353 @@
+/*
+Dwarf Therapist
+Copyright (c) 2009 Trey Stout (chmod)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+#include "gridrenderer.h"
+#include "statetableview.h"
+#include "rotatedheader.h"
+#include "uberdelegate.h"
+#include "dwarfmodelproxy.h"
+#include "profiler.h"
+#include "truncatingfilelogger.h"
+
+#include <QFile>
+#include <QFileInfo>
+#include <QFuture>
+#include <QPainter>
+#include <QThreadPool>
+#include <QtConcurrent>
+#include <algorithm>
+#include <cstring>
+
+#ifdef HAVE_ZLIB
+#include <zlib.h>
+
+namespace {
+
+//! writes a png one block of rows at a time, the image data is deflated straight into IDAT chunks
+class png_writer {
+public:
+    png_writer(QIODevice *dev)
+        : m_dev(dev)
+        , m_width(0)
+        , m_started(false)
+        , m_ok(true)
+        , m_out(65536, 0)
+    {}
+
+    ~png_writer(){
+        if(m_started)
+            deflateEnd(&m_zs);
+    }
+
+    bool start(const QSize &size){
+        m_zs = z_stream();
+        if(deflateInit(&m_zs, Z_DEFAULT_COMPRESSION) != Z_OK)
+            return false;
+        m_started = true;
+        m_width = size.width();
+
+        write_raw(QByteArray("\x89PNG\r\n\x1a\n", 8));
+        QByteArray ihdr;
+        append_u32(ihdr, size.width());
+        append_u32(ihdr, size.height());
+        ihdr.append(char(8)); //bits per channel
+        ihdr.append(char(2)); //rgb
+        ihdr.append(3, char(0)); //deflate, standard filters, not interlaced
+        write_chunk("IHDR", ihdr);
+        return m_ok;
+    }
+
+    //! append the rows of img, which must be as wide as the image
+    bool write_rows(const QImage &img){
+        QImage rgb = img.convertToFormat(QImage::Format_RGB888);
+        //each scanline starts with its filter type, 0 is none
+        QByteArray line(1 + m_width * 3, 0);
+        for(int y = 0; y < rgb.height() && m_ok; y++){
+            memcpy(line.data() + 1, rgb.constScanLine(y), m_width * 3);
+            deflate_chunk(line, false);
+        }
+        return m_ok;
+    }
+
+    bool finish(){
+        deflate_chunk(QByteArray(), true);
+        write_chunk("IEND", QByteArray());
+        return m_ok;
+    }
+
+private:
+    QIODevice *m_dev;
+    int m_width;
+    bool m_started;
+    bool m_ok;
+    z_stream m_zs;
+    QByteArray m_out;
+
+    static void append_u32(QByteArray &buf, quint32 val){
+        buf.append(char((val >> 24) & 0xff));
+        buf.append(char((val >> 16) & 0xff));
+        buf.append(char((val >> 8) & 0xff));
+        buf.append(char(val & 0xff));
+    }
+
+    void write_raw(const QByteArray &data){
+        if(m_ok && m_dev->write(data) != data.size()){
+            LOGE << "snapshot write failed:" << m_dev->errorString();
+            m_ok = false;
+        }
+    }
+
+    void write_chunk(const char *type, const QByteArray &data){
+        QByteArray chunk;
+        append_u32(chunk, data.size());
+        chunk.append(type, 4);
+        chunk.append(data);
+        uLong crc = crc32(0L, Z_NULL, 0);
+        crc = crc32(crc, reinterpret_cast<const Bytef*>(chunk.constData() + 4), chunk.size() - 4);
+        append_u32(chunk, crc);
+        write_raw(chunk);
+    }
+
+    void deflate_chunk(const QByteArray &data, bool last){
+        m_zs.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data.constData()));
+        m_zs.avail_in = data.size();
+        do{
+            m_zs.next_out = reinterpret_cast<Bytef*>(m_out.data());
+            m_zs.avail_out = m_out.size();
+            if(deflate(&m_zs, last ? Z_FINISH : Z_NO_FLUSH) == Z_STREAM_ERROR){
+                LOGE << "snapshot compression failed";
+                m_ok = false;
+                return;
+            }
+            int produced = m_out.size() - m_zs.avail_out;
+            if(produced > 0)
+                write_chunk("IDAT", m_out.left(produced));
+        }while(m_zs.avail_out == 0 && m_ok);
+    }
+};
+
+}
+#endif
+
+GridRenderer::GridRenderer(StateTableView *view)
+    : m_view(view)
+    , m_row_height(0)
+    , m_header_height(0)
+{
+    UberDelegate *d = m_view->get_delegate();
+    //cell size + 2 for the border lines + (2 * cell padding), same as the view
+    m_row_height = qMax(1, d->cell_size + 2 + 2 * d->cell_padding);
+
+    RotatedHeader *h = m_view->get_header();
+    m_header_height = qMax(h->height(), h->sizeHint().height());
+
+    m_col_x.reserve(h->count() + 1);
+    int x = 0;
+    for(int c = 0; c < h->count(); c++){
+        m_col_x.append(x);
+        if(!h->isSectionHidden(c))
+            x += h->sectionSize(c);
+    }
+    m_col_x.append(x);
+
+    collect_rows(QModelIndex(), 0);
+}
+
+void GridRenderer::collect_rows(const QModelIndex &parent, int depth){
+    QAbstractItemModel *m = m_view->get_proxy();
+    for(int r = 0; r < m->rowCount(parent); r++){
+        if(m_view->isRowHidden(r, parent))
+            continue;
+        QModelIndex idx = m->index(r, 0, parent);
+        m_rows.append(idx);
+        m_depth.append(depth);
+        if(m->hasChildren(idx) && m_view->isExpanded(idx))
+            collect_rows(idx, depth + 1);
+    }
+}
+
+QPair<int,int> GridRenderer::column_range(int x0, int x1) const {
+    int cols = m_col_x.size() - 1;
+    //the last column starting at or before x0, and the first one starting at or after x1
+    int first = std::upper_bound(m_col_x.constBegin(), m_col_x.constEnd() - 1, x0) - m_col_x.constBegin() - 1;
+    int last = std::lower_bound(m_col_x.constBegin(), m_col_x.constEnd() - 1, x1) - m_col_x.constBegin() - 1;
+    return qMakePair(qMax(0, first), qMin(cols - 1, last));
+}
+
+QImage GridRenderer::render(const QRect &rect) const {
+    QImage img(rect.size(), QImage::Format_ARGB32_Premultiplied);
+    img.fill(m_view->palette().color(QPalette::Base));
+
+    QPainter p(&img);
+    p.setRenderHints(QPainter::SmoothPixmapTransform);
+    p.translate(-rect.topLeft());
+    p.setClipRect(rect);
+    if(rect.top() < m_header_height)
+        paint_header(&p, rect);
+    paint_rows(&p, rect);
+    p.end();
+    return img;
+}
+
+void GridRenderer::paint_header(QPainter *p, const QRect &rect) const {
+    RotatedHeader *h = m_view->get_header();
+    QPair<int,int> cols = column_range(rect.left(), rect.right() + 1);
+    p->save();
+    p->setClipRect(rect.intersected(QRect(0, 0, m_col_x.last(), m_header_height)));
+    for(int c = cols.first; c <= cols.second; c++){
+        int w = m_col_x.at(c + 1) - m_col_x.at(c);
+        if(w <= 0)
+            continue;
+        h->paintSection(p, QRect(m_col_x.at(c), 0, w, m_header_height), c);
+    }
+    p->restore();
+}
+
+void GridRenderer::paint_rows(QPainter *p, const QRect &rect) const {
+    if(m_rows.isEmpty() || rect.bottom() < m_header_height)
+        return;
+
+    int first = qMax(0, (rect.top() - m_header_height) / m_row_height);
+    int last = qMin(m_rows.size() - 1, (rect.bottom() - m_header_height) / m_row_height);
+    QPair<int,int> cols = column_range(rect.left(), rect.right() + 1);
+
+    UberDelegate *d = m_view->get_delegate();
+    QStyleOptionViewItem opt;
+    opt.initFrom(m_view);
+    opt.widget = m_view;
+    opt.state = QStyle::State_Enabled | QStyle::State_Active;
+
+    for(int r = first; r <= last; r++){
+        const QModelIndex &row_idx = m_rows.at(r);
+        int y = m_header_height + r * m_row_height;
+        for(int c = cols.first; c <= cols.second; c++){
+            int x = m_col_x.at(c);
+            int w = m_col_x.at(c + 1) - x;
+            if(w <= 0)
+                continue;
+            if(c == 0){
+                //tree indentation of the name column
+                int indent = m_depth.at(r) * m_view->indentation();
+                x += indent;
+                w -= indent;
+            }
+            opt.rect = QRect(x, y, w, m_row_height);
+            d->paint(p, opt, row_idx.sibling(row_idx.row(), c));
+        }
+    }
+}
+
+QStringList GridRenderer::save(const QString &path, int tile_size) const {
+    PROFILE_SCOPE("render_grid");
+    QSize size = canvas_size();
+    if(size.isEmpty() || tile_size <= 0)
+        return QStringList();
+
+#ifdef HAVE_ZLIB
+    QFileInfo fi(path);
+    if(fi.suffix().isEmpty() || fi.suffix().compare("png", Qt::CaseInsensitive) == 0){
+        QString file = fi.suffix().isEmpty() ? path + ".png" : path;
+        if(!save_png(file, tile_size)){
+            LOGE << "failed to write grid snapshot" << file;
+            return QStringList();
+        }
+        LOGI << "wrote grid snapshot" << size << "to" << file;
+        return QStringList() << file;
+    }
+#endif
+    return save_tiles(path, tile_size);
+}
+
+#ifdef HAVE_ZLIB
+bool GridRenderer::save_png(const QString &file, int tile_size) const {
+    QFile f(file);
+    if(!f.open(QIODevice::WriteOnly | QIODevice::Truncate)){
+        LOGE << "unable to write" << file << f.errorString();
+        return false;
+    }
+    QSize size = canvas_size();
+    png_writer out(&f);
+    if(!out.start(size))
+        return false;
+
+    //full width strips holding no more pixels than a tile
+    int strip_height = qBound(1, int(qint64(tile_size) * tile_size / size.width()), tile_size);
+
+    //painting stays on this thread since the delegate and header read the live model and
+    //paint through the view's style. each strip is compressed in the pool while the next
+    //one is painted, so at most two strips are held
+    QFuture<bool> pending;
+    bool has_pending = false;
+    for(int y = 0; y < size.height(); y += strip_height){
+        QImage strip = render(QRect(0, y, size.width(), qMin(strip_height, size.height() - y)));
+        if(has_pending && !pending.result())
+            return false;
+        pending = QtConcurrent::run([&out, strip]() {
+            return out.write_rows(strip);
+        });
+        has_pending = true;
+    }
+    if(has_pending && !pending.result())
+        return false;
+    return out.finish();
+}
+#endif
+
+QStringList GridRenderer::save_tiles(const QString &path, int tile_size) const {
+    QStringList files;
+    QSize size = canvas_size();
+    QFileInfo fi(path);
+    QString ext = fi.suffix().isEmpty() ? "png" : fi.suffix();
+    QString base = fi.absolutePath() + "/" + fi.completeBaseName();
+    bool single = size.width() <= tile_size && size.height() <= tile_size;
+
+    //painting stays on this thread, the encoding happens in the pool. cap the
+    //tiles waiting to be written so memory stays at a few tiles
+    int max_pending = qMax(1, QThreadPool::globalInstance()->maxThreadCount());
+    QList<QFuture<bool> > pending;
+    bool ok = true;
+
+    for(int y = 0; y < size.height(); y += tile_size){
+        for(int x = 0; x < size.width(); x += tile_size){
+            QRect tile = QRect(x, y, tile_size, tile_size).intersected(QRect(QPoint(0, 0), size));
+            QString file = single ? base + "." + ext
+                                  : QString("%1_r%2_c%3.%4").arg(base).arg(y / tile_size).arg(x / tile_size).arg(ext);
+            QImage img = render(tile);
+            if(pending.size() >= max_pending)
+                ok &= pending.takeFirst().result();
+            pending.append(QtConcurrent::run([img, file]() {
+                return img.save(file);
+            }));
+            files.append(file);
+        }
+    }
+    foreach(QFuture<bool> f, pending){
+        ok &= f.result();
+    }
+
+    if(!ok){
+        LOGE << "failed to write grid snapshot" << path;
+        return QStringList();
+    }
+    LOGI << "wrote grid snapshot" << size << "to" << files.size() << "file(s)";
+    return files;
+}
@@ -0,0 +1,89 @@
+/*
+Dwarf Therapist
+Copyright (c) 2009 Trey Stout (chmod)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+#ifndef GRID_RENDERER_H
+#define GRID_RENDERER_H
+
+#include <QImage>
+#include <QModelIndex>
+#include <QStringList>
+#include <QVector>
+
+class StateTableView;
+
+/**
+ * Paints a grid view off-screen, without resizing any window.
+ *
+ * The column header and the cells are drawn straight through the view's
+ * RotatedHeader and UberDelegate into images no larger than a tile, so the
+ * memory used only depends on the tile size. Painting stays on the gui thread
+ * (the delegate reads the live model and paints through the view's style),
+ * the encoding runs on the global thread pool while the next part is painted.
+ *
+ * Pngs are streamed: full width strips are deflated straight into a single
+ * file, so the whole bitmap never exists. Without zlib, or for other image
+ * formats, snapshots larger than one tile are saved as a set of tiles next to
+ * each other: name_r<row>_c<col>.<ext>
+ */
+class GridRenderer
+{
+public:
+    static const int DEFAULT_TILE_SIZE = 2048;
+
+    GridRenderer(StateTableView *view);
+
+    //! size of the whole snapshot, header included
+    QSize canvas_size() const {return QSize(m_col_x.last(), m_header_height + m_rows.size() * m_row_height);}
+
+    //! paint the part of the snapshot covered by rect
+    QImage render(const QRect &rect) const;
+
+    /*!
+      Write the snapshot to path. Pngs are always a single file, other formats
+      are split in tiles with a _r<row>_c<col> suffix when they don't fit in one.
+      Returns the files written, empty on failure.
+      */
+    QStringList save(const QString &path, int tile_size = DEFAULT_TILE_SIZE) const;
+
+private:
+    StateTableView *m_view;
+    //! visible proxy rows in display order (column 0)
+    QVector<QModelIndex> m_rows;
+    //! depth of each row, used to indent the name column
+    QVector<int> m_depth;
+    //! left edge of each column, with the right edge of the last one appended
+    QVector<int> m_col_x;
+    int m_row_height;
+    int m_header_height;
+
+    void collect_rows(const QModelIndex &parent, int depth);
+#ifdef HAVE_ZLIB
+    bool save_png(const QString &file, int tile_size) const;
+#endif
+    QStringList save_tiles(const QString &path, int tile_size) const;
+    void paint_header(QPainter *p, const QRect &rect) const;
+    void paint_rows(QPainter *p, const QRect &rect) const;
+    //! first and last column intersecting [x0, x1)
+    QPair<int,int> column_range(int x0, int x1) const;
+};
+
+#endif // GRID_RENDERER_H
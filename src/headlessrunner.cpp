@@ -0,0 +1,205 @@
+/*
+Dwarf Therapist
+Copyright (c) 2009 Trey Stout (chmod)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+#include "headlessrunner.h"
+#include "dfinstance.h"
+#include "dwarf.h"
+#include "dwarfmodel.h"
+#include "dwarfmodelproxy.h"
+#include "dwarftherapist.h"
+#include "gamedatareader.h"
+#include "gridexporter.h"
+#include "gridview.h"
+#include "laboroptimizer.h"
+#include "laboroptimizerplan.h"
+#include "profiler.h"
+#include "squad.h"
+#include "truncatingfilelogger.h"
+#include "viewmanager.h"
+
+#include <QDir>
+#include <QRegExp>
+#include <QSettings>
+
+HeadlessRunner::HeadlessRunner(const options &opts, QObject *parent)
+    : QObject(parent)
+    , m_opts(opts)
+    , m_df(0)
+    , m_model(new DwarfModel(this))
+    , m_proxy(new DwarfModelProxy(this))
+{
+    m_proxy->setSourceModel(m_model);
+    if(m_opts.format.isEmpty())
+        m_opts.format = "csv";
+    if(m_opts.export_dir.isEmpty())
+        m_opts.export_dir = QDir::currentPath();
+}
+
+HeadlessRunner::~HeadlessRunner(){
+    delete m_proxy;
+    delete m_model;
+    qDeleteAll(m_views);
+    m_views.clear();
+    delete m_df;
+}
+
+void HeadlessRunner::run(){
+    int ret = execute();
+    LOGI << "headless run finished with exit code" << ret;
+    QCoreApplication::exit(ret);
+}
+
+int HeadlessRunner::execute(){
+    PROFILE_SCOPE("headless_run");
+    GridExporter::FORMAT fmt;
+    if(!GridExporter::format_from_name(m_opts.format, fmt)){
+        LOGE << "unknown export format" << m_opts.format;
+        return 1;
+    }
+    if(m_opts.gzip && !GridExporter::gzip_supported()){
+        LOGE << "gzip output is not available in this build";
+        return 1;
+    }
+
+    LOGI << "attempting connection to running DF game";
+    m_df = DFInstance::newInstance();
+    if(!m_df){
+        LOGE << "unable to create a DF instance";
+        return 1;
+    }
+    m_df->find_running_copy();
+    if(m_df->status() != DFInstance::DFS_GAME_LOADED){
+        LOGE << "no running copy of Dwarf Fortress with a loaded game was found";
+        return 1;
+    }
+
+    GameDataReader::ptr()->refresh_facets();
+    m_df->load_game_data();
+    load_views();
+    if(m_views.isEmpty()){
+        LOGE << "no grid views could be loaded";
+        return 1;
+    }
+
+    m_model->set_instance(m_df);
+    m_df->refresh_data();
+    m_model->load_dwarves(); //also calculates all role ratings
+    if(m_model->get_dwarves().isEmpty()){
+        LOGE << "no units were found";
+        return 1;
+    }
+    LOGI << "loaded" << m_model->get_dwarves().count() << "units from" << m_df->fortress_name();
+
+    //the proxy filters work on the built rows
+    m_model->set_grid_view(m_views.first());
+    m_model->build_rows();
+
+    if(!m_opts.plan.isEmpty() && !apply_plan(m_opts.plan))
+        return 1;
+
+    int ret = 0;
+    foreach(QString name, m_opts.views){
+        GridView *gv = get_view(name);
+        if(!gv){
+            LOGE << "grid view" << name << "was not found";
+            ret = 1;
+            continue;
+        }
+        if(!export_view(gv))
+            ret = 1;
+    }
+
+    LOGI << "remote memory access during the run:";
+    m_df->log_access_stats();
+    return ret;
+}
+
+void HeadlessRunner::load_views(){
+    QSettings *u = DT->user_settings();
+    ViewManager::load_default_column_sorts(*u);
+    m_views = ViewManager::read_built_in_views(this);
+    foreach(GridView *gv, ViewManager::read_user_views(*u, this)){
+        if(get_view(gv->name())){
+            //there's nobody to ask for a new name, so the built-in view wins
+            LOGW << "gridview" << gv->name() << "was not loaded because a view with this name already exists";
+            delete gv;
+            continue;
+        }
+        m_views << gv;
+    }
+    LOGI << "Loaded" << m_views.size() << "views";
+}
+
+GridView *HeadlessRunner::get_view(const QString &name){
+    foreach(GridView *gv, m_views){
+        if(gv->name() == name)
+            return gv;
+    }
+    return 0;
+}
+
+bool HeadlessRunner::apply_plan(const QString &name){
+    PROFILE_SCOPE("headless_optimize");
+    if(!m_df->disabled_work_details()){
+        LOGE << "work details must be disabled in the game before labors can be optimized";
+        return false;
+    }
+    laborOptimizerPlan *p = GameDataReader::ptr()->get_opt_plans().value(name);
+    if(!p){
+        LOGE << "optimization plan" << name << "was not found";
+        return false;
+    }
+
+    LaborOptimizer o(p);
+    o.optimize_labors(m_proxy->get_filtered_dwarves());
+
+    int changes = 0;
+    foreach(Dwarf *d, m_model->get_dwarves()) {
+        changes += d->pending_changes();
+    }
+    foreach(Squad *s, m_df->squads()){
+        changes += s->pending_changes();
+    }
+    LOGI << "optimization plan" << name << "produced" << changes << "pending changes";
+
+    if(m_opts.commit && changes > 0){
+        LOGI << "committing pending changes";
+        m_model->commit_pending();
+    }
+    return true;
+}
+
+bool HeadlessRunner::export_view(GridView *gv){
+    PROFILE_SCOPE("headless_export");
+    m_model->set_grid_view(gv);
+    m_model->build_rows();
+
+    QString file_name = QString("%1.%2%3").arg(gv->name()).arg(m_opts.format).arg(m_opts.gzip ? ".gz" : "");
+    file_name.replace(QRegExp("[\\\\/:*?\"<>|]"), "_");
+    QString path = QDir(m_opts.export_dir).filePath(file_name);
+    GridExporter::FORMAT fmt = GridExporter::FMT_CSV;
+    GridExporter::format_from_name(m_opts.format, fmt);
+    if(!GridExporter(gv, m_proxy->get_filtered_dwarves()).write(path, fmt, m_opts.gzip))
+        return false;
+    LOGI << "exported grid view" << gv->name() << "to" << path;
+    return true;
+}
@@ -0,0 +1,74 @@
+/*
+Dwarf Therapist
+Copyright (c) 2009 Trey Stout (chmod)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+#ifndef HEADLESS_RUNNER_H
+#define HEADLESS_RUNNER_H
+
+#include <QObject>
+#include <QStringList>
+
+class DFInstance;
+class DwarfModel;
+class DwarfModelProxy;
+class GridView;
+
+/*!
+ * Drives a complete read/optimize/export cycle without the main window, for
+ * use from scripts (--headless). The application exits with the result of
+ * the run once it completes.
+ */
+class HeadlessRunner : public QObject {
+    Q_OBJECT
+public:
+    struct options {
+        QString plan; //!< name of the optimization plan to apply, if any
+        bool commit; //!< write the pending labor changes to the game
+        QStringList views; //!< grid views to export
+        QString export_dir;
+        QString format; //!< csv or jsonl
+        bool gzip; //!< compress the exported files
+    };
+
+    HeadlessRunner(const options &opts, QObject *parent = 0);
+    virtual ~HeadlessRunner();
+
+    DFInstance *get_DFInstance() {return m_df;}
+    DwarfModel *get_model() {return m_model;}
+
+public slots:
+    void run();
+
+private:
+    options m_opts;
+    DFInstance *m_df;
+    DwarfModel *m_model;
+    DwarfModelProxy *m_proxy;
+    QList<GridView*> m_views;
+
+    int execute();
+    void load_views();
+    GridView *get_view(const QString &name);
+    bool apply_plan(const QString &name);
+    bool export_view(GridView *gv);
+};
+
+#endif // HEADLESS_RUNNER_H
@@ -55,7 +55,7 @@ QStandardItem *HighestMoodColumn::build_cell(Dwarf *d) {
 
     QString pixmap_name(":img/question-frame.png");
 
-    QHash<int,Skill> skills = d->get_moodable_skills();
+    const QVector<int> &skills = d->get_moodable_skills();
     if (skills.count() > 1) {
         m_sort_val = 1000 + skills.count();
         m_skill_id = -1;
@@ -66,7 +66,7 @@ QStandardItem *HighestMoodColumn::build_cell(Dwarf *d) {
         pixmap_name = ":/profession/prof_24.png";
     }
     else {
-        Skill s = skills.values().at(0);
+        const Skill &s = d->get_skill(skills.first());
         m_skill_id = s.id();
         int img_id = gdr->get_mood_skill_prof(s.id()) + 1; //prof images start at 1, id start at 0
         pixmap_name = ":/profession/prof_" + QString::number(img_id) + ".png";
@@ -88,8 +88,8 @@ QStandardItem *HighestMoodColumn::build_cell(Dwarf *d) {
         build_tooltip(d,false,false);
     }else{
         QStringList skill_desc;
-        foreach(Skill s, skills.values()){
-            skill_desc.append(build_skill_desc(d,s.id()).replace("<br/>"," "));
+        foreach(int skill_id, skills){
+            skill_desc.append(build_skill_desc(d,skill_id).replace("<br/>"," "));
         }
 
         QString str_mood = tr("<br/><br/>One of these skills will be chosen at random when a mood occurs.");
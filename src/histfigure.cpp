@@ -50,7 +50,7 @@ HistFigure::HistFigure(int id, DFInstance *df, QObject *parent)
         m_nick_addrs.append(m_mem->word_field(m_mem->hist_figure_field(m_address, "hist_name"), "nickname"));
         m_fig_info_addr = m_df->read_addr(m_mem->hist_figure_field(m_address, "hist_fig_info"));
         m_has_fake_identity = read_fake_identity();
-        if(!DT->user_settings()->value("options/highlight_cursed", false).toBool() && m_has_fake_identity){
+        if(!DT->settings().highlight_cursed && m_has_fake_identity){
             return;
         }
         read_kills();
@@ -483,14 +483,16 @@ void ImportExportDialog::export_selected_professions() {
 
 void ImportExportDialog::import_selected_roles(){
     int imported = 0;
+    QStringList names;
     foreach(Role *r, get_roles()){
+        names.append(r->name());
         r->is_custom(true);
         r->create_role_details();
         GameDataReader::ptr()->get_roles().insert(r->name(), r);
         imported++;
     }
     DT->get_main_window()->write_roles();
-    DT->get_main_window()->refresh_roles_data();
+    DT->get_main_window()->refresh_roles_data(names);
     if(imported)
         QMessageBox::information(this, tr("Import Successful"),
             tr("Imported %n custom role(s)", "", imported));
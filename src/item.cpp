@@ -23,6 +23,7 @@ THE SOFTWARE.
 #include "item.h"
 #include "dfinstance.h"
 #include "itemammo.h"
+#include "itemrepository.h"
 #include "itemsubtype.h"
 #include "material.h"
 #include "memorylayout.h"
@@ -114,53 +115,37 @@ const QList<MATERIAL_FLAGS> Item::init_mat_cats(){
 
 void Item::read_data(){
     if(m_addr){
-        VIRTADDR item_vtable = m_df->read_addr(m_addr);
-
-        m_iType = static_cast<ITEM_TYPE>(m_df->read_int(m_df->read_addr(item_vtable) + m_df->VM_TYPE_OFFSET()));
-
-        m_id = m_df->read_int(m_df->memory_layout()->item_field(m_addr, "id"));
-        m_stack_size = m_df->read_int(m_df->memory_layout()->item_field(m_addr, "stack_size"));
-        m_wear = m_df->read_short(m_df->memory_layout()->item_field(m_addr, "wear"));
-        m_mat_type = m_df->read_short(m_df->memory_layout()->item_field(m_addr, "mat_type"));
-        m_mat_idx = m_df->read_int(m_df->memory_layout()->item_field(m_addr, "mat_index"));
-        m_maker_race = m_df->read_short(m_df->memory_layout()->item_field(m_addr, "maker_race"));
-        m_quality = m_df->read_short(m_df->memory_layout()->item_field(m_addr, "quality"));
-
-        init_defaults();
-
-        QVector<VIRTADDR> gen_refs = m_df->enumerate_vector(m_df->memory_layout()->item_field(m_addr, "general_refs"));
-        foreach(VIRTADDR ref, gen_refs){
-            VIRTADDR gen_ref_vtable = m_df->read_addr(ref);
-            int ref_type = m_df->read_int(m_df->read_addr(m_df->memory_layout()->general_ref_field(gen_ref_vtable, "ref_type")) + m_df->VM_TYPE_OFFSET());
-            if(ref_type == 0 || ref_type == 1){
-                LOGD << "reading type:" << ref_type << "(artifact name)";
-                int artifact_id = m_df->read_int(m_df->memory_layout()->general_ref_field(ref, "artifact_id"));
-                if(artifact_id){
-                    m_artifact_name = m_df->get_artifact_name(ARTIFACTS,artifact_id);
+        //decoded at most once per refresh and shared with every other holder of this item
+        ItemRecord r = m_df->item_repository()->get(m_addr);
+
+        m_iType = r.type;
+        m_id = r.id;
+        m_stack_size = r.stack_size;
+        m_wear = r.wear;
+        m_mat_type = r.mat_type;
+        m_mat_idx = r.mat_idx;
+        m_maker_race = r.maker_race;
+        m_quality = r.quality;
+        m_material_name = r.material_name;
+        m_material_name_base = r.material_name_base;
+        m_material_flags = r.material_flags;
+        m_artifact_name = r.artifact_name;
+        set_default_name(m_df->find_material(m_mat_idx,m_mat_type));
+
+        foreach(VIRTADDR ammo_addr, r.contained_ammo){
+            ItemAmmo *ia = new ItemAmmo(m_df,ammo_addr);
+            bool appended = false;
+            foreach(Item *i, m_contained_items){
+                if(i->equals(*ia)){
+                    i->add_to_stack(ia->get_stack_size());
+                    appended = true;
                     break;
                 }
-            }else if(ref_type == 10 && m_iType == QUIVER){ //type of container item, could be expanded to show food and drink
-                LOGD << "reading type:" << ref_type << "(container)";
-                int item_id = m_df->read_int(m_df->memory_layout()->general_ref_field(ref, "item_id"));
-                VIRTADDR ammo_addr = m_df->get_item_address(AMMO,item_id);
-                if(ammo_addr){
-                    ItemAmmo *ia = new ItemAmmo(m_df,ammo_addr);
-                    bool appended = false;
-                    foreach(Item *i, m_contained_items){
-                        if(i->equals(*ia)){
-                            i->add_to_stack(ia->get_stack_size());
-                            appended = true;
-                            break;
-                        }
-                    }
-                    if(!appended){
-                        m_contained_items.append(ia);
-                    }else{
-                        delete ia;
-                    }
-                }else{
-                    LOGE << "found unknown ammo!";
-                }
+            }
+            if(!appended){
+                m_contained_items.append(ia);
+            }else{
+                delete ia;
             }
         }
     }
@@ -172,13 +157,16 @@ void Item::init_defaults(){
     set_default_name(m);
     if(m){
         m_material_flags = FlagArray(m->flags());
-        foreach(MATERIAL_FLAGS mf, m_mat_cats){
-            if(m->flags().has_flag(mf)){
-                m_material_name_base = Material::get_material_flag_desc(mf);
-                break;
-            }
-        }
+        m_material_name_base = get_material_base_name(m->flags());
+    }
+}
+
+QString Item::get_material_base_name(const FlagArray &flags){
+    foreach(MATERIAL_FLAGS mf, m_mat_cats){
+        if(flags.has_flag(mf))
+            return Material::get_material_flag_desc(mf);
     }
+    return QString();
 }
 
 QString Item::display_name(bool colored){
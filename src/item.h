@@ -29,6 +29,7 @@ THE SOFTWARE.
 
 #include <QObject>
 #include <QColor>
+#include "generationarena.h"
 
 class DFInstance;
 class ItemSubtype;
@@ -37,6 +38,7 @@ class Material;
 class Item : public QObject {
     Q_OBJECT
 public:
+    GENERATION_ALLOCATED
     Item(const Item &i);
     Item(DFInstance *df, VIRTADDR item_addr, QObject *parent = 0);
     Item(ITEM_TYPE itype,QString name, QObject *parent = 0);
@@ -289,6 +291,9 @@ public:
         }
     }
 
+    //! description of the first material category (metal, leather, bone..) found in the flags
+    static QString get_material_base_name(const FlagArray &flags);
+
     static bool is_armor_type(const ITEM_TYPE &i_type, const bool &include_shield = false){
         if(i_type == ARMOR || i_type == GLOVES || i_type == HELM || i_type == PANTS || i_type == SHOES ||
                 (include_shield && i_type == SHIELD)){
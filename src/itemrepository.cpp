@@ -0,0 +1,251 @@
+/*
+Dwarf Therapist
+Copyright (c) 2009 Trey Stout (chmod)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+#include "itemrepository.h"
+#include "dfinstance.h"
+#include "item.h"
+#include "material.h"
+#include "memorylayout.h"
+#include "truncatingfilelogger.h"
+
+#include <cstring>
+
+ItemRecord::ItemRecord()
+    : type(NONE)
+    , id(-1)
+    , stack_size(0)
+    , wear(0)
+    , mat_type(-1)
+    , mat_idx(-1)
+    , maker_race(-1)
+    , quality(-1)
+    , generation(-1)
+{}
+
+namespace {
+    //copy a field out of the item header, leaving the default if the offset is missing
+    template<typename T>
+    void header_value(const QByteArray &header, int offset, T &out){
+        if(offset >= 0 && offset + static_cast<int>(sizeof(T)) <= header.size())
+            std::memcpy(&out, header.constData() + offset, sizeof(T));
+    }
+
+    void append_field(QByteArray &fp, const QByteArray &header, int offset, int size){
+        if(offset >= 0 && offset + size <= header.size())
+            fp.append(header.constData() + offset, size);
+    }
+}
+
+ItemRepository::ItemRepository(DFInstance *df)
+    : m_df(df)
+    , m_generation(0)
+    , m_layout_ready(false)
+    , m_span(0)
+    , m_off_id(-1)
+    , m_off_stack_size(-1)
+    , m_off_wear(-1)
+    , m_off_mat_type(-1)
+    , m_off_mat_idx(-1)
+    , m_off_maker_race(-1)
+    , m_off_quality(-1)
+    , m_off_general_refs(-1)
+    , m_ref_span(0)
+    , m_hits(0)
+    , m_decodes(0)
+{}
+
+void ItemRepository::load_layout(){
+    MemoryLayout *mem = m_df->memory_layout();
+    int ptr_size = static_cast<int>(m_df->pointer_size());
+    auto item_offset = [mem](const QString &key) {
+        return static_cast<int>(mem->offset(MemoryLayout::MEM_ITEM, key));
+    };
+    m_off_id = item_offset("id");
+    m_off_stack_size = item_offset("stack_size");
+    m_off_wear = item_offset("wear");
+    m_off_mat_type = item_offset("mat_type");
+    m_off_mat_idx = item_offset("mat_index");
+    m_off_maker_race = item_offset("maker_race");
+    m_off_quality = item_offset("quality");
+    m_off_general_refs = item_offset("general_refs");
+
+    //the vtable is at the start, the header runs to the end of the furthest field
+    m_span = ptr_size;
+    m_span = qMax(m_span, m_off_id + 4);
+    m_span = qMax(m_span, m_off_stack_size + 4);
+    m_span = qMax(m_span, m_off_wear + 2);
+    m_span = qMax(m_span, m_off_mat_type + 2);
+    m_span = qMax(m_span, m_off_mat_idx + 4);
+    m_span = qMax(m_span, m_off_maker_race + 2);
+    m_span = qMax(m_span, m_off_quality + 2);
+    m_span = qMax(m_span, m_off_general_refs + 2 * ptr_size);
+    LOGD << "item header is" << m_span << "bytes";
+
+    //a ref's vtable gives its type, the ids follow
+    m_ref_span = ptr_size;
+    m_ref_span = qMax(m_ref_span, static_cast<int>(mem->general_ref_offset("artifact_id")) + 4);
+    m_ref_span = qMax(m_ref_span, static_cast<int>(mem->general_ref_offset("item_id")) + 4);
+    m_layout_ready = true;
+}
+
+ItemRecord ItemRepository::get(VIRTADDR addr){
+    if(!m_layout_ready)
+        load_layout();
+
+    auto it = m_records.find(addr);
+    if(it != m_records.end() && it->generation == m_generation){
+        m_hits++;
+        return *it;
+    }
+
+    QByteArray header(m_span, 0);
+    m_df->read_raw(addr, m_span, header);
+    QByteArray fp = fingerprint(header);
+    if(it != m_records.end() && it->fingerprint == fp){
+        it->generation = m_generation;
+        m_hits++;
+        return *it;
+    }
+
+    ItemRecord r;
+    r.fingerprint = fp;
+    r.generation = m_generation;
+    decode(addr, header, r);
+    m_decodes++;
+    m_records.insert(addr, r);
+    return r;
+}
+
+QByteArray ItemRepository::fingerprint(const QByteArray &header) const{
+    int ptr_size = static_cast<int>(m_df->pointer_size());
+    QByteArray fp;
+    fp.reserve(32 + 3 * ptr_size);
+    append_field(fp, header, 0, ptr_size);
+    append_field(fp, header, m_off_id, 4);
+    append_field(fp, header, m_off_stack_size, 4);
+    append_field(fp, header, m_off_wear, 2);
+    append_field(fp, header, m_off_mat_type, 2);
+    append_field(fp, header, m_off_mat_idx, 4);
+    append_field(fp, header, m_off_maker_race, 2);
+    append_field(fp, header, m_off_quality, 2);
+    append_refs(fp, header);
+    return fp;
+}
+
+void ItemRepository::append_refs(QByteArray &fp, const QByteArray &header) const{
+    if(m_off_general_refs < 0)
+        return;
+    //the bounds change when refs are added or removed
+    int ptr_size = static_cast<int>(m_df->pointer_size());
+    append_field(fp, header, m_off_general_refs, 2 * ptr_size);
+
+    VIRTADDR start = 0;
+    VIRTADDR end = 0;
+    if(m_off_general_refs + 2 * ptr_size <= header.size()){
+        std::memcpy(&start, header.constData() + m_off_general_refs, ptr_size);
+        std::memcpy(&end, header.constData() + m_off_general_refs + ptr_size, ptr_size);
+    }
+    //items only carry a handful of refs, anything else is garbage that decode will reject
+    const int max_refs = 256;
+    int count = end > start ? static_cast<int>((end - start) / ptr_size) : 0;
+    if(count <= 0 || count > max_refs)
+        return;
+
+    //a ref can be swapped for another one without changing the count
+    QByteArray refs(count * ptr_size, 0);
+    m_df->read_raw(start, refs.size(), refs);
+    fp.append(refs);
+    QByteArray ref_head(m_ref_span, 0);
+    for(int i = 0; i < count; i++){
+        VIRTADDR ref = 0;
+        std::memcpy(&ref, refs.constData() + i * ptr_size, ptr_size);
+        m_df->read_raw(ref, m_ref_span, ref_head);
+        fp.append(ref_head);
+    }
+}
+
+void ItemRepository::decode(VIRTADDR addr, const QByteArray &header, ItemRecord &r){
+    VIRTADDR item_vtable = 0;
+    if(header.size() >= static_cast<int>(m_df->pointer_size()))
+        std::memcpy(&item_vtable, header.constData(), m_df->pointer_size());
+    r.type = static_cast<ITEM_TYPE>(m_df->read_int(m_df->read_addr(item_vtable) + m_df->VM_TYPE_OFFSET()));
+
+    header_value(header, m_off_id, r.id);
+    header_value(header, m_off_stack_size, r.stack_size);
+    header_value(header, m_off_wear, r.wear);
+    header_value(header, m_off_mat_type, r.mat_type);
+    header_value(header, m_off_mat_idx, r.mat_idx);
+    header_value(header, m_off_maker_race, r.maker_race);
+    header_value(header, m_off_quality, r.quality);
+
+    r.material_name = capitalizeEach(m_df->find_material_name(r.mat_idx, r.mat_type, r.type));
+    Material *m = m_df->find_material(r.mat_idx, r.mat_type);
+    if(m){
+        r.material_flags = FlagArray(m->flags());
+        r.material_name_base = Item::get_material_base_name(m->flags());
+    }
+
+    if(m_off_general_refs < 0)
+        return;
+    MemoryLayout *mem = m_df->memory_layout();
+    QVector<VIRTADDR> gen_refs = m_df->enumerate_vector(addr + m_off_general_refs);
+    foreach(VIRTADDR ref, gen_refs){
+        VIRTADDR gen_ref_vtable = m_df->read_addr(ref);
+        int ref_type = m_df->read_int(m_df->read_addr(mem->general_ref_field(gen_ref_vtable, "ref_type")) + m_df->VM_TYPE_OFFSET());
+        if(ref_type == 0 || ref_type == 1){
+            LOGD << "reading type:" << ref_type << "(artifact name)";
+            int artifact_id = m_df->read_int(mem->general_ref_field(ref, "artifact_id"));
+            if(artifact_id){
+                r.artifact_name = m_df->get_artifact_name(ARTIFACTS,artifact_id);
+                break;
+            }
+        }else if(ref_type == 10 && r.type == QUIVER){ //type of container item, could be expanded to show food and drink
+            LOGD << "reading type:" << ref_type << "(container)";
+            int item_id = m_df->read_int(mem->general_ref_field(ref, "item_id"));
+            VIRTADDR ammo_addr = m_df->get_item_address(AMMO,item_id);
+            if(ammo_addr){
+                r.contained_ammo.append(ammo_addr);
+            }else{
+                LOGE << "found unknown ammo!";
+            }
+        }
+    }
+}
+
+void ItemRepository::begin_generation(){
+    if(m_hits || m_decodes)
+        LOGD << "item repository:" << m_decodes << "items decoded," << m_hits << "reused," << m_records.size() << "cached";
+    for(auto it = m_records.begin(); it != m_records.end();){
+        if(it->generation != m_generation)
+            it = m_records.erase(it);
+        else
+            ++it;
+    }
+    m_generation++;
+    m_hits = 0;
+    m_decodes = 0;
+}
+
+void ItemRepository::clear(){
+    m_records.clear();
+    m_layout_ready = false;
+}
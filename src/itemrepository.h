@@ -0,0 +1,113 @@
+/*
+Dwarf Therapist
+Copyright (c) 2009 Trey Stout (chmod)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+#ifndef ITEM_REPOSITORY_H
+#define ITEM_REPOSITORY_H
+
+#include "flagarray.h"
+#include "global_enums.h"
+#include "utils.h"
+
+#include <QByteArray>
+#include <QHash>
+#include <QString>
+#include <QVector>
+
+class DFInstance;
+
+//! the decoded fields of one game item, shared by every Item built from the same address
+struct ItemRecord
+{
+    ItemRecord();
+
+    ITEM_TYPE type;
+    int id;
+    int stack_size;
+    short wear;
+    short mat_type;
+    int mat_idx;
+    short maker_race;
+    short quality;
+    QString material_name;
+    QString material_name_base;
+    FlagArray material_flags;
+    QString artifact_name;
+    //! ammo referenced by a quiver
+    QVector<VIRTADDR> contained_ammo;
+
+    //! the raw values the record was decoded from
+    QByteArray fingerprint;
+    int generation;
+};
+
+/**
+ * Decode cache for items, keyed by address and kept across refreshes.
+ *
+ * The first request for an item in a refresh does a single read of the
+ * item header; the bytes holding the vtable, id, stack size, wear,
+ * material and quality form its fingerprint, along with the general refs:
+ * the ref pointers and the head (vtable and artifact or item id) of each
+ * ref, one read per ref. If the fingerprint matches the cached record no
+ * further reads are done, otherwise the item is decoded again (type,
+ * artifact name, contained ammo, material names). Later requests in the same refresh, such as an artifact
+ * carried by one unit and listed in a uniform, reuse the record as is.
+ */
+class ItemRepository
+{
+public:
+    explicit ItemRepository(DFInstance *df);
+
+    ItemRecord get(VIRTADDR addr);
+
+    //! start a new refresh, records nobody asked for during the last one are dropped
+    void begin_generation();
+    void clear();
+
+private:
+    DFInstance *m_df;
+    QHash<VIRTADDR, ItemRecord> m_records;
+    int m_generation;
+
+    //offsets of the fingerprinted fields, -1 if missing from the layout
+    bool m_layout_ready;
+    int m_span;
+    int m_off_id;
+    int m_off_stack_size;
+    int m_off_wear;
+    int m_off_mat_type;
+    int m_off_mat_idx;
+    int m_off_maker_race;
+    int m_off_quality;
+    int m_off_general_refs;
+    //! bytes read from each general ref, up to the end of its id fields
+    int m_ref_span;
+
+    int m_hits;
+    int m_decodes;
+
+    void load_layout();
+    QByteArray fingerprint(const QByteArray &header) const;
+    void append_refs(QByteArray &fp, const QByteArray &header) const;
+    void decode(VIRTADDR addr, const QByteArray &header, ItemRecord &r);
+};
+
+#endif // ITEM_REPOSITORY_H
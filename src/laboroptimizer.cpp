@@ -41,7 +41,6 @@ After everything is optimized, any haulers are assigned with less than the speci
 #include "labor.h"
 #include "skill.h"
 
-#include <QSettings>
 
 #include <algorithm>
 
@@ -56,7 +55,7 @@ LaborOptimizer::LaborOptimizer(laborOptimizerPlan *plan, QObject *parent)
     , m_target_population(0)
     , m_labors_exceed_pop(false)
 {
-    m_check_conflicts = DT->user_settings()->value("options/labor_exclusions",true).toBool();
+    m_check_conflicts = DT->settings().labor_exclusions;
     gdr = GameDataReader::ptr();
 }
 
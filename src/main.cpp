@@ -39,6 +39,11 @@ int main(int argc, char *argv[]) {
 #endif
 
     //QLoggingCategory::setFilterRules("qt.network.ssl.warning=false");
+    // headless runs must not need a display, the platform has to be chosen before the application exists
+    for (int i = 1; i < argc; ++i) {
+        if ((qstrcmp(argv[i], "--headless") == 0 || qstrcmp(argv[i], "-headless") == 0) && qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM"))
+            qputenv("QT_QPA_PLATFORM", "offscreen");
+    }
     DwarfTherapist d(argc, argv);
     return d.exec();
 }
@@ -61,10 +61,15 @@ THE SOFTWARE.
 #include "rolepreferencemodel.h"
 #include "defaultroleweight.h"
 #include "memorylayoutdialog.h"
+#include "accessstatsdialog.h"
+#include "profiler.h"
+#include "gridrenderer.h"
+#include "gridexporter.h"
 
 #include <QCompleter>
 #include <QDesktopServices>
 #include <QFileDialog>
+#include <QFileInfo>
 #include <QMessageBox>
 #include <QPainter>
 #include <QProgressBar>
@@ -98,6 +103,7 @@ MainWindow::MainWindow(QWidget *parent)
     , m_retry_connection(0)
 {
     ui->setupUi(this);
+    ui->act_record_trace->setChecked(Profiler::ptr()->enabled());
 
     m_updater = std::make_unique<Updater>();
     m_notifier = std::make_unique<NotifierWidget>(this);
@@ -339,6 +345,7 @@ void MainWindow::closeEvent(QCloseEvent *evt) {
 }
 
 void MainWindow::connect_to_df() {
+    PROFILE_SCOPE("connect_to_df");
     bool show_dc_dialog = true;
     if(m_retry_connection){
         if(m_retry_connection->isActive()){
@@ -360,11 +367,18 @@ void MainWindow::connect_to_df() {
     m_pref_model->set_df_instance(m_df);
     if(m_df){
         //attempt to connect to the process first
-        m_df->find_running_copy();
+        {
+            PROFILE_SCOPE("find_running_copy");
+            m_df->find_running_copy();
+        }
 
         if(m_df->status() == DFInstance::DFS_GAME_LOADED){
-            LOGI << "Connection to DF version" << m_df->memory_layout()->game_version() << "established.";
-            set_status_message(tr("Connected to DF %1").arg(m_df->memory_layout()->game_version()),tr("Currently using layout file: %1").arg(m_df->memory_layout()->filepath()));
+            if(m_df->memory_layout()){
+                LOGI << "Connection to DF version" << m_df->memory_layout()->game_version() << "established.";
+                set_status_message(tr("Connected to DF %1").arg(m_df->memory_layout()->game_version()),tr("Currently using layout file: %1").arg(m_df->memory_layout()->filepath()));
+            }else{
+                set_status_message(tr("Using a synthetic fortress"),tr("Units are generated, no game is connected"));
+            }
 
             GameDataReader::ptr()->refresh_facets();
 
@@ -373,8 +387,13 @@ void MainWindow::connect_to_df() {
             connect(m_df, SIGNAL(progress_range(int,int)), SLOT(set_progress_range(int,int)), Qt::UniqueConnection);
             connect(m_df, SIGNAL(progress_value(int)), SLOT(set_progress_value(int)), Qt::UniqueConnection);
             connect(m_df, SIGNAL(connection_interrupted()), SLOT(lost_df_connection()));
+            //queued, reconnecting deletes the instance that is still inside its heartbeat
+            connect(m_df, SIGNAL(fortress_changed()), SLOT(fortress_changed()), Qt::QueuedConnection);
+            connect(m_df, SIGNAL(game_time_advanced()), SLOT(game_time_advanced()));
 
             m_df->load_game_data();
+            LOGI << "remote memory access while loading game data:";
+            m_df->log_access_stats();
             if(m_view_manager){
                 m_view_manager->reload_views();
                 m_view_manager->draw_views();
@@ -460,14 +479,76 @@ void MainWindow::lost_df_connection(bool show_dialog) {
     }
 }
 
+void MainWindow::fortress_changed() {
+    //everything read so far, including pending changes, belongs to the previous fort
+    LOGI << "a different fortress was loaded";
+    if(has_pending_changes()){
+        int answer = QMessageBox::question(this, tr("Fortress changed"),
+                tr("A different fortress has been loaded in Dwarf Fortress. Your uncommitted "
+                   "changes belong to the previous fortress and can't be written to this one.<br/><br/>"
+                   "Reconnect now and discard them?"),
+                QMessageBox::Yes, QMessageBox::No);
+        if(answer != QMessageBox::Yes){
+            //keep the changes on screen, but don't let them be written to the new fort
+            LOGI << "keeping pending changes, disconnected until the user reconnects";
+            m_df->disconnect(this);
+            set_interface_enabled(false);
+            ui->act_commit_pending_changes->setEnabled(false);
+            set_status_message(tr("Fortress changed"), tr("Reconnect to read the fortress that is now loaded"));
+            return;
+        }
+        m_model->clear_all(true);
+    }
+    LOGI << "reconnecting";
+    connect_to_df();
+}
+
+void MainWindow::game_time_advanced() {
+    static const qint64 auto_refresh_interval = 30000;
+    if(!DT->user_settings()->value("options/auto_refresh", false).toBool())
+        return;
+    if(m_last_read.isValid() && m_last_read.elapsed() < auto_refresh_interval)
+        return;
+    //never throw away changes the user hasn't committed yet
+    if(has_pending_changes())
+        return;
+    LOGD << "game time advanced, refreshing units";
+    read_dwarves();
+}
+
+bool MainWindow::has_pending_changes() const {
+    if(!m_model->get_dirty_dwarves().isEmpty())
+        return true;
+    if(m_df){
+        foreach(Squad *s, m_df->squads()){
+            if(s->pending_changes())
+                return true;
+        }
+    }
+    return false;
+}
+
+//! adopt an instance that was created and connected elsewhere (ie. benchmarks)
+void MainWindow::set_instance(DFInstance *df) {
+    if (m_df && m_df != df) {
+        delete m_df;
+        reset();
+    }
+    m_df = df;
+    m_model->set_instance(m_df);
+    m_pref_model->set_df_instance(m_df);
+}
+
 void MainWindow::read_dwarves() {
     if(!m_df || m_df->status() != DFInstance::DFS_GAME_LOADED) {
         lost_df_connection();
         return;
     }
 
+    PROFILE_SCOPE("read_dwarves");
     QTime t;
     t.start();
+    m_last_read.start();
 
     save_ui_selections();
 
@@ -482,6 +563,7 @@ void MainWindow::read_dwarves() {
     m_model->clear_all(false);
 
     m_model->set_instance(m_df);
+    m_df->reset_access_stats();
     m_df->refresh_data();
     m_model->load_dwarves();
 
@@ -496,7 +578,10 @@ void MainWindow::read_dwarves() {
     set_interface_enabled(true);
     new_pending_changes(0);
 
-    m_view_manager->redraw_current_tab();
+    {
+        PROFILE_SCOPE("redraw_current_tab");
+        m_view_manager->redraw_current_tab();
+    }
 
     // setup the filter auto-completer and reselect our dwarf for the details dock
     QStandardItemModel *filters = new QStandardItemModel(this);
@@ -508,7 +593,7 @@ void MainWindow::read_dwarves() {
 
     restore_ui_selections();
 
-    QHash<QPair<QString,QString>,DFInstance::pref_stat* > prefs = DT->get_DFInstance()->get_preference_stats();
+    QHash<QPair<QString,QString>,DFInstance::pref_stat> prefs = DT->get_DFInstance()->get_preference_stats();
     QPair<QString,QString> key_pair;
     foreach(key_pair, prefs.uniqueKeys()){
         QStandardItem *i = new QStandardItem(key_pair.second);
@@ -567,6 +652,8 @@ void MainWindow::read_dwarves() {
     this->setWindowTitle(tr("%1 on %2").arg(m_df->fortress_name()).arg(date_str));
 
     LOGI << "completed read in" << t.elapsed() << "ms";
+    LOGI << "remote memory access during read:";
+    m_df->log_access_stats();
     set_progress_message("");
 }
 
@@ -827,6 +914,11 @@ void MainWindow::show_memory_layouts() {
     dialog.exec();
 }
 
+void MainWindow::show_access_stats() {
+    AccessStatsDialog dialog(m_df, this);
+    dialog.exec();
+}
+
 void MainWindow::open_data_dir() {
     QDir data_dir = StandardPaths::writable_data_location();
 
@@ -865,6 +957,22 @@ void MainWindow::open_log_dir() {
     QDesktopServices::openUrl(QUrl::fromLocalFile(log_dir.path()));
 }
 
+void MainWindow::toggle_performance_trace(bool enabled) {
+    Profiler::ptr()->set_enabled(enabled);
+}
+
+void MainWindow::export_performance_trace() {
+    QString default_path = QDir(StandardPaths::log_location()).filePath("dt_trace.json");
+    QString file_name = QFileDialog::getSaveFileName(this, tr("Save performance trace as"), default_path, tr("Chrome trace files (*.json)"));
+    if (file_name.isEmpty())
+        return;
+    if (!file_name.endsWith(".json"))
+        file_name.append(".json");
+    if (!Profiler::ptr()->write_chrome_trace(file_name)) {
+        QMessageBox::warning(this, tr("Export Failed"), tr("Unable to write the performance trace to %1").arg(file_name));
+    }
+}
+
 void MainWindow::open_help(){
     QUrl url("http://dffd.wimbli.com/file.php?id=7889");
     foreach (const QString &dir, StandardPaths::doc_locations()) {
@@ -906,51 +1014,38 @@ void MainWindow::import_custom_roles(){
         d.exec();
 }
 
-void MainWindow::save_gridview_csv()
+void MainWindow::export_gridview_data()
 {
     GridView *gv = m_view_manager->get_active_view();
 
     QString defaultPath = QString("%1.csv").arg(gv->name());
-    QString fileName = QFileDialog::getSaveFileName(0 , tr("Save file as"), defaultPath, tr("csv files (*.csv)"));
+    QStringList filters;
+    filters << tr("csv files (*.csv)") << tr("JSON lines (*.jsonl)");
+    if(GridExporter::gzip_supported())
+        filters << tr("gzipped csv files (*.csv.gz)") << tr("gzipped JSON lines (*.jsonl.gz)");
+    QString selected_filter;
+    QString fileName = QFileDialog::getSaveFileName(0 , tr("Save file as"), defaultPath, filters.join(";;"), &selected_filter);
     if (fileName.length()==0)
         return;
-    if (!fileName.endsWith(".csv"))
-        fileName.append(".csv");
-    QFile f( fileName );
-    if (f.exists())
-        f.remove();
-
-    if(f.open(QIODevice::WriteOnly | QIODevice::Text)){
-        QTextStream out(&f);
 
-        QStringList row;
-        row.append(tr("Name"));
-        foreach(ViewColumnSet *set, gv->sets()) {
-            foreach(ViewColumn *col, set->columns()) {
-                if (col->type() != CT_SPACER)
-                    row.append(col->title());
-            }
-        }
-        out << row.join(",") << endl;
-        row.clear();
-
-        QList<Dwarf*> dwarves = m_proxy->get_filtered_dwarves();
-        foreach(Dwarf *d, dwarves){
-            // The model list all creatures without regard to the gridview animal flags, add a filter here
-            if (gv->show_animals() != d->is_animal())
-                continue;
-            row.append(d->nice_name());
-            foreach(ViewColumnSet *set, gv->sets()) {
-                foreach(ViewColumn *col, set->columns()) {
-                    if (col->type() != CT_SPACER)
-                        row.append(col->get_cell_value(d));
-                }
-            }
-            out << row.join(",") << endl;
-            row.clear();
-        }
-        f.close();
+    //the extension is checked without the .gz suffix, which is put back at the end
+    bool gzip = GridExporter::gzip_supported() && (fileName.endsWith(".gz") || selected_filter.contains(".gz"));
+    QString name = fileName.endsWith(".gz") ? fileName.left(fileName.length() - 3) : fileName;
+    GridExporter::FORMAT fmt = GridExporter::FMT_CSV;
+    if(name.endsWith(".jsonl")){
+        fmt = GridExporter::FMT_JSONL;
+    }else if(!name.endsWith(".csv")){
+        if(selected_filter.contains(".jsonl"))
+            fmt = GridExporter::FMT_JSONL;
+        name.append(fmt == GridExporter::FMT_JSONL ? ".jsonl" : ".csv");
     }
+    fileName = gzip ? name + ".gz" : name;
+
+    QApplication::setOverrideCursor(Qt::WaitCursor);
+    bool ok = GridExporter(gv, m_proxy->get_filtered_dwarves()).write(fileName, fmt, gzip);
+    QApplication::restoreOverrideCursor();
+    if(!ok)
+        QMessageBox::warning(this, tr("Export Failed"), tr("Unable to write %1").arg(fileName));
 }
 
 void MainWindow::export_gridviews() {
@@ -1068,7 +1163,7 @@ void MainWindow::edit_custom_role() {
 void MainWindow::done_editing_role(int result){
     if(result == QDialog::Accepted){
         write_roles();
-        refresh_roles_data();
+        refresh_roles_data(m_role_editor->saved_roles());
     }
     disconnect(m_view_manager, SIGNAL(selection_changed()), m_role_editor, SLOT(selection_changed()));
 }
@@ -1104,6 +1199,9 @@ void MainWindow::remove_custom_role(){
         //re-read roles from the ini to replace any default roles that may have been replaced by a custom role which was just removed
         //this will also rebuild our sorted role list
         GameDataReader::ptr()->load_roles();
+        //a default role may have taken the removed role's place, otherwise its ratings are dropped
+        if(m_df)
+            m_df->update_role_ratings(QStringList(name));
         //update our current roles/ui elements
         DT->emit_roles_changed();
         refresh_role_menus();
@@ -1114,7 +1212,10 @@ void MainWindow::remove_custom_role(){
     }
 }
 
-void MainWindow::refresh_roles_data(){
+void MainWindow::refresh_roles_data(const QStringList &changed_roles){
+    //only the changed roles need to be rated again, before the columns pick up the new roles
+    if(m_df)
+        m_df->update_role_ratings(changed_roles);
     DT->emit_roles_changed();
     GameDataReader::ptr()->load_role_mappings();
 
@@ -1206,58 +1307,18 @@ void MainWindow::print_gridview() {
     if(path.isEmpty())
         return;
 
-    int w = 0;
-    int h = 0;
-    QSize currSize = this->size();
-    QSize currMax = this->maximumSize();
-    QSize currMin = this->minimumSize();
-    int cell_size = DT->user_settings()->value("options/grid/cell_size", DEFAULT_CELL_SIZE).toInt();
-    int cell_pad = DT->user_settings()->value("options/grid/cell_padding", 0).toInt();
-
-    int actual_cell_size = (cell_size + 2) + (2 * cell_pad); //cell size + 2 for the border lines + (2 * cell padding)
-
-    //currently this is just a hack to resize the form to ensure all rows/columns are showing
-    //then rendering to the painter and resizing back to the previous size
-    //it may be possible to avoid this by using the opengl libs and accessing the frame buffer
-
-    //calculate the width
-    int first_col_width = s->columnWidth(0);
-    w = first_col_width;
-    w += (this->width() - s->width());
-    foreach(ViewColumnSet *vcs, m_view_manager->get_active_view()->sets()){
-        foreach(ViewColumn *vc, vcs->columns()){
-            if(vc->type() != CT_SPACER)
-                w += actual_cell_size;
-            else
-                w += DEFAULT_SPACER_WIDTH;
-        }
+    //paints the header and cells off-screen in strips, only non-png snapshots are split into several images
+    QApplication::setOverrideCursor(Qt::WaitCursor);
+    QStringList files = GridRenderer(s).save(path);
+    QApplication::restoreOverrideCursor();
+
+    if(files.isEmpty()){
+        QMessageBox::warning(this, tr("Export Failed"), tr("Unable to write the snapshot to %1").arg(path));
+    }else if(files.size() > 1){
+        QMessageBox::information(this, tr("Snapshot Saved"),
+                                 tr("The view was too large for a single image and has been saved as %1 tiles named %2_r<row>_c<column>.")
+                                 .arg(files.size()).arg(QFileInfo(path).completeBaseName()));
     }
-    w += 2;
-
-    //calculate the height
-    h = (s->get_model()->total_row_count() * actual_cell_size) + s->get_header()->height();
-    h += (this->height() - s->height());
-    h += 2; //small buffer for the edge
-
-    this->setMaximumHeight(h);
-    this->setMaximumWidth(w);
-    this->setMinimumSize(100,100);
-    this->resize(w,h);
-
-    QImage img(QSize(s->width(),s->height()),QImage::Format_ARGB32_Premultiplied);
-    QPainter painter(&img);
-    painter.setRenderHints(QPainter::SmoothPixmapTransform);
-    s->setHorizontalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
-    s->setVerticalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
-    s->render(&painter,QPoint(0,0),QRegion(0,0,s->width(),s->height()),QWidget::DrawChildren | QWidget::DrawWindowBackground);
-    painter.end();
-    img.save(path,"PNG");
-    s->setHorizontalScrollBarPolicy(Qt::ScrollBarAsNeeded);
-    s->setVerticalScrollBarPolicy(Qt::ScrollBarAsNeeded);
-
-    this->setMaximumSize(currMax);
-    this->setMinimumSize(currMin);
-    this->resize(currSize);
 }
 
 ///////////////////////////////////////////////////////////////////////////////
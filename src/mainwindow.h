@@ -23,6 +23,7 @@ THE SOFTWARE.
 #ifndef MAINWINDOW_H
 #define MAINWINDOW_H
 
+#include <QElapsedTimer>
 #include <QMainWindow>
 #include <memory>
 
@@ -68,6 +69,7 @@ public:
     DwarfModelProxy *get_proxy() {return m_proxy;}
     ViewManager *get_view_manager() {return m_view_manager;}
     DFInstance *get_DFInstance() {return m_df;}
+    void set_instance(DFInstance *df);
 
     Ui::MainWindow *ui;
 
@@ -114,7 +116,7 @@ public slots:
 
     //gridview exporting
     void print_gridview();
-    void save_gridview_csv();
+    void export_gridview_data();
 
     // links
     void go_to_forums();
@@ -124,9 +126,14 @@ public slots:
     void go_to_latest_release();
     void check_latest_version();
     void show_memory_layouts();
+    void show_access_stats();
     void open_data_dir();
     void open_log_dir();
 
+    //performance tracing
+    void toggle_performance_trace(bool enabled);
+    void export_performance_trace();
+
     //help
     void open_help();
 
@@ -145,7 +152,7 @@ public slots:
     void add_new_custom_role();
     void add_new_opt();
     void write_roles(bool custom = true);
-    void refresh_roles_data();
+    void refresh_roles_data(const QStringList &changed_roles = QStringList());
 
     //optimizer
     void refresh_opts_data();
@@ -189,6 +196,7 @@ private:
     QAction *m_act_btn_optimize; //this is required in addition to the button to allow easy visibility toggling
     QToolButton *m_btn_optimize;
     QTimer *m_retry_connection;
+    QElapsedTimer m_last_read; //! throttles refreshes triggered by the game clock
 
     std::unique_ptr<Updater> m_updater;
     std::unique_ptr<NotifierWidget> m_notifier;
@@ -204,10 +212,15 @@ private:
     void reset();
 
     void refresh_pop_counts();
+    //! true if labor or squad edits haven't been committed yet
+    bool has_pending_changes() const;
 
 private slots:
     void set_interface_enabled(bool);
 
+    void fortress_changed();
+    void game_time_advanced();
+
     void edit_custom_role();
     void remove_custom_role();
 
@@ -21,8 +21,10 @@ MultiLabor::MultiLabor(QObject *parent)
     , m_dialog(0)
     , m_selected_count(0)
     , m_internal_change_flag(false)
+    , m_skilled_count(0)
+    , m_ratings_valid(false)
 {
-    connect(DT,SIGNAL(roles_changed()),this,SLOT(refresh()),Qt::UniqueConnection); //refresh after any role changes
+    connect(DT,SIGNAL(roles_changed()),this,SLOT(refresh_roles()),Qt::UniqueConnection); //refresh after any role changes
     connect(DT,SIGNAL(units_refreshed()),this,SLOT(refresh()),Qt::UniqueConnection); //refresh information after a read
     connect(DT, SIGNAL(settings_changed()), this, SLOT(read_settings()));
     read_settings();
@@ -122,17 +124,28 @@ void MultiLabor::build_role_combo(QComboBox *cb_roles){
 
 
 void MultiLabor::set_labor(int labor_id, bool active) {
-    if (m_active_labors.contains(labor_id) && !active)
-        m_active_labors.remove(labor_id);
+    if (is_active(labor_id) == active)
+        return;
     if (active)
         m_active_labors.insert(labor_id, true);
+    else
+        m_active_labors.remove(labor_id);
+    if (m_ratings_valid)
+        apply_labor(labor_id, active);
+    update_labor_desc();
+}
+
+void MultiLabor::clear_labors(){
+    m_active_labors.clear();
+    m_ratings_valid = false;
+    update_labor_desc();
 }
 
 void MultiLabor::set_labors(Dwarf *d){
     if(!d){
         d = m_dwarf;
     }
-    m_active_labors.clear();
+    clear_labors();
     QList<Labor*> labors = gdr->get_ordered_labors();
     foreach(Labor *l, labors) {
         if(d->labor_enabled(l->labor_id))
@@ -140,11 +153,7 @@ void MultiLabor::set_labors(Dwarf *d){
     }
 }
 
-void MultiLabor::refresh(){
-    m_qvariant_labors.clear();
-    m_ratings.clear();
-    m_labor_desc.clear();
-
+void MultiLabor::update_role(){
     //check and update the role if necessary
     if(!m_role || m_role != gdr->get_role(m_role_name)){
         m_role = gdr->get_role(m_role_name); //default overridden or new role
@@ -154,85 +163,159 @@ void MultiLabor::refresh(){
         if(curr_id != m_role_name)
             m_role_name = curr_id;
     }
+}
+
+void MultiLabor::update_labor_desc(){
+    m_qvariant_labors.clear();
+    m_labor_desc.clear();
+    foreach(int labor_id, get_enabled_labors()){
+        Labor *l = gdr->get_labor(labor_id);
+        if(!l)
+            continue;
+        m_labor_desc.insert(labor_id, l->name);
+        m_qvariant_labors.append(labor_id);
+    }
+}
 
-    //build descriptions
+/*!
+Rebuild the descriptions and mark the ratings as stale. The ratings of every
+unit are rebuilt in a single pass the next time one of them is requested.
+*/
+void MultiLabor::refresh(){
+    update_role();
+    update_labor_desc();
+    m_ratings_valid = false;
+    read_settings();
+}
 
+void MultiLabor::refresh_roles(){
+    update_role();
+    if(!m_ratings_valid)
+        return;
 
-    //build ratings
-    QList<Dwarf*> dwarves = DT->get_dwarves();
+    QVector<labor_info> infos;
+    foreach(int labor_id, get_enabled_skilled_labors()){
+        labor_info li = get_labor_info(labor_id);
+        if(!li.role_name.isEmpty())
+            infos.append(li);
+    }
+    foreach(Dwarf *d, DT->get_dwarves()){
+        QHash<int,int>::const_iterator row = m_unit_rows.constFind(d->id());
+        if(row == m_unit_rows.constEnd()){
+            m_ratings_valid = false;
+            return;
+        }
+        unit_ratings &r = m_ratings[row.value()];
+        r.role = 0;
+        foreach(const labor_info &li, infos){
+            r.role += d->get_role_rating(li.role_name);
+        }
+        r.named_role = m_role_name.isEmpty() ? 0 : d->get_role_rating(m_role_name);
+    }
+}
+
+MultiLabor::labor_info MultiLabor::get_labor_info(int labor_id){
+    labor_info li;
+    li.labor_id = labor_id;
+    Labor *l = gdr->get_labor(labor_id);
+    li.skill_id = l ? l->skill_id : -1;
     //at the moment it's not possible to have roles associated to non-skill labors (hauling)
     //so we can exclude all non-skilled labors from the ratings
-    QVector<int> labors = get_enabled_labors();
-    int skilled_count = 0;
-    int skill_id = -1;
-    if(labors.count() > 0){
-        foreach(int labor_id, labors){
-            Labor *l = GameDataReader::ptr()->get_labor(labor_id);
-            QString name = l->name;
-            skill_id = l->skill_id;
-            if(skill_id >= 0)
-                skilled_count++;
-            m_labor_desc.insert(l->labor_id,name);
-            m_qvariant_labors.append(labor_id);
-            foreach(Dwarf *d, dwarves){
-                QList<float> ratings = m_ratings.take(d->id());
-                if(ratings.size() <= 0)
-                    ratings << 0 << 0 << 0 << 0;
+    if(li.skill_id >= 0){
+        QVector<Role*> roles = gdr->get_skill_roles().value(li.skill_id);
+        if(roles.size() > 0)
+            li.role_name = roles.first()->name();
+    }
+    return li;
+}
 
-                if(d->labor_enabled(l->labor_id) && ratings[ML_ACTIVE] <= 0)
-                    ratings[ML_ACTIVE] = 1000;
+void MultiLabor::add_labor_ratings(unit_ratings &r, Dwarf *d, const labor_info &li, float sign){
+    //the unit's labors may have changed since it was counted, so only remove what was added
+    if(sign > 0){
+        if(d->labor_enabled(li.labor_id))
+            r.active_labors.append(li.labor_id);
+    }else{
+        r.active_labors.removeOne(li.labor_id);
+    }
+    if(li.skill_id >= 0){
+        r.skill += sign * d->get_skill_level(li.skill_id,false,true); //capped rating
+        r.skill_rate += sign * d->get_skill(li.skill_id).skill_rate();
+        if(!li.role_name.isEmpty())
+            r.role += sign * d->get_role_rating(li.role_name);
+    }
+}
 
-                if(skill_id >= 0){
-                    ratings[ML_SKILL] += d->get_skill_level(l->skill_id,false,true); //capped rating, ignore non-skilled labors
-                    ratings[ML_SKILL_RATE] += d->get_skill(l->skill_id).skill_rate();
-                }
+void MultiLabor::build_ratings(){
+    QList<Dwarf*> dwarves = DT->get_dwarves();
+    QVector<labor_info> infos;
+    m_skilled_count = 0;
+    foreach(int labor_id, get_enabled_labors()){
+        infos.append(get_labor_info(labor_id));
+        if(infos.last().skill_id >= 0)
+            m_skilled_count++;
+    }
 
-                if(m_role_name.isEmpty()){
-                    //find related roles based on the labor's skill
-                    if(skill_id >= 0){
-                        QVector<Role*> roles = gdr->get_skill_roles().value(l->skill_id);
-                        if(roles.size() > 0){
-                            ratings[ML_ROLE] += d->get_role_rating(roles.first()->name());
-                        }
-                    }
-                }else if(!m_ratings.contains(d->id())){
-                    ratings[ML_ROLE] = d->get_role_rating(m_role_name);
-                }
-                m_ratings.insert(d->id(),ratings);
-            }
+    m_ratings.assign(dwarves.size(), unit_ratings());
+    m_unit_rows.clear();
+    m_unit_rows.reserve(dwarves.size());
+    for(int i = 0; i < dwarves.size(); i++){
+        Dwarf *d = dwarves.at(i);
+        m_unit_rows.insert(d->id(), i);
+        unit_ratings &r = m_ratings[i];
+        foreach(const labor_info &li, infos){
+            add_labor_ratings(r, d, li, 1.0f);
         }
-        foreach(Dwarf *d, dwarves){
-            if(skilled_count > 0){
-                m_ratings[d->id()][ML_SKILL] /= skilled_count;
-                m_ratings[d->id()][ML_SKILL_RATE] /= skilled_count;
-                if(m_role_name == "")
-                    m_ratings[d->id()][ML_ROLE] /= skilled_count;
-            }else{
-                m_ratings[d->id()][ML_SKILL] = -1;
-                m_ratings[d->id()][ML_SKILL_RATE] = 0;
-            }
-//            if(m_active_labors.count() > 0)
-//                m_ratings[d->id()][ML_ACTIVE] = (1000.0f * ((float)m_ratings[d->id()][ML_ACTIVE]/(float)m_active_labors.count()));
+        r.named_role = m_role_name.isEmpty() ? 0 : d->get_role_rating(m_role_name);
+    }
+    m_ratings_valid = true;
+}
+
+void MultiLabor::apply_labor(int labor_id, bool active){
+    labor_info li = get_labor_info(labor_id);
+    float sign = active ? 1.0f : -1.0f;
+    foreach(Dwarf *d, DT->get_dwarves()){
+        QHash<int,int>::const_iterator row = m_unit_rows.constFind(d->id());
+        if(row == m_unit_rows.constEnd()){
+            //the population changed since the ratings were built
+            m_ratings_valid = false;
+            break;
+        }
+        add_labor_ratings(m_ratings[row.value()], d, li, sign);
+    }
+    if(li.skill_id >= 0)
+        m_skilled_count += (active ? 1 : -1);
+    if(m_skilled_count == 0){
+        //drop any rounding left over from the removed labors
+        for(unit_ratings &r : m_ratings){
+            r.skill = r.skill_rate = r.role = 0;
         }
     }
-    read_settings();
 }
 
 float MultiLabor::get_rating(int id, ML_RATING_TYPE type){
-    if(m_ratings.size() <= 0 && get_enabled_labors().size() > 0)
-        refresh();
-    if(m_ratings.contains(id)){
-        QList<float> ratings = m_ratings.value(id);
-        if(int(type) < 0 || int(type) > ratings.count()-1){
-            LOGW << "out of" << ratings.count() << "ratings, rating type" << (int)type << "could not be found!";
-            if(ratings.count() > 0)
-                return ratings.at(0);
-            else
-                return 0.0;
-        }else{
-            return ratings.at(type);
-        }
-    }else{
+    if(m_active_labors.isEmpty())
+        return 0.0;
+    if(!m_ratings_valid)
+        build_ratings();
+
+    QHash<int,int>::const_iterator row = m_unit_rows.constFind(id);
+    if(row == m_unit_rows.constEnd())
+        return 0.0;
+
+    const unit_ratings &r = m_ratings[row.value()];
+    switch(type){
+    case ML_ROLE:
+        if(!m_role_name.isEmpty())
+            return r.named_role;
+        return m_skilled_count > 0 ? r.role / m_skilled_count : r.role;
+    case ML_SKILL:
+        return m_skilled_count > 0 ? r.skill / m_skilled_count : -1;
+    case ML_SKILL_RATE:
+        return m_skilled_count > 0 ? r.skill_rate / m_skilled_count : 0;
+    case ML_ACTIVE:
+        return r.active_labors.isEmpty() ? 0 : 1000;
+    default:
+        LOGW << "rating type" << (int)type << "could not be found!";
         return 0.0;
     }
 }
@@ -5,6 +5,7 @@
 #include <QVector>
 #include <QHash>
 #include <QColor>
+#include <vector>
 
 class Dwarf;
 class GameDataReader;
@@ -65,6 +66,8 @@ public slots:
     void remove_labor(int labor_id) {set_labor(labor_id, false);}
     void labor_item_check_changed(QListWidgetItem *item);
     virtual void refresh();
+    //! update only the role part of the ratings
+    void refresh_roles();
 
     virtual void accept();
     virtual void cancel();
@@ -91,7 +94,7 @@ protected:
     void set_labor(int labor_id, bool active);
     QDialog *m_dialog;
     int m_selected_count;
-    QHash<int,QList<float> > m_ratings;
+    void clear_labors();
     QHash<int,QString> m_labor_desc;
     QList<QVariant> m_qvariant_labors;
     QColor m_active_labor_col;
@@ -101,6 +104,34 @@ protected:
     virtual void update_dwarf(){}
 
     bool m_internal_change_flag;
+
+private:
+    //! running totals over the enabled labors, averaged when read
+    struct unit_ratings {
+        double skill;
+        double skill_rate;
+        double role; //!< sum of the first role of each skilled labor
+        double named_role; //!< rating of m_role_name
+        QVector<int> active_labors; //!< enabled labors which were also enabled on the unit when counted
+    };
+    struct labor_info {
+        int labor_id;
+        int skill_id;
+        QString role_name; //!< first role using the labor's skill, if any
+    };
+
+    //! one entry per unit, in the order of DT->get_dwarves()
+    std::vector<unit_ratings> m_ratings;
+    QHash<int,int> m_unit_rows;
+    int m_skilled_count;
+    bool m_ratings_valid;
+
+    void update_role();
+    void update_labor_desc();
+    labor_info get_labor_info(int labor_id);
+    void add_labor_ratings(unit_ratings &r, Dwarf *d, const labor_info &li, float sign);
+    void build_ratings();
+    void apply_labor(int labor_id, bool active);
 };
 
 #endif //  MULTILABOR_H
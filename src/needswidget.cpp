@@ -28,6 +28,7 @@ THE SOFTWARE.
 
 #include "dfinstance.h"
 #include "dwarf.h"
+#include "dwarftherapist.h"
 #include "gamedatareader.h"
 #include "histfigure.h"
 #include "standardpaths.h"
@@ -42,6 +43,135 @@ enum NeedsWidgetRole
     DegreeRole,
 };
 
+NeedsModel::NeedsModel(QObject *parent)
+    : StatsTreeModel({tr("Need"), tr("Count")}, parent)
+{
+}
+
+void NeedsModel::refresh(DFInstance *df)
+{
+    m_needs.clear();
+    std::vector<group_layout> layout;
+    if (df) {
+        auto gdr = GameDataReader::ptr();
+        QStringList degrees;
+        for (int i = 0; i < UnitNeed::DEGREE_COUNT; ++i)
+            degrees.append(QString::number(i));
+
+        for (const auto &p: df->get_needs_data().needs) {
+            need_row row;
+            row.need_id = std::get<0>(p.first);
+            row.deity_id = std::get<1>(p.first);
+            row.name = gdr->get_need_name(row.need_id);
+            if (row.deity_id != -1) {
+                row.deity_name = HistFigure::get_name(df, row.deity_id, true);
+                row.name.append(tr(" to %1").arg(row.deity_name));
+            }
+            // keep ids only, the units are deleted by the next read
+            for (const auto &dwarves: p.second.dwarves) {
+                QList<int> ids;
+                for (auto d: dwarves)
+                    ids.append(d->id());
+                row.unit_ids.push_back(ids);
+            }
+
+            QString key = QString("%1/%2").arg(row.need_id).arg(row.deity_id);
+            m_needs.insert(key, row);
+            layout.push_back(group_layout{key, degrees});
+        }
+    }
+    set_layout(layout);
+}
+
+QVariant NeedsModel::group_data(const QString &group, int column, int role) const
+{
+    auto it = m_needs.find(group);
+    if (it == m_needs.end())
+        return QVariant();
+    const need_row &row = *it;
+
+    if (column == 0) {
+        switch (role) {
+        case Qt::DisplayRole:
+        case Qt::ToolTipRole:
+        case SortRole:
+            return row.name;
+        case NeedRole:
+            return row.need_id;
+        case DeityRole:
+            return row.deity_id;
+        }
+    }
+    else {
+        int total_count = 0;
+        QStringList degree_counts;
+        QVariantList degree_values;
+        for (int i = 0; i < UnitNeed::DEGREE_COUNT; ++i) {
+            int count = row.unit_ids[i].size();
+            total_count += count;
+            degree_counts.append(QString("<font color=\"%1\">%2</font>")
+                    .arg(UnitNeed::degree_color(i, true).name())
+                    .arg(count));
+            degree_values.append(count);
+        }
+        switch (role) {
+        case Qt::DisplayRole:
+            return QString::number(total_count);
+        case SortRole:
+            return total_count;
+        case ListRole:
+            return degree_values;
+        case Qt::ToolTipRole:
+            return degree_counts.join("/");
+        }
+    }
+    return QVariant();
+}
+
+QVariant NeedsModel::child_data(const QString &group, const QString &child, int column, int role) const
+{
+    auto it = m_needs.find(group);
+    if (it == m_needs.end())
+        return QVariant();
+    const need_row &row = *it;
+    int degree = child.toInt();
+    const auto &ids = row.unit_ids[degree];
+    QColor color = UnitNeed::degree_color(degree);
+
+    switch (role) {
+    case Qt::DisplayRole:
+        if (column == 0)
+            return UnitNeed::degree_adjective(degree);
+        else
+            return QString::number(ids.size());
+    case Qt::ToolTipRole:
+        // only resolve the names when they're shown
+        return tr("<h4><font color=\"%1\">%2 dwarves are %3 after %4:</font></h4> <p>%5</p>", "", ids.size())
+                .arg(color.name())
+                .arg(ids.size())
+                .arg(UnitNeed::degree_adjective(degree))
+                .arg(GameDataReader::ptr()->get_need_desc(row.need_id, degree <= UnitNeed::NOT_DISTRACTED, row.deity_name))
+                .arg(DT->get_unit_names(ids).join(", "));
+    case Qt::TextColorRole:
+        return color;
+    case SortRole:
+        return column == 0 ? degree : ids.size();
+    case NeedRole:
+        if (column == 0)
+            return row.need_id;
+        break;
+    case DeityRole:
+        if (column == 0)
+            return row.deity_id;
+        break;
+    case DegreeRole:
+        if (column == 0)
+            return degree;
+        break;
+    }
+    return QVariant();
+}
+
 NeedsWidget::NeedsWidget(QWidget *parent)
     : QWidget(parent)
     , ui(std::make_unique<Ui::NeedsWidget>())
@@ -64,8 +194,6 @@ NeedsWidget::NeedsWidget(QWidget *parent)
             this, SLOT(focus_selection_changed()));
 
     // Needs setup
-    m_needs_model.setHorizontalHeaderLabels({tr("Need"), tr("Count")});
-
     QList<QColor> needs_colors;
     for (int i = 0; i < UnitNeed::DEGREE_COUNT; ++i)
         needs_colors.append(UnitNeed::degree_color(i, false, true));
@@ -108,19 +236,20 @@ void NeedsWidget::save_state(QSettings &settings) const
 void NeedsWidget::clear()
 {
     m_focus_model.removeRows(0, m_focus_model.rowCount());
-    m_needs_model.removeRows(0, m_needs_model.rowCount());
+    m_needs_model.clear();
 }
 
 void NeedsWidget::refresh()
 {
-    clear();
+    m_focus_model.removeRows(0, m_focus_model.rowCount());
     if (!DT)
         return;
     auto df = DT->get_DFInstance();
-    if (!df)
+    if (!df) {
+        m_needs_model.clear();
         return;
+    }
 
-    auto gdr = GameDataReader::ptr();
     const auto &data = df->get_needs_data();
     // All items except top level "overall focus" use these flags.
     auto flags = Qt::ItemIsSelectable | Qt::ItemIsEnabled;
@@ -167,79 +296,7 @@ void NeedsWidget::refresh()
 
     m_focus_model.appendRow({overall_focus_name, overall_focus_count});
 
-    // Need model
-    for (const auto &p: data.needs) {
-        int need_id = std::get<0>(p.first);
-        int deity_id = std::get<1>(p.first);
-
-        auto need_name = new QStandardItem;
-        QString name = gdr->get_need_name(need_id);
-        QString deity_name;
-        if (deity_id != -1) {
-            deity_name = HistFigure::get_name(df, deity_id, true);
-            name.append(tr(" to %1").arg(deity_name));
-        }
-        need_name->setText(name);
-        need_name->setToolTip(name);
-        need_name->setData(name, SortRole);
-        need_name->setData(need_id, NeedRole);
-        need_name->setData(deity_id, DeityRole);
-        need_name->setFlags(flags);
-
-        int total_count = 0;
-        QStringList degree_counts;
-        QVariantList degree_values;
-        for (int i = 0; i < UnitNeed::DEGREE_COUNT; ++i) {
-            const auto &dwarves = p.second.dwarves[i];
-            QColor color = UnitNeed::degree_color(i);
-
-            QStringList dwarve_names;
-            for (auto d: dwarves)
-                dwarve_names.append(d->nice_name());
-
-            auto desc = tr("<h4><font color=\"%1\">%2 dwarves are %3 after %4:</font></h4> <p>%5</p>", "", dwarves.size())
-                    .arg(color.name())
-                    .arg(dwarves.size())
-                    .arg(UnitNeed::degree_adjective(i))
-
-                    .arg(gdr->get_need_desc(need_id, i <= UnitNeed::NOT_DISTRACTED, deity_name))
-                    .arg(dwarve_names.join(", "));
-
-            auto need_degree_name = new QStandardItem;
-            need_degree_name->setText(UnitNeed::degree_adjective(i));
-            need_degree_name->setToolTip(desc);
-            need_degree_name->setData(i, SortRole);
-            need_degree_name->setData(color, Qt::TextColorRole);
-            need_degree_name->setData(need_id, NeedRole);
-            need_degree_name->setData(deity_id, DeityRole);
-            need_degree_name->setData(i, DegreeRole);
-            need_degree_name->setFlags(flags);
-
-            auto need_degree_count = new QStandardItem;
-            need_degree_count->setText(QString::number(dwarves.size()));
-            need_degree_count->setToolTip(desc);
-            need_degree_count->setData((int)dwarves.size(), SortRole);
-            need_degree_count->setData(color, Qt::TextColorRole);
-            need_degree_count->setFlags(flags);
-
-            need_name->appendRow({need_degree_name, need_degree_count});
-
-            total_count += dwarves.size();
-            degree_counts.append(QString("<font color=\"%1\">%2</font>")
-                    .arg(UnitNeed::degree_color(i, true).name())
-                    .arg(dwarves.size()));
-            degree_values.append((int)dwarves.size());
-        }
-
-        auto need_count = new QStandardItem;
-        need_count->setText(QString::number(total_count));
-        need_count->setData(total_count, SortRole);
-        need_count->setData(degree_values, ListRole);
-        need_count->setToolTip(degree_counts.join("/"));
-        need_count->setFlags(flags);
-
-        m_needs_model.appendRow({need_name, need_count});
-    }
+    m_needs_model.refresh(df);
 }
 
 void NeedsWidget::focus_selection_changed()
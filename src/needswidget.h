@@ -27,13 +27,41 @@ THE SOFTWARE.
 #include <QStyledItemDelegate>
 
 #include <memory>
+#include <vector>
+
+#include "statstreemodel.h"
 
 class QSettings;
+class DFInstance;
 
 namespace Ui { class NeedsWidget; }
 
 class NeedsDelegate;
 
+class NeedsModel: public StatsTreeModel
+{
+    Q_OBJECT
+public:
+    NeedsModel(QObject *parent = nullptr);
+
+    void refresh(DFInstance *df);
+
+protected:
+    QVariant group_data(const QString &group, int column, int role) const override;
+    QVariant child_data(const QString &group, const QString &child, int column, int role) const override;
+
+private:
+    struct need_row
+    {
+        int need_id;
+        int deity_id;
+        QString name;
+        QString deity_name;
+        std::vector<QList<int>> unit_ids; // per focus degree
+    };
+    QHash<QString, need_row> m_needs;
+};
+
 class NeedsWidget: public QWidget
 {
     Q_OBJECT
@@ -60,7 +88,7 @@ private:
     std::unique_ptr<NeedsDelegate> m_focus_delegate;
     std::unique_ptr<NeedsDelegate> m_needs_delegate;
     QStandardItemModel m_focus_model;
-    QStandardItemModel m_needs_model;
+    NeedsModel m_needs_model;
 };
 
 class NeedsDelegate: public QStyledItemDelegate
@@ -244,6 +244,12 @@ void OptionsMenu::tooltip_thoughts_toggled(bool checked){
     ui->cb_thought_time->setEnabled(checked);
 }
 
+void OptionsMenu::write_default_settings() {
+    //the widgets hold the defaults, a hidden menu reads what's set and writes everything back
+    OptionsMenu defaults;
+    defaults.write_settings();
+}
+
 void OptionsMenu::read_settings() {
     int idx;
 
@@ -316,6 +322,7 @@ void OptionsMenu::read_settings() {
 
     ui->cb_read_dwarves_on_startup->setChecked(s->value("read_on_startup", true).toBool());
     ui->cb_auto_connect->setChecked(s->value("auto_connect",false).toBool());
+    ui->cb_auto_refresh->setChecked(s->value("auto_refresh",false).toBool());
     ui->cb_auto_contrast->setChecked(s->value("auto_contrast", true).toBool());
     ui->cb_show_aggregates->setChecked(s->value("show_aggregates", true).toBool());
     ui->cb_single_click_labor_changes->setChecked(s->value("single_click_labor_changes", true).toBool());
@@ -458,6 +465,7 @@ void OptionsMenu::write_settings() {
 
         s->setValue("read_on_startup", ui->cb_read_dwarves_on_startup->isChecked());
         s->setValue("auto_connect",ui->cb_auto_connect->isChecked());
+        s->setValue("auto_refresh",ui->cb_auto_refresh->isChecked());
         s->setValue("auto_contrast", ui->cb_auto_contrast->isChecked());
         s->setValue("show_aggregates", ui->cb_show_aggregates->isChecked());
         s->setValue("single_click_labor_changes", ui->cb_single_click_labor_changes->isChecked());
@@ -597,6 +605,7 @@ void OptionsMenu::restore_defaults() {
 
     ui->cb_read_dwarves_on_startup->setChecked(true);
     ui->cb_auto_connect->setChecked(false);
+    ui->cb_auto_refresh->setChecked(false);
     ui->cb_auto_contrast->setChecked(true);
     ui->cb_show_aggregates->setChecked(true);
     ui->cb_single_click_labor_changes->setChecked(false);
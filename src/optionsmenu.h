@@ -42,6 +42,8 @@ public:
 
     void read_settings();
     void write_settings();
+    //! fill in every missing setting with the menu's defaults, for runs without an options menu (headless)
+    static void write_default_settings();
 
     bool event(QEvent *evt);
     void showEvent(QShowEvent *evt);
@@ -26,6 +26,7 @@ THE SOFTWARE.
 #include <QCoreApplication>
 #include "global_enums.h"
 #include "flagarray.h"
+#include "generationarena.h"
 
 class Dwarf;
 class ItemSubtype;
@@ -36,6 +37,7 @@ class Material;
 class Preference {
     Q_DECLARE_TR_FUNCTIONS(Preference)
 public:
+    GENERATION_ALLOCATED
 
     static const QString get_pref_desc(const PREF_TYPES &type) {
         switch (type) {
@@ -24,33 +24,103 @@ THE SOFTWARE.
 #include "dwarftherapist.h"
 #include "dfinstance.h"
 #include "standardpaths.h"
+#include "utils.h"
 
 #include <QCloseEvent>
 #include <QHeaderView>
 #include <QLabel>
 #include <QLineEdit>
 #include <QPushButton>
-#include <QTableWidget>
+#include <QRegExp>
+#include <QSortFilterProxyModel>
+#include <QTableView>
 #include <QVBoxLayout>
 
+PreferencesModel::PreferencesModel(QObject *parent)
+    : StatsTreeModel(QStringList() << "Name" << "+" << "-" << "Type", parent)
+{
+}
+
+void PreferencesModel::refresh(DFInstance *df){
+    m_prefs.clear();
+    std::vector<group_layout> layout;
+    if(df){
+        QHash<QPair<QString,QString>,DFInstance::pref_stat> prefs = df->get_preference_stats();
+        layout.reserve(prefs.size());
+        for(auto it = prefs.constBegin(); it != prefs.constEnd(); ++it){
+            QString key = it.key().first + QChar('\n') + it.key().second;
+            m_prefs.insert(key, pref_row{it.value().pref_category, it.key().second, it.value().likes, it.value().dislikes});
+            layout.push_back(group_layout{key, QStringList()});
+        }
+    }
+    set_layout(layout);
+}
+
+QPair<QString,QString> PreferencesModel::get_preference(const QModelIndex &index) const{
+    auto it = m_prefs.find(group_key(index));
+    if(it == m_prefs.end())
+        return QPair<QString,QString>();
+    return qMakePair(it->category, it->name.toLower());
+}
+
+QVariant PreferencesModel::group_data(const QString &group, int column, int role) const{
+    auto it = m_prefs.find(group);
+    if(it == m_prefs.end())
+        return QVariant();
+    const pref_row &pref = *it;
+
+    switch(column){
+    case 0:
+        if(role == Qt::DisplayRole || role == Qt::ToolTipRole || role == SortRole)
+            return capitalize(pref.name);
+        if(role == FilterRole)
+            return QString("%1\n%2").arg(pref.name).arg(pref.category);
+        break;
+    case 1:
+    case 2:
+    {
+        const QList<int> &ids = (column == 1 ? pref.likes : pref.dislikes);
+        if(role == Qt::DisplayRole || role == SortRole)
+            return ids.size();
+        if(role == Qt::TextAlignmentRole)
+            return Qt::AlignCenter;
+        if(role == Qt::ToolTipRole) //only resolve the names when they're shown
+            return DT->get_unit_names(ids).join("<br>");
+        break;
+    }
+    case 3:
+        if(role == Qt::DisplayRole || role == Qt::ToolTipRole || role == SortRole)
+            return pref.category;
+        break;
+    }
+    return QVariant();
+}
+
 PreferencesWidget::PreferencesWidget(QWidget *parent)
     : QWidget(parent)
+    , m_model(new PreferencesModel(this))
+    , m_proxy(new QSortFilterProxyModel(this))
 {
     QVBoxLayout *l = new QVBoxLayout();
     setLayout(l);
 
+    m_proxy->setSourceModel(m_model);
+    m_proxy->setSortRole(PreferencesModel::SortRole);
+    m_proxy->setFilterKeyColumn(0);
+    m_proxy->setFilterRole(PreferencesModel::FilterRole);
+
     // PREFERENCES TABLE
-    tw_prefs = new QTableWidget(this);
-    tw_prefs->setColumnCount(4);
-    tw_prefs->setEditTriggers(QTableWidget::NoEditTriggers);
+    tw_prefs = new QTableView(this);
+    tw_prefs->setModel(m_proxy);
+    tw_prefs->setEditTriggers(QTableView::NoEditTriggers);
     tw_prefs->setWordWrap(true);
     tw_prefs->setShowGrid(false);
     tw_prefs->setGridStyle(Qt::NoPen);
     tw_prefs->setAlternatingRowColors(true);
     tw_prefs->setSelectionMode(QAbstractItemView::ExtendedSelection);
     tw_prefs->setSelectionBehavior(QAbstractItemView::SelectRows);
-    tw_prefs->setHorizontalHeaderLabels(QStringList() << "Name" << "+" << "-" << "Type");
     tw_prefs->verticalHeader()->hide();
+    tw_prefs->verticalHeader()->setDefaultSectionSize(18);
     tw_prefs->horizontalHeader()->setSectionResizeMode(0, QHeaderView::Interactive);
     tw_prefs->horizontalHeader()->setSectionResizeMode(1, QHeaderView::Interactive);
     tw_prefs->horizontalHeader()->setSectionResizeMode(2, QHeaderView::Interactive);
@@ -58,6 +128,8 @@ PreferencesWidget::PreferencesWidget(QWidget *parent)
     tw_prefs->horizontalHeader()->setDefaultSectionSize(75);
     tw_prefs->horizontalHeader()->resizeSection(1,40);
     tw_prefs->horizontalHeader()->resizeSection(2,40);
+    tw_prefs->setSortingEnabled(true);
+    tw_prefs->sortByColumn(1, Qt::DescendingOrder);
 
     auto settings = StandardPaths::settings();
     auto header_state = settings->value("preferences_widget/header").toByteArray();
@@ -79,7 +151,7 @@ PreferencesWidget::PreferencesWidget(QWidget *parent)
     l->addWidget(tw_prefs);
     l->addWidget(btn);
 
-    connect(tw_prefs,SIGNAL(itemSelectionChanged()),this,SLOT(selection_changed()));
+    connect(tw_prefs->selectionModel(),SIGNAL(selectionChanged(QItemSelection,QItemSelection)),this,SLOT(selection_changed()));
     connect(btn, SIGNAL(clicked()),this,SLOT(clear_filter()));
     connect(le_search, SIGNAL(textChanged(QString)),this, SLOT(search_changed(QString)));
     connect(btn_clear_search, SIGNAL(clicked()),this,SLOT(clear_search()));
@@ -94,89 +166,25 @@ void PreferencesWidget::save_state(QSettings &settings) const
 }
 
 void PreferencesWidget::clear(){
-    for(int r = tw_prefs->rowCount(); r >=0; r--){
-        tw_prefs->removeRow(r);
-    }
-    tw_prefs->clearContents();
+    m_model->clear();
 }
 
 void PreferencesWidget::refresh(){
-    clear();
-
-    if(DT && DT->get_DFInstance()){
-        QHash<QPair<QString,QString>,DFInstance::pref_stat* > prefs = DT->get_DFInstance()->get_preference_stats();
-
-        tw_prefs->setSortingEnabled(false);
-        QPair<QString,QString> key_pair;
-        foreach(key_pair, prefs.uniqueKeys()){
-                DFInstance::pref_stat *pref = prefs.value(key_pair);
-                tw_prefs->insertRow(0);
-                tw_prefs->setRowHeight(0, 18);
-
-                QTableWidgetItem *pref_name = new QTableWidgetItem();
-                pref_name->setText(capitalize(key_pair.second));
-                pref_name->setToolTip(pref_name->text());
-
-                QTableWidgetItem *pref_likes = new QTableWidgetItem();
-                pref_likes->setData(Qt::DisplayRole, pref->names_likes.size());
-                pref_likes->setTextAlignment(Qt::AlignCenter);
-                pref->names_likes.sort();
-                pref_likes->setToolTip(pref->names_likes.join("<br>"));
-
-                QTableWidgetItem *pref_dislikes = new QTableWidgetItem();
-                pref_dislikes->setData(Qt::DisplayRole, pref->names_dislikes.size());
-                pref_dislikes->setTextAlignment(Qt::AlignCenter);
-                pref->names_dislikes.sort();
-                pref_dislikes->setToolTip(pref->names_dislikes.join("<br>"));
-
-                QTableWidgetItem *pref_type = new QTableWidgetItem();
-                pref_type->setText(pref->pref_category);
-                pref_type->setToolTip(pref->pref_category);
-
-                tw_prefs->setItem(0, 0, pref_name);
-                tw_prefs->setItem(0, 1, pref_likes);
-                tw_prefs->setItem(0, 2, pref_dislikes);
-                tw_prefs->setItem(0, 3, pref_type);
-            }
-        tw_prefs->setSortingEnabled(true);
-        tw_prefs->sortItems(1, Qt::DescendingOrder);
-        filter();
-    }
+    m_model->refresh(DT ? DT->get_DFInstance() : nullptr);
 }
 
 void PreferencesWidget::selection_changed(){
     //pairs of category and preference
     QList<QPair<QString,QString> > values;
-    QModelIndexList indexList = tw_prefs->selectionModel()->selectedIndexes();
-    if(indexList.count() > 0){
-
-        int row = 0;
-        int prev_row=-1;
-        foreach (QModelIndex index, indexList) {
-            row = index.row();
-            if(row != prev_row){
-                values.append(qMakePair(tw_prefs->item(row,3)->text(),tw_prefs->item(row,0)->text().toLower()));
-            }
-            prev_row = row;
-        }
+    foreach(QModelIndex index, tw_prefs->selectionModel()->selectedRows()){
+        values.append(m_model->get_preference(m_proxy->mapToSource(index)));
     }
     emit item_selected(values);
 }
 
 void PreferencesWidget::search_changed(QString val){
     val = "(" + val.replace(" ", "|") + ")";
-    m_filter = QRegExp(val,Qt::CaseInsensitive, QRegExp::RegExp);
-    filter();
-}
-
-void PreferencesWidget::filter(){
-    for(int i = 0; i < tw_prefs->rowCount(); i++){
-        if(m_filter.isEmpty() || tw_prefs->item(i,0)->text().contains(m_filter) || tw_prefs->item(i,3)->text().contains(m_filter)){
-            tw_prefs->setRowHidden(i,false);
-        }else{
-            tw_prefs->setRowHidden(i,true);
-        }
-    }
+    m_proxy->setFilterRegExp(QRegExp(val,Qt::CaseInsensitive, QRegExp::RegExp));
 }
 
 void PreferencesWidget::clear_filter(){
@@ -24,26 +24,54 @@ THE SOFTWARE.
 #define PREFERENCES_WIDGET_H
 
 #include <QWidget>
+#include <QHash>
 
-#include <QRegExp>
+#include "statstreemodel.h"
 
-class QTableWidget;
+class QTableView;
 class QSettings;
+class QSortFilterProxyModel;
+class DFInstance;
+
+class PreferencesModel: public StatsTreeModel {
+    Q_OBJECT
+public:
+    PreferencesModel(QObject *parent = nullptr);
+
+    void refresh(DFInstance *df);
+    // category and (lower case) preference of the row
+    QPair<QString,QString> get_preference(const QModelIndex &index) const;
+
+    static constexpr auto SortRole = Qt::UserRole+0;
+    // name and type of the row, the only columns the search matches
+    static constexpr auto FilterRole = Qt::UserRole+1;
+
+protected:
+    QVariant group_data(const QString &group, int column, int role) const override;
+
+private:
+    struct pref_row {
+        QString category;
+        QString name;
+        QList<int> likes;
+        QList<int> dislikes;
+    };
+    QHash<QString, pref_row> m_prefs;
+};
 
 class PreferencesWidget : public QWidget {
     Q_OBJECT
 public:
     PreferencesWidget(QWidget *parent = nullptr);
 
-    void filter();
     void save_state(QSettings &) const;
 
 protected:
-    QTableWidget *tw_prefs;
-    QRegExp m_filter;
+    QTableView *tw_prefs;
+    PreferencesModel *m_model;
+    QSortFilterProxyModel *m_proxy;
 
 public slots:
-    //void cell_clicked(int r,int c);
     void clear_filter();
     void clear_search();
     void search_changed(QString);
@@ -60,4 +88,3 @@ private:
 };
 
 #endif // PREFERENCES_DOCK_H
-
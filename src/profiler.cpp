@@ -0,0 +1,110 @@
+/*
+Dwarf Therapist
+Copyright (c) 2009 Trey Stout (chmod)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+#include "profiler.h"
+#include "truncatingfilelogger.h"
+
+#include <QCoreApplication>
+#include <QFile>
+#include <QTextStream>
+
+Profiler *Profiler::ptr() {
+    static Profiler instance;
+    return &instance;
+}
+
+Profiler::Profiler()
+    : m_enabled(false)
+    , m_dropped(0)
+{
+    m_clock.start();
+}
+
+void Profiler::set_enabled(bool enabled) {
+    m_enabled.store(enabled, std::memory_order_relaxed);
+    LOGI << "performance tracing" << (enabled ? "enabled" : "disabled");
+}
+
+void Profiler::clear() {
+    QMutexLocker locker(&m_mutex);
+    m_spans.clear();
+    m_dropped = 0;
+}
+
+int Profiler::span_count() {
+    QMutexLocker locker(&m_mutex);
+    return m_spans.size();
+}
+
+int Profiler::current_thread_id() {
+    // small sequential ids read better in the trace viewer than native handles
+    static std::atomic_int next_id(1);
+    thread_local int id = next_id.fetch_add(1);
+    return id;
+}
+
+void Profiler::record(const char *name, const char *category, qint64 start_us, qint64 duration_us) {
+    span s = {name, category, start_us, duration_us, current_thread_id()};
+    QMutexLocker locker(&m_mutex);
+    if (m_spans.size() >= MAX_SPANS) {
+        m_dropped++;
+        return;
+    }
+    m_spans.append(s);
+}
+
+bool Profiler::write_chrome_trace(const QString &path) {
+    QVector<span> spans;
+    int dropped;
+    {
+        QMutexLocker locker(&m_mutex);
+        spans = m_spans;
+        dropped = m_dropped;
+    }
+
+    QFile f(path);
+    if (!f.open(QIODevice::WriteOnly | QIODevice::Text | QIODevice::Truncate)) {
+        LOGE << "failed to open trace file" << path << f.errorString();
+        return false;
+    }
+
+    // written by hand rather than through QJsonDocument, traces with paint spans get large
+    QTextStream out(&f);
+    qint64 pid = QCoreApplication::applicationPid();
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    bool first = true;
+    foreach(const span &s, spans) {
+        if (!first)
+            out << ",";
+        first = false;
+        out << "\n{\"name\":\"" << s.name << "\",\"cat\":\"" << s.category
+            << "\",\"ph\":\"X\",\"ts\":" << s.start_us << ",\"dur\":" << s.duration_us
+            << ",\"pid\":" << pid << ",\"tid\":" << s.thread_id << "}";
+    }
+    out << "\n]}\n";
+    f.close();
+
+    LOGI << "wrote" << spans.size() << "trace spans to" << path;
+    if (dropped > 0)
+        LOGW << dropped << "trace spans were dropped after reaching the buffer limit";
+    return true;
+}
@@ -0,0 +1,106 @@
+/*
+Dwarf Therapist
+Copyright (c) 2009 Trey Stout (chmod)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <QElapsedTimer>
+#include <QMutex>
+#include <QString>
+#include <QVector>
+#include <atomic>
+
+/*! Collects timed spans of the major load/refresh/paint phases into an in-memory
+  buffer which can be exported in the Chrome trace_event format (chrome://tracing
+  or https://ui.perfetto.dev). Recording is off by default and costs a single
+  atomic load per scope while disabled.
+  */
+class Profiler {
+public:
+    struct span {
+        const char *name;
+        const char *category;
+        qint64 start_us;
+        qint64 duration_us;
+        int thread_id;
+    };
+
+    static Profiler *ptr();
+
+    bool enabled() const {return m_enabled.load(std::memory_order_relaxed);}
+    void set_enabled(bool enabled);
+    void clear();
+    int span_count();
+
+    //! microseconds since the profiler was created
+    qint64 now_us() const {return m_clock.nsecsElapsed() / 1000;}
+    void record(const char *name, const char *category, qint64 start_us, qint64 duration_us);
+
+    bool write_chrome_trace(const QString &path);
+
+    //! spans beyond this are dropped, painting can produce a lot of them
+    static const int MAX_SPANS = 2000000;
+
+private:
+    Profiler();
+    Q_DISABLE_COPY(Profiler)
+
+    static int current_thread_id();
+
+    std::atomic_bool m_enabled;
+    QElapsedTimer m_clock;
+    QMutex m_mutex;
+    QVector<span> m_spans;
+    int m_dropped;
+};
+
+//! RAII timer, records a span from construction to destruction when profiling is enabled
+class ProfileScope {
+public:
+    explicit ProfileScope(const char *name, const char *category = "dt")
+        : m_name(name)
+        , m_category(category)
+        , m_start(-1)
+    {
+        if (Profiler::ptr()->enabled())
+            m_start = Profiler::ptr()->now_us();
+    }
+    ~ProfileScope() {
+        if (m_start >= 0) {
+            Profiler *p = Profiler::ptr();
+            p->record(m_name, m_category, m_start, p->now_us() - m_start);
+        }
+    }
+private:
+    const char *m_name;
+    const char *m_category;
+    qint64 m_start;
+    Q_DISABLE_COPY(ProfileScope)
+};
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+//! time the remainder of the enclosing scope, name must be a string literal
+#define PROFILE_SCOPE(name) ProfileScope PROFILE_CONCAT(_profile_scope_, __LINE__)(name)
+#define PROFILE_SCOPE_CAT(name, category) ProfileScope PROFILE_CONCAT(_profile_scope_, __LINE__)(name, category)
+
+#endif // PROFILER_H
@@ -124,7 +124,7 @@ QStandardItem *RoleColumn::build_cell(Dwarf *d) {
 
         float alpha = 0;
         if(!m_role->prefs.empty()){
-            alpha = d->get_role_pref_matches(m_role->name()).count() / static_cast<float>(m_role->prefs.size()) * 150;
+            alpha = d->role_pref_match_count(m_role->name()) / static_cast<float>(m_role->prefs.size()) * 150;
         }
         item->setData(alpha,DwarfModel::DR_SPECIAL_FLAG);
 
@@ -28,6 +28,7 @@ THE SOFTWARE.
 #include <QMenu>
 #include <QMessageBox>
 #include <QStatusTipEvent>
+#include <algorithm>
 
 #include "adaptivecolorfactory.h"
 #include "dwarf.h"
@@ -36,6 +37,7 @@ THE SOFTWARE.
 #include "role.h"
 #include "rolemodel.h"
 #include "rolepreferencemodel.h"
+#include "rolepreview.h"
 #include "standardpaths.h"
 #include "trait.h"
 #include "viewmanager.h"
@@ -109,8 +111,14 @@ RoleDialog::RoleDialog(RolePreferenceModel *pref_model, QWidget *parent)
     , m_goal_proxy(AspectFilter<int>{m_role, &Role::goals})
     , m_need_proxy(AspectFilter<int>{m_role, &Role::needs})
     , m_model(std::make_unique<RoleModel>())
+    , m_preview(std::make_unique<RolePreview>())
 {
     ui->setupUi(this);
+
+    m_preview_timer.setSingleShot(true);
+    m_preview_timer.setInterval(150);
+    connect(&m_preview_timer, &QTimer::timeout, this, &RoleDialog::update_role_preview);
+    connect(m_preview.get(), &RolePreview::ready, this, &RoleDialog::population_preview_ready);
     update_role_preview();
 
     // Setup aspects tree view
@@ -226,7 +234,17 @@ RoleDialog::RoleDialog(RolePreferenceModel *pref_model, QWidget *parent)
     connect(ui->btn_copy, &QAbstractButton::pressed,
             this, &RoleDialog::copy_role);
     connect(ui->btn_refresh_ratings, &QAbstractButton::pressed,
-            this, &RoleDialog::update_role_preview);
+            this, &RoleDialog::refresh_role_preview);
+
+    // preview the ratings again once edits settle
+    connect(m_model.get(), &QAbstractItemModel::dataChanged,
+            this, &RoleDialog::schedule_role_preview);
+    connect(m_model.get(), &QAbstractItemModel::rowsInserted,
+            this, &RoleDialog::schedule_role_preview);
+    connect(m_model.get(), &QAbstractItemModel::rowsRemoved,
+            this, &RoleDialog::schedule_role_preview);
+    connect(ui->te_script, &QTextEdit::textChanged,
+            this, &RoleDialog::schedule_role_preview);
 }
 
 RoleDialog::~RoleDialog()
@@ -276,8 +294,11 @@ bool RoleDialog::save_role()
     m_model->set_role(nullptr);
     role_changed();
 
+    m_saved_roles = QStringList(new_name);
     auto gdr = GameDataReader::ptr();
     if (m_old_role) {
+        if (m_old_role->name() != new_name)
+            m_saved_roles.append(m_old_role->name());
         gdr->get_roles().remove(m_old_role->name());
         m_old_role = nullptr;
     }
@@ -297,18 +318,18 @@ bool RoleDialog::event(QEvent *event)
 
 void RoleDialog::selection_changed()
 {
-    update_role_preview();
+    schedule_role_preview();
 }
 
 void RoleDialog::done(int r)
 {
     if (r == QDialog::Accepted) {
-        if (save_role())
-            QDialog::done(r);
-    }
-    else { // rejected
-        QDialog::done(r);
+        if (!save_role())
+            return;
     }
+    m_preview_timer.stop();
+    m_preview->cancel();
+    QDialog::done(r);
 }
 
 void RoleDialog::showEvent(QShowEvent *event)
@@ -316,6 +337,7 @@ void RoleDialog::showEvent(QShowEvent *event)
     QDialog::showEvent(event);
 
     m_pref_model->load_pref_from_raws(this);
+    m_preview->invalidate();
 
     // Fill copy combobox with roles
     ui->cmb_copy->clear();
@@ -459,30 +481,37 @@ void RoleDialog::copy_role()
         ui->le_role_name->setText(role_name);
 }
 
+void RoleDialog::schedule_role_preview()
+{
+    m_preview_timer.start();
+}
+
+void RoleDialog::refresh_role_preview()
+{
+    m_preview->invalidate();
+    update_role_preview();
+}
+
 void RoleDialog::update_role_preview()
 {
-    if (!m_role)
+    m_preview_timer.stop();
+    if (!m_role) {
+        m_preview->cancel();
+        ui->lbl_population->clear();
         return;
+    }
 
     QList<Dwarf*> dwarfs = DT->get_main_window()->get_view_manager()->get_selected_dwarfs();
     Dwarf *dwarf = nullptr;
     if(dwarfs.count() > 0)
         dwarf = dwarfs.at(0);
-    if (!dwarf) {
-        ui->lbl_name->setText("Select a dwarf to view ratings.");
-        ui->lbl_current->clear();
-        ui->lbl_new->clear();
-        return;
-    }
 
-    // Check script syntax
+    // Check script syntax, the selected dwarf's rating is the script's value
     QString script = ui->te_script->toPlainText().trimmed();
     m_role->script(script);
-    if(!script.isEmpty()){
-        QJSEngine m_engine;
-        QJSValue d_obj = m_engine.newQObject(dwarf);
-        m_engine.globalObject().setProperty("d", d_obj);
-        QJSValue ret = m_engine.evaluate(script);
+    double new_rating = 0;
+    if(!script.isEmpty() && dwarf){
+        QJSValue ret = m_preview->evaluate_script(script, dwarf);
         if(!ret.isNumber()){
             QString err_msg;
             if(ret.isError()) {
@@ -491,26 +520,76 @@ void RoleDialog::update_role_preview()
                         .arg(ret.property("message").toString())
                         .arg(ret.property("stack").toString().replace("\n", "<br/>"));
             }else{
-                m_engine.globalObject().setProperty("__internal_role_return_value_check", ret);
                 err_msg = tr("<font color=red>Script returned %1 instead of number</font>")
-                        .arg(m_engine.evaluate(QString("typeof __internal_role_return_value_check")).toString());
-                m_engine.globalObject().deleteProperty("__internal_role_return_value_check");
+                        .arg(ret.isUndefined() ? QString("undefined") : ret.isBool() ? QString("boolean")
+                             : ret.isString() ? QString("string") : ret.isCallable() ? QString("function") : QString("object"));
             }
             ui->te_script->setStatusTip(err_msg);
             ui->txt_status_tip->setText(err_msg);
+            m_preview->cancel();
             return;
         }else{
             ui->te_script->setStatusTip(ui->te_script->whatsThis());
+            new_rating = ret.toNumber();
         }
     }else{
         ui->te_script->setStatusTip(ui->te_script->whatsThis());
+        if(dwarf)
+            new_rating = dwarf->calc_role_rating(m_role.get());
+    }
+
+    if (!dwarf) {
+        ui->lbl_name->setText("Select a dwarf to view ratings.");
+        ui->lbl_current->clear();
+        ui->lbl_new->clear();
+    } else {
+        double old_rating = 0;
+        if(m_old_role){
+            QString old_script = m_old_role->script().trimmed();
+            old_rating = old_script.isEmpty() ? dwarf->calc_role_rating(m_old_role)
+                                              : m_preview->evaluate_script(old_script, dwarf).toNumber();
+        }
+        ui->lbl_name->setText(dwarf->nice_name());
+        ui->lbl_current->setText(tr("Current Raw Rating: %1%")
+                .arg(QString::number(old_rating,'g',4)));
+        ui->lbl_new->setText(tr("New Raw Rating: %1%")
+                .arg(QString::number(new_rating,'g',4)));
+    }
+
+    // rate the whole population in the background
+    m_preview->request(m_old_role, m_role.get());
+}
+
+void RoleDialog::population_preview_ready()
+{
+    const RolePreview::result &res = m_preview->last_result();
+    if (res.unit_count <= 0) {
+        ui->lbl_population->clear();
+        return;
+    }
+
+    // one bar per bin, scaled to the largest bin
+    static const QString bars = QString::fromUtf8("\u2581\u2582\u2583\u2584\u2585\u2586\u2587\u2588");
+    int max_bin = *std::max_element(res.histogram.constBegin(), res.histogram.constEnd());
+    QString histogram;
+    foreach(int count, res.histogram){
+        histogram.append(count <= 0 ? QString("&nbsp;") : QString(bars.at(qMin(bars.length() - 1, count * bars.length() / qMax(1, max_bin)))));
+    }
+
+    QString summary = tr("<b>%n unit(s)</b> median %1", "", res.unit_count).arg(QString::number(res.median,'g',4));
+    if (res.has_old)
+        summary.append(tr(" (was %1), %n changed rank", "", res.moved).arg(QString::number(res.old_median,'g',4)));
+
+    QStringList top;
+    foreach(const RolePreview::ranked_unit &u, res.top){
+        QString entry = tr("%1. %2 (%3)").arg(u.rank).arg(u.name.toHtmlEscaped()).arg(QString::number(u.rating,'g',4));
+        if (u.old_rank > 0 && u.old_rank != u.rank)
+            entry.append(QString(" %1%2").arg(u.old_rank > u.rank ? "+" : "-").arg(qAbs(u.old_rank - u.rank)));
+        top.append(entry);
     }
 
-    ui->lbl_name->setText(dwarf->nice_name());
-    ui->lbl_current->setText(tr("Current Raw Rating: %1%")
-            .arg(QString::number(m_old_role ? dwarf->calc_role_rating(m_old_role) : 0,'g',4)));
-    ui->lbl_new->setText(tr("New Raw Rating: %1%")
-            .arg(QString::number(m_role ? dwarf->calc_role_rating(m_role.get()) : 0,'g',4)));
+    ui->lbl_population->setText(QString("%1 <span style=\"font-family:monospace\">[%2]</span><br/>%3")
+                                .arg(summary).arg(histogram).arg(top.join(", ")));
 }
 
 void RoleDialog::role_changed()
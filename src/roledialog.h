@@ -28,6 +28,7 @@ THE SOFTWARE.
 #include <QSortFilterProxyModel>
 #include <QStandardItemModel>
 #include <QStyledItemDelegate>
+#include <QTimer>
 
 #include <functional>
 #include <memory>
@@ -36,6 +37,7 @@ class Dwarf;
 class Role;
 class RoleModel;
 class RolePreferenceModel;
+class RolePreview;
 
 namespace Ui { class RoleDialog; }
 
@@ -76,6 +78,8 @@ public:
     void new_role();
     void open_role(const QString &name);
     bool save_role(); // validate and save current role, return false if an error happened
+    //! names of the roles changed by the last save, the old name is included if the role was renamed
+    const QStringList &saved_roles() const {return m_saved_roles;}
 
     bool event(QEvent *event) override;
 
@@ -96,7 +100,10 @@ private slots:
     void preference_activated(const QModelIndex &);
     void aspect_tree_context_menu(const QPoint &);
     void copy_role();
+    void schedule_role_preview();
     void update_role_preview();
+    void refresh_role_preview();
+    void population_preview_ready();
     void role_changed();
 
     // autoconnect slots:
@@ -106,11 +113,14 @@ private:
     std::unique_ptr<Ui::RoleDialog> ui;
     std::unique_ptr<Role> m_role;
     Role *m_old_role;
+    QStringList m_saved_roles;
     RolePreferenceModel *m_pref_model;
     QStandardItemModel m_attribute_model, m_skill_model, m_facet_model, m_belief_model, m_goal_model, m_need_model;
     FunctionalFilterProxyModel m_attribute_proxy, m_skill_proxy, m_facet_proxy, m_belief_proxy, m_goal_proxy, m_need_proxy;
     std::unique_ptr<RoleModel> m_model;
     WeightDelegate m_weight_delegate;
+    std::unique_ptr<RolePreview> m_preview;
+    QTimer m_preview_timer; //waits for edits to settle before previewing
 };
 
 #endif
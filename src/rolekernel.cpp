@@ -0,0 +1,338 @@
+/*
+Dwarf Therapist
+Copyright (c) 2009 Trey Stout (chmod)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+#include "rolekernel.h"
+#include "role.h"
+#include "dwarf.h"
+#include "dwarfstats.h"
+#include "gamedatareader.h"
+#include "skill.h"
+#include "attribute.h"
+#include <QtConcurrent>
+
+static int aspect_id(const QString &attribute_name){
+    return GameDataReader::ptr()->get_attribute_type(attribute_name.toUpper());
+}
+static int aspect_id(int id){
+    return id;
+}
+
+static QVector<Role*> valid_roles(const QList<Role*> &roles){
+    QVector<Role*> valid;
+    foreach(Role *r, roles){
+        if(r)
+            valid.append(r);
+    }
+    return valid;
+}
+
+RoleKernel::RoleKernel(const QList<Role*> &roles)
+    : m_roles(valid_roles(roles))
+    , m_pref_index(m_roles)
+    , m_has_scripts(false)
+{
+    foreach(Role *r, m_roles){
+        compiled_role cr;
+        cr.scripted = !r->script().trimmed().isEmpty();
+        cr.has_skills = !r->skills.empty();
+        cr.has_prefs = !r->prefs.empty();
+        m_has_scripts |= cr.scripted;
+
+        float weights[AT_COUNT] = {
+            r->attributes_weight.weight(),
+            r->facets_weight.weight(),
+            r->beliefs_weight.weight(),
+            r->goals_weight.weight(),
+            r->needs_weight.weight(),
+            r->skills_weight.weight(),
+            r->prefs_weight.weight(),
+        };
+        float total = 0.0f;
+        for(int i = 0; i < AT_COUNT; i++)
+            total += weights[i];
+        cr.unweighted = (total == 0.0f);
+        for(int i = 0; i < AT_COUNT; i++)
+            cr.aspect_weight[i] = cr.unweighted ? 0.0f : weights[i] / total;
+
+        compile_aspect(cr, AT_ATTRIBUTE, r->attributes);
+        compile_aspect(cr, AT_FACET, r->facets);
+        compile_aspect(cr, AT_BELIEF, r->beliefs);
+        compile_aspect(cr, AT_GOAL, r->goals);
+        compile_aspect(cr, AT_NEED, r->needs);
+        compile_aspect(cr, AT_SKILL, r->skills);
+
+        m_compiled.append(cr);
+    }
+}
+
+template<typename T>
+void RoleKernel::compile_aspect(compiled_role &cr, ASPECT_TYPE type, const T &aspects){
+    QVector<int> &ids = m_ids[type];
+    float total_weight = 0.0f;
+    for(const auto &p : aspects)
+        total_weight += p.second.weight;
+
+    cr.begin[type] = m_terms.size();
+    for(const auto &p : aspects){
+        int id = aspect_id(p.first);
+        int slot = ids.indexOf(id);
+        if(slot < 0){
+            slot = ids.size();
+            ids.append(id);
+        }
+        term t;
+        t.slot = slot;
+        t.weight = total_weight > 0 ? p.second.weight / total_weight : 0.0f;
+        t.neg = p.second.is_neg;
+        m_terms.append(t);
+    }
+    cr.end[type] = m_terms.size();
+    cr.constant[type] = (total_weight <= 0);
+}
+
+void RoleKernel::load_values(Dwarf *d, QVector<double> *values, QVector<int> &skill_rates) const{
+    for(int i = 0; i < AT_VALUE_COUNT; i++)
+        values[i].resize(m_ids[i].size());
+
+    const QVector<int> &attributes = m_ids[AT_ATTRIBUTE];
+    for(int s = 0; s < attributes.size(); s++)
+        values[AT_ATTRIBUTE][s] = d->get_attribute(static_cast<ATTRIBUTES_TYPE>(attributes.at(s))).rating(true);
+
+    const QVector<int> &facets = m_ids[AT_FACET];
+    for(int s = 0; s < facets.size(); s++)
+        values[AT_FACET][s] = DwarfStats::facets.rating(d->trait(facets.at(s)));
+
+    const QVector<int> &beliefs = m_ids[AT_BELIEF];
+    for(int s = 0; s < beliefs.size(); s++)
+        values[AT_BELIEF][s] = DwarfStats::beliefs.rating(d->belief_value(beliefs.at(s)));
+
+    const QVector<int> &goals = m_ids[AT_GOAL];
+    for(int s = 0; s < goals.size(); s++)
+        values[AT_GOAL][s] = d->goals().value(goals.at(s), 1) <= 0 ? 1.0 : 0.0; // has goal and not realized
+
+    const QVector<int> &needs = m_ids[AT_NEED];
+    for(int s = 0; s < needs.size(); s++)
+        values[AT_NEED][s] = DwarfStats::needs.rating(d->get_need_type_level(needs.at(s)));
+
+    const QVector<int> &skills = m_ids[AT_SKILL];
+    skill_rates.resize(skills.size());
+    for(int s = 0; s < skills.size(); s++){
+        const Skill &sk = d->get_skill(skills.at(s));
+        values[AT_SKILL][s] = sk.get_rating();
+        skill_rates[s] = sk.skill_rate();
+    }
+}
+
+RoleKernel::unit_values RoleKernel::snapshot(Dwarf *d){
+    GameDataReader *gdr = GameDataReader::ptr();
+    unit_values s;
+
+    int attribute_count = 0;
+    foreach(ATTRIBUTES_TYPE id, gdr->get_attributes().keys())
+        attribute_count = qMax(attribute_count, static_cast<int>(id) + 1);
+    s.values[AT_ATTRIBUTE].resize(attribute_count);
+    foreach(ATTRIBUTES_TYPE id, gdr->get_attributes().keys())
+        s.values[AT_ATTRIBUTE][id] = d->get_attribute(id).rating(true);
+
+    s.values[AT_FACET].resize(gdr->get_total_trait_count());
+    for(int id = 0; id < s.values[AT_FACET].size(); id++)
+        s.values[AT_FACET][id] = DwarfStats::facets.rating(d->trait(id));
+
+    QList<QPair<int,QString> > beliefs = gdr->get_ordered_beliefs();
+    for(const auto &b : beliefs){
+        if(b.first >= s.values[AT_BELIEF].size())
+            s.values[AT_BELIEF].resize(b.first + 1);
+        s.values[AT_BELIEF][b.first] = DwarfStats::beliefs.rating(d->belief_value(b.first));
+    }
+
+    QList<QPair<int,QString> > goals = gdr->get_ordered_goals();
+    for(const auto &g : goals){
+        if(g.first >= s.values[AT_GOAL].size())
+            s.values[AT_GOAL].resize(g.first + 1);
+        s.values[AT_GOAL][g.first] = d->goals().value(g.first, 1) <= 0 ? 1.0 : 0.0;
+    }
+
+    s.values[AT_NEED].resize(gdr->get_need_count());
+    for(int id = 0; id < s.values[AT_NEED].size(); id++)
+        s.values[AT_NEED][id] = DwarfStats::needs.rating(d->get_need_type_level(id));
+
+    for(const auto &skill : gdr->get_skills()){
+        if(skill.id >= s.values[AT_SKILL].size()){
+            s.values[AT_SKILL].resize(skill.id + 1);
+            s.skill_rates.resize(skill.id + 1);
+        }
+        const Skill &sk = d->get_skill(skill.id);
+        s.values[AT_SKILL][skill.id] = sk.get_rating();
+        s.skill_rates[skill.id] = sk.skill_rate();
+    }
+    return s;
+}
+
+double RoleKernel::pref_rating(double pref_total){
+    return DwarfStats::preferences.rating(pref_total) * 100.0f;
+}
+
+void RoleKernel::rate(const unit_values &snapshot, const double *pref_ratings, double *out) const{
+    QVector<double> values[AT_VALUE_COUNT];
+    for(int a = 0; a < AT_VALUE_COUNT; a++){
+        const QVector<int> &ids = m_ids[a];
+        values[a].resize(ids.size());
+        for(int s = 0; s < ids.size(); s++)
+            values[a][s] = snapshot.values[a].value(ids.at(s), 0.0);
+    }
+    const QVector<int> &skills = m_ids[AT_SKILL];
+    QVector<int> skill_rates(skills.size());
+    for(int s = 0; s < skills.size(); s++)
+        skill_rates[s] = snapshot.skill_rates.value(skills.at(s), 0);
+
+    rate_values(values, skill_rates.constData(), pref_ratings, out);
+}
+
+void RoleKernel::rate_unit(Dwarf *d, double *out, const double *pref_totals) const{
+    d->calc_attribute_ratings();
+
+    QVector<double> values[AT_VALUE_COUNT];
+    QVector<int> skill_rates;
+    load_values(d, values, skill_rates);
+
+    QVector<double> unit_pref_totals;
+    if(!pref_totals){
+        unit_pref_totals.resize(m_roles.size());
+        m_pref_index.match(d, unit_pref_totals.data());
+        pref_totals = unit_pref_totals.constData();
+    }
+    QVector<double> pref_ratings(m_roles.size(), 50.0);
+    for(int r = 0; r < m_compiled.size(); r++){
+        if(m_compiled.at(r).has_prefs)
+            pref_ratings[r] = pref_rating(pref_totals[r]);
+    }
+
+    rate_values(values, skill_rates.constData(), pref_ratings.constData(), out);
+}
+
+void RoleKernel::rate_values(const QVector<double> *values, const int *rates, const double *pref_ratings, double *out) const{
+    const term *terms = m_terms.constData();
+    for(int r = 0; r < m_compiled.size(); r++){
+        const compiled_role &cr = m_compiled.at(r);
+        if(cr.scripted)
+            continue; //rated on the calling thread
+        if(cr.unweighted){
+            out[r] = 50.0;
+            continue;
+        }
+
+        double rating_total = 0.0;
+        for(int a = 0; a < AT_VALUE_COUNT; a++){
+            double aspect = 50.0;
+            if(!cr.constant[a]){
+                const double *v = values[a].constData();
+                aspect = 0.0;
+                for(int t = cr.begin[a]; t < cr.end[a]; t++){
+                    double value = v[terms[t].slot];
+                    if(terms[t].neg)
+                        value = 1.0 - value;
+                    aspect += value * terms[t].weight;
+                }
+                aspect *= 100.0;
+            }
+            rating_total += aspect * cr.aspect_weight[a];
+        }
+
+        if(cr.has_skills){
+            //a unit that can't improve any of the role's skills can't fill the role
+            int total_skill_rates = 0;
+            for(int t = cr.begin[AT_SKILL]; t < cr.end[AT_SKILL]; t++)
+                total_skill_rates += rates[terms[t].slot];
+            if(total_skill_rates <= 0){
+                out[r] = 0.0001;
+                continue;
+            }
+        }
+
+        double prefs = cr.has_prefs ? pref_ratings[r] : 50.0;
+        rating_total += prefs * cr.aspect_weight[AT_PREFERENCE];
+
+        if(rating_total == 0.0)
+            rating_total = 0.0001;
+        out[r] = rating_total;
+    }
+}
+
+QVector<double> RoleKernel::match_preferences(const QVector<Dwarf*> &units) const{
+    const int role_count = m_roles.size();
+    QVector<double> totals(units.size() * role_count);
+    if(totals.isEmpty())
+        return totals;
+
+    double *out = totals.data();
+    QVector<int> unit_ids;
+    unit_ids.reserve(units.size());
+    for(int i = 0; i < units.size(); i++)
+        unit_ids.append(i);
+
+    auto match_one = [&](int &i){
+        m_pref_index.match(units.at(i), out + i * role_count);
+    };
+    QtConcurrent::blockingMap(unit_ids, match_one);
+    return totals;
+}
+
+QVector<double> RoleKernel::rate(const QVector<Dwarf*> &units, const QVector<double> &pref_totals) const{
+    const int role_count = m_roles.size();
+    QVector<double> ratings(units.size() * role_count);
+    if(ratings.isEmpty())
+        return ratings;
+
+    double *out = ratings.data();
+    const double *totals = (pref_totals.size() == ratings.size() ? pref_totals.constData() : 0);
+    QVector<int> unit_ids;
+    unit_ids.reserve(units.size());
+    for(int i = 0; i < units.size(); i++)
+        unit_ids.append(i);
+
+    auto rate_one = [&](int &i){
+        rate_unit(units.at(i), out + i * role_count, totals ? totals + i * role_count : 0);
+    };
+    QtConcurrent::blockingMap(unit_ids, rate_one);
+
+    if(m_has_scripts){
+        for(int i = 0; i < units.size(); i++){
+            for(int r = 0; r < role_count; r++){
+                if(m_compiled.at(r).scripted)
+                    out[i * role_count + r] = units.at(i)->calc_role_rating(m_roles.at(r));
+            }
+        }
+    }
+    return ratings;
+}
+
+QVector<double> RoleKernel::rate(Dwarf *d) const{
+    QVector<double> ratings(m_roles.size());
+    if(ratings.isEmpty())
+        return ratings;
+    rate_unit(d, ratings.data(), 0);
+    for(int r = 0; r < m_roles.size(); r++){
+        if(m_compiled.at(r).scripted)
+            ratings[r] = d->calc_role_rating(m_roles.at(r));
+    }
+    return ratings;
+}
@@ -0,0 +1,128 @@
+/*
+Dwarf Therapist
+Copyright (c) 2009 Trey Stout (chmod)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+#ifndef ROLE_KERNEL_H
+#define ROLE_KERNEL_H
+
+#include <QList>
+#include <QVector>
+#include "rolepreferenceindex.h"
+
+class Dwarf;
+class Role;
+
+/**
+ * Roles compiled into flat arrays for rating a whole population at once.
+ *
+ * Each role aspect (attributes, facets, beliefs, goals, needs, skills)
+ * becomes a contiguous run of terms holding a slot into a dense per-unit
+ * value array, a weight already divided by the aspect's total weight and a
+ * negation flag. Attribute names are resolved to ids once, here, instead
+ * of for every unit. Rating a unit fills its value arrays once and then
+ * sums every role's terms; units are rated in parallel.
+ *
+ * Preferences are matched through a RolePreferenceIndex and roles with a
+ * script are evaluated by Dwarf::calc_role_rating on the calling thread,
+ * since the script engine can't share the unit across threads.
+ */
+class RoleKernel
+{
+public:
+    explicit RoleKernel(const QList<Role*> &roles);
+
+    //! the compiled roles, ratings are returned in this order
+    const QVector<Role*> &roles() const {return m_roles;}
+
+    //! true if the role at this position has preferences
+    bool has_prefs(int role) const {return m_compiled.at(role).has_prefs;}
+
+    //! weighted preference match totals of every role for every unit, in the same layout as the ratings
+    QVector<double> match_preferences(const QVector<Dwarf*> &units) const;
+
+    //! raw ratings of every role for every unit, unit by unit in role order. pref_totals can be reused from match_preferences
+    QVector<double> rate(const QVector<Dwarf*> &units, const QVector<double> &pref_totals = QVector<double>()) const;
+
+    //! raw ratings of one unit for every role, scripted roles are included
+    QVector<double> rate(Dwarf *d) const;
+
+    typedef enum {
+        AT_ATTRIBUTE = 0,
+        AT_FACET,
+        AT_BELIEF,
+        AT_GOAL,
+        AT_NEED,
+        AT_SKILL,
+        AT_PREFERENCE,
+        AT_COUNT,
+        AT_VALUE_COUNT = AT_PREFERENCE //aspects read into dense value arrays
+    } ASPECT_TYPE;
+
+    //! every rating input of a unit indexed by id, lets roles be rated without touching the unit
+    struct unit_values {
+        QVector<double> values[AT_VALUE_COUNT];
+        QVector<int> skill_rates;
+    };
+    //! take a snapshot of a unit, the unit's attribute ratings must be up to date
+    static unit_values snapshot(Dwarf *d);
+    //! the preference aspect of a role (0-100) for a weighted preference match total
+    static double pref_rating(double pref_total);
+
+    /*!
+     * raw ratings of a snapshot for every role without a script, scripted roles are left untouched.
+     * pref_ratings holds the preference aspect of every role, see pref_rating. safe to call from any thread.
+     */
+    void rate(const unit_values &snapshot, const double *pref_ratings, double *out) const;
+
+private:
+    struct term {
+        int slot;
+        float weight; //divided by the aspect's total weight
+        bool neg;
+    };
+
+    struct compiled_role {
+        bool scripted;
+        bool has_skills;
+        bool has_prefs;
+        bool unweighted; //the role's aspect weights are all 0, it rates as 50
+        float aspect_weight[AT_COUNT]; //divided by the role's total aspect weight
+        int begin[AT_VALUE_COUNT];
+        int end[AT_VALUE_COUNT];
+        bool constant[AT_VALUE_COUNT]; //no terms or no weight, the aspect rates as 50
+    };
+
+    QVector<Role*> m_roles;
+    RolePreferenceIndex m_pref_index;
+    QVector<compiled_role> m_compiled;
+    QVector<term> m_terms;
+    //slot -> id for each aspect, only ids used by at least one role get a slot
+    QVector<int> m_ids[AT_VALUE_COUNT];
+    bool m_has_scripts;
+
+    template<typename T>
+    void compile_aspect(compiled_role &cr, ASPECT_TYPE type, const T &aspects);
+    void load_values(Dwarf *d, QVector<double> *values, QVector<int> &skill_rates) const;
+    void rate_unit(Dwarf *d, double *out, const double *pref_totals) const;
+    void rate_values(const QVector<double> *values, const int *rates, const double *pref_ratings, double *out) const;
+};
+
+#endif // ROLE_KERNEL_H
@@ -24,6 +24,8 @@ THE SOFTWARE.
 #include "rolepreference.h"
 
 #include <QSettings>
+#include <QStringList>
+#include <typeinfo>
 #include "preference.h"
 #include "races.h"
 #include "plant.h"
@@ -54,6 +56,16 @@ bool RolePreference::match(const Preference *p, const Dwarf *) const
     return m_type == p->get_pref_category();
 }
 
+QString RolePreference::match_key() const
+{
+    //the class decides how the name and flags are compared
+    QStringList flags;
+    for (auto f: m_flags)
+        flags.append(QString::number(f));
+    return QString("%1|%2|%3|%4").arg(QString::fromLatin1(typeid(*this).name()))
+            .arg(m_type).arg(m_name).arg(flags.join(","));
+}
+
 std::unique_ptr<RolePreference> RolePreference::parse(QSettings &s, bool &updated)
 {
     QString id;
@@ -204,6 +216,10 @@ bool ItemRolePreference::match(const Preference *p, const Dwarf *d) const {
         (!d || ip->can_wield(d));
 }
 
+QString ItemRolePreference::match_key() const {
+    return QString("|item:%1").arg(m_item_type);
+}
+
 MaterialRolePreference::MaterialRolePreference(MATERIAL_STATES mat_state)
     : m_mat_state(mat_state)
 {
@@ -222,6 +238,10 @@ bool MaterialRolePreference::match(const Preference *p) const
     return mp && m_mat_state == mp->get_mat_state();
 }
 
+QString MaterialRolePreference::match_key() const {
+    return QString("|state:%1").arg(m_mat_state);
+}
+
 ExactRolePreference::ExactRolePreference(PREF_TYPES type, const QString &name, const std::set<int> &flags)
     : RolePreference(type, name, flags)
 {
@@ -296,6 +316,10 @@ bool ExactItemRolePreference::match(const Preference *p, const Dwarf *d) const {
     return ItemRolePreference::match(p, d) && ExactRolePreference::match(p, d);
 }
 
+QString ExactItemRolePreference::match_key() const {
+    return ExactRolePreference::match_key() + ItemRolePreference::match_key();
+}
+
 GenericRolePreference::GenericRolePreference(PREF_TYPES type, const QString &name, const std::set<int> &flags)
     : RolePreference(type, name, flags)
 {
@@ -326,6 +350,10 @@ bool ExactMaterialRolePreference::match(const Preference *p, const Dwarf *d) con
     return MaterialRolePreference::match(p) && ExactRolePreference::match(p, d);
 }
 
+QString ExactMaterialRolePreference::match_key() const {
+    return ExactRolePreference::match_key() + MaterialRolePreference::match_key();
+}
+
 std::unique_ptr<RolePreference> GenericRolePreference::copy() const {
     return std::make_unique<GenericRolePreference>(*this);
 }
@@ -355,6 +383,10 @@ bool GenericMaterialRolePreference::match(const Preference *p, const Dwarf *d) c
     return MaterialRolePreference::match(p) && GenericRolePreference::match(p, d);
 }
 
+QString GenericMaterialRolePreference::match_key() const {
+    return GenericRolePreference::match_key() + MaterialRolePreference::match_key();
+}
+
 GenericItemRolePreference::GenericItemRolePreference(const QString &name, ITEM_TYPE item_type, const std::set<int> &flags)
     : GenericRolePreference(LIKE_ITEM, name, flags)
     , ItemRolePreference(item_type)
@@ -374,6 +406,10 @@ bool GenericItemRolePreference::match(const Preference *p, const Dwarf *d) const
     return ItemRolePreference::match(p, d) && GenericRolePreference::match(p, d);
 }
 
+QString GenericItemRolePreference::match_key() const {
+    return GenericRolePreference::match_key() + ItemRolePreference::match_key();
+}
+
 MaterialReactionRolePreference::MaterialReactionRolePreference(const QString &name, MATERIAL_STATES state, const QString &reaction, const std::set<int> &flags)
     : GenericMaterialRolePreference(name, state, flags)
     , m_reaction(reaction)
@@ -387,6 +423,10 @@ bool MaterialReactionRolePreference::match(const Preference *p, const Dwarf *d)
     return mp && mp->get_material()->has_reaction(m_reaction);
 }
 
+QString MaterialReactionRolePreference::match_key() const {
+    return GenericMaterialRolePreference::match_key() + "|reaction:" + m_reaction;
+}
+
 void MaterialReactionRolePreference::write(QSettings &s) const {
     GenericMaterialRolePreference::write(s);
     s.setValue("mat_reaction", m_reaction);
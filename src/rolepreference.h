@@ -44,6 +44,8 @@ public:
     const QString &get_name() const { return m_name; }
 
     virtual bool match(const Preference *p, const Dwarf *d) const;
+    //! identifies everything match() depends on, preferences with the same key match the same units
+    virtual QString match_key() const;
 
     static std::unique_ptr<RolePreference> parse(QSettings &s, bool &updated);
     virtual void write(QSettings &s) const;
@@ -71,6 +73,7 @@ protected:
     void write(QSettings &s) const;
 
     bool match(const Preference *p, const Dwarf *d) const;
+    QString match_key() const;
 
 private:
     ITEM_TYPE m_item_type;
@@ -88,6 +91,7 @@ protected:
     void write(QSettings &s) const;
 
     bool match(const Preference *p) const;
+    QString match_key() const;
 
 private:
     MATERIAL_STATES m_mat_state;
@@ -122,6 +126,7 @@ public:
     ExactItemRolePreference(const ItemSubtype *i);
 
     bool match(const Preference *p, const Dwarf *d) const override;
+    QString match_key() const override;
 
     void write(QSettings &s) const override;
     std::unique_ptr<RolePreference> copy() const override;
@@ -133,6 +138,7 @@ public:
     ExactMaterialRolePreference(const Material *m, MATERIAL_STATES state);
 
     bool match(const Preference *p, const Dwarf *d) const override;
+    QString match_key() const override;
 
     void write(QSettings &s) const override;
     std::unique_ptr<RolePreference> copy() const override;
@@ -161,6 +167,7 @@ public:
     GenericMaterialRolePreference(const QString &name, MATERIAL_STATES state, const std::set<int> &flags);
 
     bool match(const Preference *p, const Dwarf *d) const override;
+    QString match_key() const override;
 
     void write(QSettings &s) const override;
     std::unique_ptr<RolePreference> copy() const override;
@@ -177,6 +184,7 @@ public:
     GenericItemRolePreference(const QString &name, ITEM_TYPE item_type, const std::set<int> &flags);
 
     bool match(const Preference *p, const Dwarf *d) const override;
+    QString match_key() const override;
 
     void write(QSettings &s) const override;
     std::unique_ptr<RolePreference> copy() const override;
@@ -193,6 +201,7 @@ public:
     MaterialReactionRolePreference(const QString &name, MATERIAL_STATES state, const QString &reaction, const std::set<int> &flags);
 
     bool match(const Preference *p, const Dwarf *d) const override;
+    QString match_key() const override;
 
     void write(QSettings &s) const override;
     std::unique_ptr<RolePreference> copy() const override;
@@ -0,0 +1,118 @@
+/*
+Dwarf Therapist
+Copyright (c) 2009 Trey Stout (chmod)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+#include "rolepreferenceindex.h"
+#include "role.h"
+#include "rolepreference.h"
+#include "preference.h"
+#include "dwarf.h"
+
+RolePreferenceIndex::RolePreferenceIndex(const QVector<Role*> &roles)
+    : m_roles(roles)
+{
+    for(int r = 0; r < m_roles.size(); r++){
+        int idx = 0;
+        for(const auto &p : m_roles.at(r)->prefs){
+            const RolePreference *rp = p.first.get();
+            posting entry;
+            entry.pref = rp;
+            entry.role = r;
+            entry.pref_index = idx++;
+            entry.weight = p.second.weight;
+            entry.neg = p.second.is_neg;
+            int id = m_postings.size();
+            m_postings.append(entry);
+
+            int category = rp->get_pref_category();
+            if(dynamic_cast<const ExactRolePreference*>(rp)){
+                m_exact[qMakePair(category, rp->get_name().toCaseFolded())].append(id);
+            }else{
+                auto *irp = dynamic_cast<const ItemRolePreference*>(rp);
+                m_generic[qMakePair(category, irp ? static_cast<int>(irp->get_item_type()) : -1)].append(id);
+            }
+        }
+    }
+}
+
+double RolePreferenceIndex::weighted_match(double matches, float weight, bool neg){
+    if(matches <= 0)
+        return 0.0;
+    double rating = matches * weight;
+    if(neg)
+        rating = 1.0f-rating;
+    return rating;
+}
+
+void RolePreferenceIndex::match(Dwarf *d, double *role_totals) const{
+    for(int r = 0; r < m_roles.size(); r++)
+        role_totals[r] = 0.0;
+    if(m_postings.isEmpty())
+        return;
+
+    QVector<double> matches(m_postings.size(), 0.0);
+    QHash<int, QVector<QPair<int, int> > > explanations; //role -> (role preference, unit preference)
+
+    auto check = [&](const QVector<int> &candidates, const Preference *p, int pref_pos){
+        foreach(int id, candidates){
+            const posting &entry = m_postings.at(id);
+            if(entry.pref->match(p, d)){
+                matches[id] += 1.0;
+                explanations[entry.role].append(qMakePair(entry.pref_index, pref_pos));
+            }
+        }
+    };
+
+    int pref_pos = 0;
+    for(const auto &it : *d->get_preferences()){
+        const Preference *p = it.second.get();
+        int category = p->get_pref_category();
+        auto exact = m_exact.constFind(qMakePair(category, p->get_name().toCaseFolded()));
+        if(exact != m_exact.constEnd())
+            check(exact.value(), p, pref_pos);
+        auto generic = m_generic.constFind(qMakePair(category, -1));
+        if(generic != m_generic.constEnd())
+            check(generic.value(), p, pref_pos);
+        auto *ip = dynamic_cast<const ItemPreference*>(p);
+        if(ip && ip->get_item_type() != NONE){
+            auto item = m_generic.constFind(qMakePair(category, static_cast<int>(ip->get_item_type())));
+            if(item != m_generic.constEnd())
+                check(item.value(), p, pref_pos);
+        }
+        pref_pos++;
+    }
+
+    for(int id = 0; id < m_postings.size(); id++){
+        double m = matches.at(id);
+        if(m <= 0)
+            continue;
+        //give a 0.1 bonus for each match after the first, this only applies when getting matches for groups
+        if(m > 1.0)
+            m = 1.0f + ((m-1.0f) / 10.0f);
+        const posting &entry = m_postings.at(id);
+        role_totals[entry.role] += weighted_match(m, entry.weight, entry.neg);
+    }
+
+    for(int r = 0; r < m_roles.size(); r++){
+        if(!m_roles.at(r)->prefs.empty())
+            d->set_role_pref_matches(m_roles.at(r)->name(), explanations.value(r));
+    }
+}
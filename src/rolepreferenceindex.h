@@ -0,0 +1,75 @@
+/*
+Dwarf Therapist
+Copyright (c) 2009 Trey Stout (chmod)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+#ifndef ROLE_PREFERENCE_INDEX_H
+#define ROLE_PREFERENCE_INDEX_H
+
+#include <QHash>
+#include <QPair>
+#include <QString>
+#include <QVector>
+
+class Dwarf;
+class Role;
+class RolePreference;
+
+/**
+ * Maps the features of a unit's preference to the role preferences it can satisfy.
+ *
+ * Exact role preferences are keyed on their category and name, everything
+ * else on the category and, for item preferences, the item type. Each of a
+ * unit's preferences looks up its candidates once for all of the roles and
+ * only those candidates are checked with RolePreference::match.
+ */
+class RolePreferenceIndex
+{
+public:
+    explicit RolePreferenceIndex(const QVector<Role*> &roles);
+
+    //! true if none of the roles have preferences
+    bool is_empty() const {return m_postings.isEmpty();}
+
+    /*!
+     * weighted preference match totals of one unit for every role, roles without preferences get 0.
+     * the unit's match explanations are replaced for every role with preferences.
+     */
+    void match(Dwarf *d, double *role_totals) const;
+
+    //! contribution of one role preference to a role's match total
+    static double weighted_match(double matches, float weight, bool neg);
+
+private:
+    struct posting {
+        const RolePreference *pref;
+        int role;
+        int pref_index; //position in the role's preferences
+        float weight;
+        bool neg;
+    };
+
+    QVector<Role*> m_roles;
+    QVector<posting> m_postings;
+    QHash<QPair<int, QString>, QVector<int> > m_exact; //(category, case folded name) -> postings
+    QHash<QPair<int, int>, QVector<int> > m_generic; //(category, item type or -1) -> postings
+};
+
+#endif // ROLE_PREFERENCE_INDEX_H
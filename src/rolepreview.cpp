@@ -0,0 +1,248 @@
+/*
+Dwarf Therapist
+Copyright (c) 2009 Trey Stout (chmod)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+#include "rolepreview.h"
+#include "dfinstance.h"
+#include "dwarf.h"
+#include "dwarftherapist.h"
+#include "mainwindow.h"
+#include "role.h"
+#include "rolecalcbase.h"
+#include "rolepreference.h"
+#include "rolepreferenceindex.h"
+
+#include <QJSValueIterator>
+#include <QtConcurrent>
+
+RolePreview::RolePreview(QObject *parent)
+    : QObject(parent)
+{
+    connect(&m_watcher, SIGNAL(finished()), this, SLOT(finished()));
+    connect(DT, SIGNAL(units_refreshed()), this, SLOT(invalidate_units()));
+}
+
+RolePreview::~RolePreview()
+{
+    cancel();
+    m_watcher.waitForFinished();
+}
+
+void RolePreview::cancel(){
+    if(m_cancel)
+        *m_cancel = true;
+    m_cancel.reset();
+}
+
+void RolePreview::invalidate(){
+    m_units.reset();
+    m_pref_matches.clear();
+}
+
+void RolePreview::invalidate_units(){
+    cancel();
+    invalidate();
+}
+
+QJSValue RolePreview::evaluate_script(const QString &script, Dwarf *d){
+    if(m_scope.isUndefined()){
+        //a direct eval inside a function keeps the script's declarations local to one call
+        m_scope = m_engine.evaluate("(function(d, script) { return eval(script); })");
+        QJSValueIterator it(m_engine.globalObject());
+        while(it.hasNext()){
+            it.next();
+            m_globals.insert(it.name());
+        }
+    }
+    QJSValue ret = m_scope.call(QJSValueList() << m_engine.newQObject(d) << script);
+
+    //drop anything the script assigned to the global object so it can't leak into the next unit
+    QStringList added;
+    QJSValueIterator it(m_engine.globalObject());
+    while(it.hasNext()){
+        it.next();
+        if(!m_globals.contains(it.name()))
+            added.append(it.name());
+    }
+    foreach(const QString &name, added){
+        m_engine.globalObject().deleteProperty(name);
+    }
+    return ret;
+}
+
+void RolePreview::update_snapshot(const QVector<Dwarf*> &units){
+    bool current = m_units && m_units->size() == units.size();
+    for(int i = 0; current && i < units.size(); i++)
+        current = (m_units->at(i).id == units.at(i)->id());
+    if(current)
+        return;
+
+    auto list = std::make_shared<snapshot_list>();
+    list->reserve(units.size());
+    foreach(Dwarf *d, units){
+        unit_snapshot s;
+        s.id = d->id();
+        s.name = d->nice_name();
+        s.values = RoleKernel::snapshot(d);
+        list->append(s);
+    }
+    m_units = list;
+    m_pref_matches.clear();
+}
+
+void RolePreview::load_pref_ratings(Role *r, int role, int role_count, const QVector<Dwarf*> &units, QVector<double> &pref_ratings){
+    QVector<const QVector<double>*> matches;
+    for(const auto &p : r->prefs){
+        const RolePreference *rp = p.first.get();
+        auto it = m_pref_matches.find(rp->match_key());
+        if(it == m_pref_matches.end()){
+            QVector<double> counts(units.size());
+            for(int i = 0; i < units.size(); i++)
+                counts[i] = units.at(i)->get_role_pref_match_counts(rp);
+            it = m_pref_matches.insert(rp->match_key(), counts);
+        }
+        matches.append(&it.value());
+    }
+
+    for(int i = 0; i < units.size(); i++){
+        double total = 0.0;
+        int idx = 0;
+        for(const auto &p : r->prefs){
+            total += RolePreferenceIndex::weighted_match(matches.at(idx++)->at(i), p.second.weight, p.second.is_neg);
+        }
+        pref_ratings[i * role_count + role] = RoleKernel::pref_rating(total);
+    }
+}
+
+void RolePreview::request(Role *old_role, Role *new_role){
+    cancel();
+    DFInstance *df = DT->get_main_window()->get_DFInstance();
+    //the same units the role ratings are calculated for
+    const QVector<Dwarf*> units = df ? df->get_labor_capable_dwarves() : QVector<Dwarf*>();
+    if(!new_role || units.isEmpty()){
+        m_result = result();
+        emit ready();
+        return;
+    }
+
+    update_snapshot(units);
+
+    QList<Role*> roles;
+    if(old_role)
+        roles.append(old_role);
+    roles.append(new_role);
+    auto kernel = std::make_shared<RoleKernel>(roles);
+    const int role_count = roles.size();
+
+    //scripts and preference matches need the live units, everything else is rated from the snapshot
+    QVector<double> pref_ratings(units.size() * role_count, 50.0);
+    QVector<double> ratings(units.size() * role_count, 0.0);
+    for(int r = 0; r < role_count; r++){
+        Role *role = roles.at(r);
+        QString script = role->script().trimmed();
+        if(!script.isEmpty()){
+            for(int i = 0; i < units.size(); i++)
+                ratings[i * role_count + r] = evaluate_script(script, units.at(i)).toNumber();
+        }else if(!role->prefs.empty()){
+            load_pref_ratings(role, r, role_count, units, pref_ratings);
+        }
+    }
+
+    auto cancelled = std::make_shared<std::atomic_bool>(false);
+    m_cancel = cancelled;
+    std::shared_ptr<const snapshot_list> snapshot = m_units;
+    bool has_old = (old_role != nullptr);
+    m_watcher.setFuture(QtConcurrent::run([kernel, snapshot, cancelled, pref_ratings, ratings, role_count, has_old] () mutable {
+        const snapshot_list &list = *snapshot;
+        for(int i = 0; i < list.size(); i++){
+            if(*cancelled)
+                return result();
+            kernel->rate(list.at(i).values, pref_ratings.constData() + i * role_count, ratings.data() + i * role_count);
+        }
+        return summarize(ratings, role_count, has_old, list);
+    }));
+}
+
+void RolePreview::finished(){
+    //a cancelled preview was replaced by a newer request which is still running
+    if(!m_cancel || *m_cancel)
+        return;
+    m_result = m_watcher.result();
+    m_cancel.reset();
+    emit ready();
+}
+
+static QVector<int> rank_units(const QVector<double> &ratings, int role_count, int role, int unit_count){
+    QVector<int> order(unit_count);
+    for(int i = 0; i < unit_count; i++)
+        order[i] = i;
+    std::stable_sort(order.begin(), order.end(), [&](int a, int b){
+        return ratings.at(a * role_count + role) > ratings.at(b * role_count + role);
+    });
+    return order;
+}
+
+RolePreview::result RolePreview::summarize(const QVector<double> &ratings, int role_count, bool has_old, const snapshot_list &units){
+    result res;
+    const int unit_count = units.size();
+    const int new_role = role_count - 1;
+    res.unit_count = unit_count;
+    res.has_old = has_old;
+    res.histogram.fill(0, HISTOGRAM_BINS);
+
+    QVector<double> sorted(unit_count);
+    QVector<double> old_sorted(has_old ? unit_count : 0);
+    for(int i = 0; i < unit_count; i++){
+        double rating = ratings.at(i * role_count + new_role);
+        sorted[i] = rating;
+        int bin = qBound(0, static_cast<int>(rating / (100.0 / HISTOGRAM_BINS)), HISTOGRAM_BINS - 1);
+        res.histogram[bin]++;
+        if(has_old)
+            old_sorted[i] = ratings.at(i * role_count);
+    }
+    std::sort(sorted.begin(), sorted.end());
+    res.median = RoleCalcBase::find_median(sorted);
+
+    QVector<int> order = rank_units(ratings, role_count, new_role, unit_count);
+    QVector<int> old_rank(unit_count, -1);
+    if(has_old){
+        std::sort(old_sorted.begin(), old_sorted.end());
+        res.old_median = RoleCalcBase::find_median(old_sorted);
+        QVector<int> old_order = rank_units(ratings, role_count, 0, unit_count);
+        for(int pos = 0; pos < unit_count; pos++)
+            old_rank[old_order.at(pos)] = pos + 1;
+        for(int pos = 0; pos < unit_count; pos++){
+            if(old_rank.at(order.at(pos)) != pos + 1)
+                res.moved++;
+        }
+    }
+
+    for(int pos = 0; pos < unit_count && pos < TOP_COUNT; pos++){
+        int i = order.at(pos);
+        ranked_unit u;
+        u.name = units.at(i).name;
+        u.rating = ratings.at(i * role_count + new_role);
+        u.rank = pos + 1;
+        u.old_rank = old_rank.at(i);
+        res.top.append(u);
+    }
+    return res;
+}
@@ -0,0 +1,120 @@
+/*
+Dwarf Therapist
+Copyright (c) 2009 Trey Stout (chmod)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+#ifndef ROLE_PREVIEW_H
+#define ROLE_PREVIEW_H
+
+#include <QObject>
+#include <QFutureWatcher>
+#include <QHash>
+#include <QJSEngine>
+#include <QSet>
+#include <QVector>
+#include <atomic>
+#include <memory>
+#include "rolekernel.h"
+
+class Dwarf;
+class Role;
+
+/**
+ * Rates an edited role and the role it replaces across the whole population
+ * for the role editor.
+ *
+ * The labor capable units are copied into RoleKernel snapshots once and the
+ * ratings are calculated from the copies on a worker thread, so the units can
+ * be read again while a preview is running. A new request cancels the
+ * previous one. Preference matches are cached by everything a role
+ * preference matches on, weights can change without matching again. Scripts
+ * need the live unit and are evaluated on the calling thread with one engine
+ * kept for the dialog, each unit in a fresh function scope.
+ */
+class RolePreview : public QObject
+{
+    Q_OBJECT
+public:
+    struct ranked_unit {
+        QString name;
+        double rating;
+        int rank;
+        int old_rank; //-1 without an old role
+    };
+
+    struct result {
+        result() : unit_count(0), has_old(false), moved(0), median(0), old_median(0) {}
+        int unit_count;
+        bool has_old;
+        QVector<int> histogram; //counts of the new raw ratings in bins of 10
+        QVector<ranked_unit> top;
+        int moved; //units whose rank changed
+        double median;
+        double old_median;
+    };
+
+    static const int HISTOGRAM_BINS = 10;
+    static const int TOP_COUNT = 10;
+
+    explicit RolePreview(QObject *parent = nullptr);
+    virtual ~RolePreview();
+
+    //! rate the population for both roles, old_role may be null
+    void request(Role *old_role, Role *new_role);
+    //! cancel the running preview
+    void cancel();
+    //! drop the cached units and preference matches, the next request takes a new snapshot
+    void invalidate();
+
+    const result &last_result() const {return m_result;}
+
+    //! evaluate a role script for a unit with the preview's engine, returns the engine's value (can be an error)
+    QJSValue evaluate_script(const QString &script, Dwarf *d);
+
+signals:
+    void ready();
+
+private slots:
+    void finished();
+    void invalidate_units();
+
+private:
+    struct unit_snapshot {
+        int id;
+        QString name;
+        RoleKernel::unit_values values;
+    };
+    typedef QVector<unit_snapshot> snapshot_list;
+
+    std::shared_ptr<const snapshot_list> m_units;
+    QHash<QString, QVector<double> > m_pref_matches; //role preference match key -> match count of every unit
+    std::shared_ptr<std::atomic_bool> m_cancel;
+    QFutureWatcher<result> m_watcher;
+    result m_result;
+    QJSEngine m_engine;
+    QJSValue m_scope; //!< function evaluating a script for one unit
+    QSet<QString> m_globals; //!< the engine's own global properties
+
+    void update_snapshot(const QVector<Dwarf*> &units);
+    void load_pref_ratings(Role *r, int role, int role_count, const QVector<Dwarf*> &units, QVector<double> &pref_ratings);
+    static result summarize(const QVector<double> &ratings, int role_count, bool has_old, const snapshot_list &units);
+};
+
+#endif // ROLE_PREVIEW_H
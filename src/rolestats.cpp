@@ -43,9 +43,15 @@ void RoleStats::set_list(const QVector<double> &unsorted){
     set_mode(unsorted);
 }
 
-void RoleStats::set_mode(const QVector<double> &unsorted){
-    m_valid = unsorted;
-    std::sort(m_valid.begin(), m_valid.end());
+void RoleStats::set_sorted_list(const QVector<double> &sorted){
+    m_total_count = static_cast<double>(sorted.size());
+    set_mode(sorted, true);
+}
+
+void RoleStats::set_mode(const QVector<double> &values, bool sorted){
+    m_valid = values;
+    if(!sorted)
+        std::sort(m_valid.begin(), m_valid.end());
     bool skewed = false;
     double valid_size = m_valid.size();
     m_median = RoleCalcBase::find_median(m_valid);
@@ -38,6 +38,8 @@ public:
 
     double get_rating(double val);
     void set_list(const QVector<double> &unsorted);
+    //! same as set_list for values which are already in ascending order
+    void set_sorted_list(const QVector<double> &sorted);
 
 private:
     double m_total_count;
@@ -48,7 +50,7 @@ private:
 
     QSharedPointer<RoleCalcBase> m_calc;
     QVector<double> m_valid;
-    void set_mode(const QVector<double> &unsorted);
+    void set_mode(const QVector<double> &values, bool sorted = false);
 };
 
 #endif // ROLESTATS_H
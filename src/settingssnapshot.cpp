@@ -0,0 +1,53 @@
+/*
+Dwarf Therapist
+Copyright (c) 2009 Trey Stout (chmod)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+#include "settingssnapshot.h"
+#include "defaultfonts.h"
+#include "defines.h"
+#include "dwarf.h"
+
+#include <QSettings>
+
+SettingsSnapshot::SettingsSnapshot(QSettings *s)
+{
+    s->beginGroup("options");
+    labor_exclusions = s->value("labor_exclusions", true).toBool();
+    show_custom_roles = s->value("show_custom_roles", false).toBool();
+    show_full_dwarf_names = s->value("show_full_dwarf_names", false).toBool();
+    use_generic_names = s->value("use_generic_names", false).toBool();
+    highlight_cursed = s->value("highlight_cursed", false).toBool();
+    diagnosis_not_required = s->value("diagnosis_not_required", false).toBool();
+    gender_info = s->value("gender_info", Dwarf::Option_ShowOrientation).toInt();
+    syndrome_display_type = s->value("syndrome_display_type", 0).toInt();
+    tooltip_show_preferences = s->value("tooltip_show_preferences", true).toBool();
+    tooltip_thought_weeks = s->value("tooltip_thought_weeks", -1).toInt();
+    equipoverview_include_mats = s->value("docks/equipoverview_include_mats", false).toBool();
+
+    s->beginGroup("grid");
+    grid_font = s->value("font", QFont(DefaultFonts::getRowFontName(), DefaultFonts::getRowFontSize())).value<QFont>();
+    cell_size = s->value("cell_size", DEFAULT_CELL_SIZE).toInt();
+    cell_padding = s->value("cell_padding", 0).toInt();
+    shade_cells = s->value("shade_cells", true).toBool();
+    show_tooltips = s->value("show_tooltips", true).toBool();
+    s->endGroup(); //grid
+    s->endGroup(); //options
+}
@@ -0,0 +1,65 @@
+/*
+Dwarf Therapist
+Copyright (c) 2009 Trey Stout (chmod)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+#ifndef SETTINGS_SNAPSHOT_H
+#define SETTINGS_SNAPSHOT_H
+
+#include <QFont>
+
+class QSettings;
+
+/**
+ * Typed copy of the user settings read by hot paths (labor toggling, role
+ * sorting, cell painting, tooltips).
+ *
+ * A new snapshot is built each time the settings are read and published by
+ * DwarfTherapist through an atomic pointer, so readers (including worker
+ * threads) get plain fields without going through QSettings. Snapshots are
+ * never modified once published.
+ */
+struct SettingsSnapshot
+{
+    //! read all of the fields from the "options" group
+    explicit SettingsSnapshot(QSettings *s);
+
+    //options
+    bool labor_exclusions;
+    bool show_custom_roles;
+    bool show_full_dwarf_names;
+    bool use_generic_names;
+    bool highlight_cursed;
+    bool diagnosis_not_required;
+    int gender_info;
+    int syndrome_display_type;
+    bool tooltip_show_preferences;
+    int tooltip_thought_weeks;
+    bool equipoverview_include_mats;
+
+    //grid
+    QFont grid_font;
+    int cell_size;
+    int cell_padding;
+    bool shade_cells;
+    bool show_tooltips;
+};
+
+#endif // SETTINGS_SNAPSHOT_H
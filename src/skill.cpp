@@ -38,12 +38,9 @@ Skill::Skill()
     , m_exp_progress(0)
     , m_capped_level(-1)
     , m_raw_level(-1)
-    , m_name("UNKNOWN")
-    , m_rust_rating("")
     , m_skill_rate(100)
     , m_rust(0)
     , m_losing_xp(false)
-    , m_rating(-1)
     , m_balanced_level(-1)
     , m_rust_level(0)
 {}
@@ -56,18 +53,11 @@ Skill::Skill(short id, uint exp, short rating, int rust, int skill_rate)
     , m_exp_for_next_level(exp + 1)
     , m_exp_progress(0)
     , m_raw_level(rating)
-    , m_name("UNKNOWN")
-    , m_rust_rating("")
     , m_skill_rate(skill_rate)
     , m_rust(rust)
-    , m_rating(-1)
     , m_balanced_level(-1)
     , m_rust_level(0)
 {
-    if (m_id != -1)
-        m_name = GameDataReader::ptr()->get_skill_name(m_id);
-    //defaults
-    m_rust_rating = "";
     m_capped_level = m_raw_level > 20 ? 20 : m_raw_level;
 
     //current xp
@@ -99,37 +89,60 @@ Skill::Skill(short id, uint exp, short rating, int rust, int skill_rate)
 
     if(m_exp_progress > 100){ //indicates losing xp
         m_exp_progress = 100;
-        m_rust_rating = QObject::tr("Lost XP!");
-        m_rust_color = QColor("#B7410E");
         m_losing_xp = true;
         m_rust_level = 3;
     }else{
         //check for normal rusting
         float m_raw_precise = raw_level_precise();
         if(m_raw_precise >= 4 && (m_raw_precise * 0.75) <= m_rust){
-            m_rust_rating = QObject::tr("V. Rusty");
-            m_rust_color = "#964B00";
             m_rust_level = 2;
         }else if(m_raw_level > 0 && (m_raw_level * 0.5) <= m_rust){
-            m_rust_rating = QObject::tr("Rusty");
-            m_rust_color = "#CD7F32";
             m_rust_level = 1;
         }
     }
 }
 
+namespace {
+    struct rust_style {
+        QString rating;
+        QColor color;
+    };
+
+    //indexed by rust level
+    const rust_style &get_rust_style(int rust_level){
+        static const rust_style styles[] = {
+            {QString(), QColor()},
+            {QObject::tr("Rusty"), QColor("#CD7F32")},
+            {QObject::tr("V. Rusty"), QColor("#964B00")},
+            {QObject::tr("Lost XP!"), QColor("#B7410E")},
+        };
+        return styles[qBound(0, rust_level, 3)];
+    }
+}
+
+const QString &Skill::rust_rating() const {
+    return get_rust_style(m_rust_level).rating;
+}
+
+const QColor &Skill::rust_color() const {
+    return get_rust_style(m_rust_level).color;
+}
+
+QString Skill::name() const {
+    if(m_id < 0)
+        return "UNKNOWN";
+    return GameDataReader::ptr()->get_skill_name(m_id);
+}
 
 QString Skill::to_string(bool include_level, bool include_exp_summary, bool use_color) const {
     GameDataReader *gdr = GameDataReader::ptr();
 
-    bool rusted = false;
-    if(!m_rust_rating.isEmpty())
-        rusted = true;
+    bool rusted = m_rust_level > 0;
 
     QString out;
 
     if(rusted && use_color)
-        out.append(QString("<font color=%1>").arg(m_rust_color.name()));
+        out.append(QString("<font color=%1>").arg(rust_color().name()));
 
     if(include_level)
         out.append(QString("[%1] ").arg(m_raw_level));
@@ -137,9 +150,9 @@ QString Skill::to_string(bool include_level, bool include_exp_summary, bool use_
     //df still shows the skill names based on the capped rating, not including rust?
     QString skill_level = gdr->get_skill_level_name(m_capped_level);
     if (skill_level.isEmpty())
-        out.append(QString("<b>%1</b>").arg(m_name));
+        out.append(QString("<b>%1</b>").arg(name()));
     else
-        out.append(QString("<b>%1 %2</b>").arg(skill_level, m_name));
+        out.append(QString("<b>%1 %2</b>").arg(skill_level, name()));
     if (include_exp_summary)
         out.append(QString(" %1").arg(exp_summary()));
 
@@ -226,7 +239,7 @@ float Skill::raw_level_precise() const{
 }
 
 //simulates xp gain based on skill rate to calculate a rating between 0 and 1, courtesy of Maklak
-double Skill::get_simulated_rating(){
+double Skill::get_simulated_rating() const{
     int curr_xp = m_capped_exp;
     int curr_level = m_capped_level;
     int rate = m_skill_rate;
@@ -242,7 +255,7 @@ double Skill::get_simulated_rating(){
 
 }
 
-double Skill::get_simulated_level(){
+double Skill::get_simulated_level() const{
     if ((int)m_capped_exp >= MAX_CAPPED_XP)
         return 20.0f;
 
@@ -280,7 +293,7 @@ double Skill::get_simulated_level(){
 }
 
 //returns a weighted average of the current level and the simulated level with skill rate
-void Skill::calculate_balanced_level(){
+void Skill::calculate_balanced_level() const{
     if(m_balanced_level < 0){
         float curr_level = capped_level_precise();
         if(curr_level < 0)
@@ -296,20 +309,19 @@ void Skill::calculate_balanced_level(){
     }
 }
 
-double Skill::get_balanced_level(){
+double Skill::get_balanced_level() const{
     calculate_balanced_level();
     return m_balanced_level;
 }
 
-double Skill::get_rating(bool ensure_non_zero){
-    if(m_rating < 0){
-        m_rating = DwarfStats::skills.rating(get_balanced_level());
-        if(m_rating < 0)
-            m_rating = 0;
-    }
+double Skill::get_rating(bool ensure_non_zero) const{
+    //not cached, the skill stats are rebuilt whenever the population changes
+    double rating = DwarfStats::skills.rating(get_balanced_level());
+    if(rating < 0)
+        rating = 0;
     //this is just for optimization to ensure that this rating will match the lowest possible role rating (0.0001) for comparison
-    if(ensure_non_zero && m_rating == 0)
+    if(ensure_non_zero && rating == 0)
         return 0.0001;
     else
-        return m_rating;
+        return rating;
 }
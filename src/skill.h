@@ -46,14 +46,15 @@ public:
     uint exp_for_next_level() const {return m_exp_for_next_level;}
     bool is_losing_xp() const {return m_losing_xp;}
     QString exp_summary() const;
-    QString rust_rating() const {return m_rust_rating;}
+    //! rust descriptions and colors are shared by every skill with the same rust level
+    const QString &rust_rating() const;
     int rust_level() const {return m_rust_level;}
-    //QString rust_color() const {return m_rust_color;}
-    QColor rust_color() const {return m_rust_color;}
+    const QColor &rust_color() const;
     int skill_rate() const {return m_skill_rate;}
 
     QString to_string(bool include_level = true, bool include_exp_summary = true, bool use_color = true) const;
-    const QString &name() const {return m_name;}
+    //! names live in the game data, skills only keep their id
+    QString name() const;
     bool operator<(const Skill *s2) const;
 
     struct less_than_key
@@ -67,11 +68,11 @@ public:
     static int get_xp_for_level(int level);
     static QString get_rust_level_desc(int rust_level);
 
-    double get_simulated_rating();
-    double get_simulated_level();
-    double get_rating(bool ensure_non_zero = false);
-    double get_balanced_level();
-    void calculate_balanced_level();
+    double get_simulated_rating() const;
+    double get_simulated_level() const;
+    double get_rating(bool ensure_non_zero = false) const;
+    double get_balanced_level() const;
+    void calculate_balanced_level() const;
 
 private:
     short m_id;
@@ -83,14 +84,10 @@ private:
     float m_exp_progress;
     short m_capped_level;
     short m_raw_level;
-    QString m_name;
-    QColor m_rust_color;
-    QString m_rust_rating;
     int m_skill_rate;
     int m_rust;
     bool m_losing_xp;
-    double m_rating;
-    double m_balanced_level;
+    mutable double m_balanced_level;
     int m_rust_level; //purely for grouping, higher is worse
     //skill level, experience
     static QHash<int,int> m_experience_levels;
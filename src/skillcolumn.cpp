@@ -257,7 +257,7 @@ QString SkillColumn::build_skill_desc(Dwarf *d, int skill_id){
             .arg(QString::number((int)raw_rating))
             .arg(d->get_skill(skill_id).exp_summary());
 
-        Skill s = d->get_skill(skill_id);
+        const Skill &s = d->get_skill(skill_id);
         if(s.rust_level() > 0){
             skill_str.append(QString("<br/><font color=%1><b>%2</b></font>")
                     .arg(s.rust_color().name())
@@ -38,8 +38,12 @@ Squad::Squad(int id, DFInstance *df, VIRTADDR address, QObject *parent)
     , m_id(id)
     , m_df(df)
     , m_mem(df->memory_layout())
+    , m_inactive(false)
+    , m_squad_order(ORD_UNKNOWN)
 {
-    read_data();
+    //squads without an address are filled in by their creator (synthetic populations)
+    if(m_address)
+        read_data();
 }
 
 Squad::~Squad() {
@@ -243,7 +247,7 @@ void Squad::assign_to_squad(Dwarf *d, bool committing){
         }
         VIRTADDR addr = 0;
         if(position >= 0){
-            addr = m_members_addr.at(position);
+            addr = m_members_addr.value(position, 0);
         }
         if(addr){
             m_df->write_int(addr,d->historical_id());
@@ -253,7 +257,9 @@ void Squad::assign_to_squad(Dwarf *d, bool committing){
     }else{
         position = find_position(-1); //find the first open position
         if(position >= 0){
-            m_uniforms.value(position)->clear();
+            Uniform *u = m_uniforms.value(position);
+            if(u)
+                u->clear();
             d->update_squad_info(m_id,position,m_name);
         }
     }
@@ -270,7 +276,7 @@ bool Squad::remove_from_squad(Dwarf *d, bool committing){
 
     if(position >= 0){
         if(committing){
-            VIRTADDR addr = m_members_addr.at(position);
+            VIRTADDR addr = m_members_addr.value(position, 0);
             if(!addr)
                 return false;
 
@@ -279,7 +285,9 @@ bool Squad::remove_from_squad(Dwarf *d, bool committing){
             m_df->write_int(m_df->memory_layout()->dwarf_field(d->address(), "squad_position"), -1);
 
         }else{
-            m_uniforms.value(position)->clear();
+            Uniform *u = m_uniforms.value(position);
+            if(u)
+                u->clear();
             d->update_squad_info(-1,-1,"");
         }
         m_members.insert(position,-1);
@@ -308,7 +316,10 @@ void Squad::rename_squad(QString alias){
 }
 void Squad::commit_pending(){
     if(m_name != m_pending_name){
-        if(m_df->fortress()->squad_is_active(m_id)){
+        //squads without an address (synthetic populations) only keep the new name
+        if(!m_address){
+            m_name = m_pending_name;
+        }else if(m_df->fortress()->squad_is_active(m_id)){
             m_df->write_string(m_df->memory_layout()->squad_field(m_address, "alias"),m_pending_name);
         }
     }
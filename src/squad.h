@@ -35,6 +35,7 @@ class QTreeWidgetItem;
 
 class Squad : public QObject {
     Q_OBJECT
+    friend class DFInstanceSynthetic;
 public:
     Squad(int id, DFInstance *df, VIRTADDR address, QObject *parent = 0);
     virtual ~Squad();
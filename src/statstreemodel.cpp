@@ -0,0 +1,209 @@
+/*
+Dwarf Therapist
+Copyright (c) 2009 Trey Stout (chmod)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+#include "statstreemodel.h"
+
+#include <QSet>
+
+// In QModelIndex created by this model, the internal pointer is the pointer
+// to the parent group node or nullptr for groups. Nodes are never moved, so
+// indexes of the details stay valid when other groups are removed.
+
+template<typename T>
+static inline void *void_cast(const T *ptr) { return static_cast<void *>(const_cast<T *>(ptr)); }
+
+StatsTreeModel::StatsTreeModel(const QStringList &headers, QObject *parent)
+    : QAbstractItemModel(parent)
+    , m_headers(headers)
+{
+}
+
+StatsTreeModel::~StatsTreeModel()
+{
+}
+
+QModelIndex StatsTreeModel::index(int row, int column, const QModelIndex &parent) const
+{
+    if (!hasIndex(row, column, parent))
+        return QModelIndex();
+    if (parent.isValid())
+        return createIndex(row, column, void_cast(m_groups[parent.row()].get()));
+    else
+        return createIndex(row, column, nullptr);
+}
+
+QModelIndex StatsTreeModel::parent(const QModelIndex &index) const
+{
+    auto group = static_cast<const node_t *>(index.internalPointer());
+    if (index.isValid() && group)
+        return createIndex(group->row, 0, nullptr);
+    else
+        return QModelIndex();
+}
+
+int StatsTreeModel::rowCount(const QModelIndex &parent) const
+{
+    if (!parent.isValid())
+        return m_groups.size();
+    if (parent.internalPointer() || parent.column() != 0)
+        return 0; // details have no children
+    return m_groups[parent.row()]->children.size();
+}
+
+int StatsTreeModel::columnCount(const QModelIndex &) const
+{
+    return m_headers.size();
+}
+
+QVariant StatsTreeModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid())
+        return QVariant();
+    auto group = static_cast<const node_t *>(index.internalPointer());
+    if (group)
+        return child_data(group->key, group->children.value(index.row()), index.column(), role);
+    else
+        return group_data(m_groups[index.row()]->key, index.column(), role);
+}
+
+QVariant StatsTreeModel::child_data(const QString &, const QString &, int, int) const
+{
+    return QVariant();
+}
+
+QVariant StatsTreeModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if (role != Qt::DisplayRole || orientation != Qt::Horizontal)
+        return QVariant();
+    return m_headers.value(section);
+}
+
+QString StatsTreeModel::group_key(const QModelIndex &index) const
+{
+    if (!index.isValid())
+        return QString();
+    auto group = static_cast<const node_t *>(index.internalPointer());
+    return group ? group->key : m_groups[index.row()]->key;
+}
+
+QString StatsTreeModel::child_key(const QModelIndex &index) const
+{
+    auto group = static_cast<const node_t *>(index.internalPointer());
+    if (!index.isValid() || !group)
+        return QString();
+    return group->children.value(index.row());
+}
+
+QStringList StatsTreeModel::child_keys(const QModelIndex &index) const
+{
+    if (!index.isValid() || index.internalPointer())
+        return QStringList();
+    return m_groups[index.row()]->children;
+}
+
+void StatsTreeModel::clear()
+{
+    beginResetModel();
+    m_groups.clear();
+    endResetModel();
+}
+
+void StatsTreeModel::renumber()
+{
+    for (std::size_t i = 0; i < m_groups.size(); ++i)
+        m_groups[i]->row = i;
+}
+
+void StatsTreeModel::set_layout(const std::vector<group_layout> &layout)
+{
+    if (m_groups.empty()) {
+        if (layout.empty())
+            return;
+        beginInsertRows(QModelIndex(), 0, layout.size()-1);
+        for (const auto &g: layout)
+            m_groups.emplace_back(new node_t{0, g.key, g.children});
+        renumber();
+        endInsertRows();
+        return;
+    }
+
+    QHash<QString, const group_layout *> new_groups;
+    for (const auto &g: layout)
+        new_groups.insert(g.key, &g);
+
+    // drop the groups that are gone, starting from the end to keep the rows valid
+    for (int row = m_groups.size()-1; row >= 0; --row) {
+        if (!new_groups.contains(m_groups[row]->key)) {
+            beginRemoveRows(QModelIndex(), row, row);
+            m_groups.erase(m_groups.begin()+row);
+            renumber();
+            endRemoveRows();
+        }
+    }
+
+    // update the details of the groups that are still here
+    QSet<QString> kept;
+    for (auto &node: m_groups) {
+        kept.insert(node->key);
+        const group_layout *g = new_groups.value(node->key);
+        QModelIndex parent = createIndex(node->row, 0, nullptr);
+
+        QSet<QString> new_children = g->children.toSet();
+        for (int row = node->children.size()-1; row >= 0; --row) {
+            if (!new_children.contains(node->children[row])) {
+                beginRemoveRows(parent, row, row);
+                node->children.removeAt(row);
+                endRemoveRows();
+            }
+        }
+        if (!node->children.isEmpty())
+            emit dataChanged(index(0, 0, parent), index(node->children.size()-1, columnCount()-1, parent));
+
+        QSet<QString> old_children = node->children.toSet();
+        QStringList added;
+        for (const auto &child: g->children) {
+            if (!old_children.contains(child))
+                added.append(child);
+        }
+        if (!added.isEmpty()) {
+            beginInsertRows(parent, node->children.size(), node->children.size()+added.size()-1);
+            node->children.append(added);
+            endInsertRows();
+        }
+    }
+    if (!m_groups.empty())
+        emit dataChanged(index(0, 0), index(m_groups.size()-1, columnCount()-1));
+
+    // and append the new ones
+    std::vector<const group_layout *> added;
+    for (const auto &g: layout) {
+        if (!kept.contains(g.key))
+            added.push_back(&g);
+    }
+    if (!added.empty()) {
+        beginInsertRows(QModelIndex(), m_groups.size(), m_groups.size()+added.size()-1);
+        for (auto g: added)
+            m_groups.emplace_back(new node_t{0, g->key, g->children});
+        renumber();
+        endInsertRows();
+    }
+}
@@ -0,0 +1,91 @@
+/*
+Dwarf Therapist
+Copyright (c) 2009 Trey Stout (chmod)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+#ifndef STATS_TREE_MODEL_H
+#define STATS_TREE_MODEL_H
+
+#include <QAbstractItemModel>
+#include <QStringList>
+#include <memory>
+#include <vector>
+
+/**
+ * Two level model (groups and their details) over the population
+ * aggregates shown in the docks.
+ *
+ * Rows are identified by string keys: set_layout only inserts and removes
+ * the rows whose keys changed and updates the others in place. Subclasses
+ * keep their own copy of the aggregates and compute every role, tooltips
+ * included, when a view asks for it.
+ */
+class StatsTreeModel: public QAbstractItemModel
+{
+    Q_OBJECT
+public:
+    StatsTreeModel(const QStringList &headers, QObject *parent = nullptr);
+    virtual ~StatsTreeModel();
+
+    QModelIndex index(int row, int column, const QModelIndex &parent = QModelIndex()) const override;
+    QModelIndex parent(const QModelIndex &index) const override;
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+
+    // Returns an empty string for invalid indexes
+    QString group_key(const QModelIndex &index) const;
+    // Returns an empty string for invalid indexes and groups
+    QString child_key(const QModelIndex &index) const;
+    // Keys of the children of the group at index
+    QStringList child_keys(const QModelIndex &index) const;
+
+public slots:
+    void clear();
+
+protected:
+    struct group_layout
+    {
+        QString key;
+        QStringList children;
+    };
+    // Replace the rows with layout, rows with unchanged keys are kept and updated
+    void set_layout(const std::vector<group_layout> &layout);
+
+    virtual QVariant group_data(const QString &group, int column, int role) const = 0;
+    virtual QVariant child_data(const QString &group, const QString &child, int column, int role) const;
+
+private:
+    struct node_t
+    {
+        int row;
+        QString key;
+        QStringList children;
+    };
+    std::vector<std::unique_ptr<node_t>> m_groups;
+    QStringList m_headers;
+
+    void renumber();
+};
+
+#endif
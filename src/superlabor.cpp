@@ -75,7 +75,7 @@ SuperLabor::~SuperLabor() {
 }
 
 void SuperLabor::load_cp_labors(CustomProfession *cp){
-    m_active_labors.clear();
+    clear_labors();
     m_selected_count = 0;
     if(cp){
         QList<Labor*> labors = gdr->get_ordered_labors();
@@ -27,146 +27,236 @@ THE SOFTWARE.
 #include "dfinstance.h"
 #include "thought.h"
 #include "emotion.h"
-#include "emotiongroup.h"
 #include "adaptivecolorfactory.h"
+#include "searchfiltertreeview.h"
+#include "utils.h"
 
+#include <QCloseEvent>
+#include <QHeaderView>
 #include <QPainter>
+#include <QPushButton>
+#include <QTreeView>
+#include <QVBoxLayout>
 
-ThoughtsWidget::ThoughtsWidget(QWidget *parent)
-    : BaseTreeWidget(true, parent)
+ThoughtsModel::ThoughtsModel(QObject *parent)
+    : StatsTreeModel(QStringList() << tr("Thought/Emotion") << tr("Strength") << tr("Count"), parent)
 {
-    m_tree_view->setColumnCount(3);
-    m_tree_view->setHeaderLabels(QStringList() << tr("Thought/Emotion") << tr("Strength") << tr("Count"));
-    m_tree_view->setItemDelegate(new ThoughtsItemDelegate(m_tree_view));
 }
 
-void ThoughtsWidget::build_tree(){
-    QHash<int, EmotionGroup*> emotions = DT->get_DFInstance()->get_emotion_stats();
-    QString tooltip;
-    foreach(int id, emotions.uniqueKeys()){
-        Thought *t = GameDataReader::ptr()->get_thought(id);
-        EmotionGroup *eg = emotions.value(id);
+void ThoughtsModel::refresh(DFInstance *df){
+    m_thoughts.clear();
+    std::vector<group_layout> layout;
+    if(df){
+        GameDataReader *gdr = GameDataReader::ptr();
+        QHash<int, EmotionGroup*> emotions = df->get_emotion_stats();
+        for(auto it = emotions.constBegin(); it != emotions.constEnd(); ++it){
+            if(!gdr->get_thought(it.key()))
+                continue;
+            EmotionGroup *eg = it.value();
+            //copy the counts, the groups are rebuilt by the next read
+            thought_row row;
+            row.stress_units = eg->get_stress_unit_count();
+            row.unaffected_units = eg->get_unaffected_unit_count();
+            row.eustress_units = eg->get_eustress_unit_count();
+            row.totals << eg->get_stress_count() << eg->get_unaffected_count() << eg->get_eustress_count();
+            row.occurrences = eg->get_total_occurrances();
+            row.details = eg->get_details();
+
+            group_layout g;
+            g.key = QString::number(it.key());
+            foreach(EMOTION_TYPE e_type, row.details.keys()){
+                if(gdr->get_emotion(e_type))
+                    g.children.append(QString::number(e_type));
+            }
+            if(g.children.isEmpty())
+                continue;
+            m_thoughts.insert(g.key, row);
+            layout.push_back(g);
+        }
+    }
+    set_layout(layout);
+}
 
-        int stress_count = eg->get_stress_unit_count();
-        int unaffected_count = eg->get_unaffected_unit_count();
-        int eustress_count = eg->get_eustress_unit_count();
+QVariant ThoughtsModel::group_data(const QString &group, int column, int role) const{
+    auto it = m_thoughts.find(group);
+    Thought *t = GameDataReader::ptr()->get_thought(group.toInt());
+    if(it == m_thoughts.end() || !t)
+        return QVariant();
+    const thought_row &row = *it;
+
+    switch(role){
+    case Qt::DisplayRole:
+        if(column == 0)
+            return capitalize(t->title());
+        break;
+    case Qt::ToolTipRole:
+    {
         QStringList stress_desc;
-
-        if(stress_count > 0)
-            stress_desc.append(tr("%1 felt negative emotions which added to their stress.").arg(stress_count));
-        if(unaffected_count > 0)
-            stress_desc.append(tr("%1 were unaffected.").arg(unaffected_count));
-        if(eustress_count > 0)
-            stress_desc.append(tr("%1 felt positive emotions which reduced stress.").arg(eustress_count));
-
-        tooltip = QString("<center><h4>%1</h4></center>%2<br/><br/>%3")
+        if(row.stress_units > 0)
+            stress_desc.append(tr("%1 felt negative emotions which added to their stress.").arg(row.stress_units));
+        if(row.unaffected_units > 0)
+            stress_desc.append(tr("%1 were unaffected.").arg(row.unaffected_units));
+        if(row.eustress_units > 0)
+            stress_desc.append(tr("%1 felt positive emotions which reduced stress.").arg(row.eustress_units));
+
+        return QString("<center><h4>%1</h4></center>%2<br/><br/>%3")
                 .arg(capitalize(t->title()))
                 .arg(tr("Felt ... ") + t->desc())
                 .arg(stress_desc.join("<br/><br/>"));
+    }
+    case Qt::UserRole:
+        return group.toInt();
+    case TotalsRole:
+        return row.totals;
+    case SortRole:
+        if(column == 0)
+            return t->title().toLower();
+        else if(column == 2)
+            return row.occurrences;
+        break;
+    case UnitIdsRole:
+    {
+        QVariantList ids;
+        foreach(const EmotionGroup::emotion_count &ec, row.details){
+            foreach(int id, ec.unit_ids)
+                ids.append(id);
+        }
+        return ids;
+    }
+    }
+    return QVariant();
+}
 
-        SortableTreeItem* thought_node = new SortableTreeItem();
-        thought_node->setData(0, Qt::UserRole, id);
-        thought_node->setText(0, capitalize(t->title()));
-        thought_node->setToolTip(0,tooltip);
-
-        QVariantList total_counts;
-        total_counts << eg->get_stress_count() << eg->get_unaffected_count() << eg->get_eustress_count();
-        thought_node->setData(0,Qt::UserRole+1, total_counts);
-
-        //custom sorting
-        thought_node->setData(0,SortableTreeItem::TREE_SORT_COL,t->title().toLower());
-        thought_node->setData(2,SortableTreeItem::TREE_SORT_COL+2,eg->get_total_occurrances());
+QVariant ThoughtsModel::child_data(const QString &group, const QString &child, int column, int role) const{
+    auto it = m_thoughts.find(group);
+    EMOTION_TYPE e_type = static_cast<EMOTION_TYPE>(child.toInt());
+    Emotion *e = GameDataReader::ptr()->get_emotion(e_type);
+    if(it == m_thoughts.end() || !e)
+        return QVariant();
+    const EmotionGroup::emotion_count ec = it->details.value(e_type);
+
+    //use the inverted stress divisor as the strength of the emotion
+    int strength = e->get_divider();
+    if(strength != 0)
+        strength = -8/strength;
+
+    switch(role){
+    case Qt::DisplayRole:
+        if(column == 0)
+            return e->get_name();
+        else if(column == 1)
+            return QString("%1").arg(strength);
+        else
+            return QString("%1").arg(ec.count,2,10,QChar('0'));
+    case Qt::TextColorRole:
+        if(column == 0)
+            return AdaptiveColorFactory().color(e->get_color());
+        break;
+    case Qt::TextAlignmentRole:
+        if(column == 1)
+            return Qt::AlignCenter;
+        else if(column == 2)
+            return Qt::AlignRight;
+        break;
+    case Qt::ToolTipRole:
+    {
+        //only resolve the names when they're shown
+        QStringList unit_names = DT->get_unit_names(ec.unit_ids.toList());
+        return QString("<center><h4><font color=%1>%2</font></h4></center>%3%4")
+                .arg(e->get_color().name())
+                .arg(e->get_name())
+                .arg(ec.count != ec.unit_ids.count() ? tr("This circumstance occurred %1 times among %2 citizens.<br/><br/>").arg(ec.count).arg(ec.unit_ids.count()) : "")
+                .arg(unit_names.join(unit_names.size() < 20 ? "<br/>" : ", "));
+    }
+    case Qt::UserRole:
+        return e_type;
+    case SortRole:
+        if(column == 0)
+            return e->get_name().toLower();
+        else if(column == 1)
+            return strength;
+        else
+            return ec.count;
+    case UnitIdsRole:
+    {
+        QVariantList ids;
+        foreach(int id, ec.unit_ids)
+            ids.append(id);
+        return ids;
+    }
+    }
+    return QVariant();
+}
 
-        //add parent node
-        AdaptiveColorFactory adaptive;
-        foreach(EMOTION_TYPE e_type, eg->get_details().uniqueKeys()){
-            Emotion *e = GameDataReader::ptr()->get_emotion(e_type);
-            if(e){
-                EmotionGroup::emotion_count ec = eg->get_details().value(e_type);
-
-                QString emotion_desc;
-
-                emotion_desc = e->get_name();
-
-                SortableTreeItem *emotion_node = new SortableTreeItem(thought_node);
-                QStringList unit_names = ec.unit_ids.keys();
-                tooltip = QString("<center><h4><font color=%1>%2</font></h4></center>%3%4")
-                        .arg(e->get_color().name())
-                        .arg(e->get_name())
-                        .arg(ec.count != ec.unit_ids.count() ? tr("This circumstance occurred %1 times among %2 citizens.<br/><br/>").arg(ec.count).arg(ec.unit_ids.count()) : "")
-                        .arg(unit_names.join(unit_names.size() < 20 ? "<br/>" : ", "));
-
-                emotion_node->setData(0, Qt::UserRole, e_type);
-                emotion_node->setData(0,Qt::TextColorRole, adaptive.color(e->get_color()));
-                emotion_node->setToolTip(0, tooltip);
-                emotion_node->setText(0, emotion_desc);
-
-                //use the inverted stress divisor as the strength of the emotion
-                int strength = e->get_divider();
-                if(strength != 0)
-                    strength = -8/strength;
-
-                emotion_node->setToolTip(1, tooltip);
-                emotion_node->setText(1,QString("%1").arg(strength));
-                emotion_node->setTextAlignment(1,Qt::AlignCenter);
-
-                emotion_node->setData(2, Qt::UserRole, ec.unit_ids.values());
-                emotion_node->setToolTip(2, tooltip);
-                emotion_node->setText(2,QString("%1").arg(ec.count,2,10,QChar('0')));
-                emotion_node->setTextAlignment(2,Qt::AlignRight);
-
-                //custom sorting
-                emotion_node->setData(0,SortableTreeItem::TREE_SORT_COL,e->get_name().toLower());
-                emotion_node->setData(1,SortableTreeItem::TREE_SORT_COL+1,strength);
-                emotion_node->setData(2,SortableTreeItem::TREE_SORT_COL+2,ec.count);
+ThoughtsWidget::ThoughtsWidget(QWidget *parent)
+    : QWidget(parent)
+    , m_model(new ThoughtsModel(this))
+{
+    QVBoxLayout *l = new QVBoxLayout();
+    setLayout(l);
+
+    m_tree = new SearchFilterTreeView(this);
+    m_tree->set_filter_mode(SortFilterProxyModel::RecursiveMode);
+    m_tree->set_model(m_model);
+    m_tree->filter_proxy().setSortRole(ThoughtsModel::SortRole);
+    m_tree->view()->setSelectionMode(QAbstractItemView::ExtendedSelection);
+    m_tree->view()->setItemDelegate(new ThoughtsItemDelegate(m_tree->view()));
+    m_tree->view()->sortByColumn(2,Qt::DescendingOrder); //count
+
+    QPushButton *btn = new QPushButton(tr("Clear Filter"),this);
+    l->addWidget(m_tree);
+    l->addWidget(btn);
+
+    connect(btn, SIGNAL(clicked()), this, SLOT(clear_filter()));
+    connect(m_tree, SIGNAL(item_selection_changed(const QItemSelection &, const QItemSelection &)),
+            this, SLOT(selection_changed()));
+    //thoughts span the whole row, their totals are drawn by the delegate
+    connect(&m_tree->filter_proxy(), SIGNAL(rowsInserted(QModelIndex,int,int)), this, SLOT(span_thoughts()));
+    connect(&m_tree->filter_proxy(), SIGNAL(layoutChanged()), this, SLOT(span_thoughts()));
+    connect(&m_tree->filter_proxy(), SIGNAL(modelReset()), this, SLOT(span_thoughts()));
+
+    if(DT){
+        connect(DT,SIGNAL(units_refreshed()),this,SLOT(refresh()));
+    }
+}
 
-            }
-            m_tree_view->addTopLevelItem(thought_node);
-            thought_node->setFirstColumnSpanned(true);
-        }
+void ThoughtsWidget::refresh(){
+    m_model->refresh(DT ? DT->get_DFInstance() : nullptr);
+    for(int i = 1; i < m_model->columnCount(); i++){
+        m_tree->view()->resizeColumnToContents(i);
     }
-    m_tree_view->sortByColumn(2,Qt::DescendingOrder); //count
 }
 
-void ThoughtsWidget::search_tree(QString val){
-    val = "(" + val.replace(" ", "|") + ")";
-    QRegExp filter = QRegExp(val,Qt::CaseInsensitive, QRegExp::RegExp);
-    int hidden;
-    bool parent_matches;
-    for(int i = 0; i < m_tree_view->topLevelItemCount(); i++){
-        hidden = 0;
-        parent_matches = m_tree_view->topLevelItem(i)->text(0).contains(filter);
-        int count;
-        for(count = 0; count < m_tree_view->topLevelItem(i)->childCount(); count++){
-            if(!parent_matches && !m_tree_view->topLevelItem(i)->child(count)->text(0).contains(filter)){
-                m_tree_view->topLevelItem(i)->child(count)->setHidden(true);
-                hidden++;
-            }else{
-                m_tree_view->topLevelItem(i)->child(count)->setHidden(false);
-            }
-        }
-        if(hidden == count){
-            m_tree_view->topLevelItem(i)->setHidden(true);
-        }else{
-            m_tree_view->topLevelItem(i)->setHidden(false);
-        }
+void ThoughtsWidget::clear(){
+    m_model->clear();
+}
+
+void ThoughtsWidget::span_thoughts(){
+    const QSortFilterProxyModel &proxy = m_tree->filter_proxy();
+    for(int row = 0; row < proxy.rowCount(); row++){
+        m_tree->view()->setFirstColumnSpanned(row, QModelIndex(), true);
     }
 }
 
 void ThoughtsWidget::selection_changed(){
     QVariantList ids; //dwarf ids
-    foreach(QTreeWidgetItem *item, m_tree_view->selectedItems()){
-        if(item->childCount() <= 0){
-            ids.append(item->data(2,Qt::UserRole).toList());
-        }else{
-            for(int idx=0;idx < item->childCount();idx++){
-                ids.append(item->child(idx)->data(2,Qt::UserRole).toList());
-            }
-        }
+    foreach(QModelIndex index, m_tree->get_selection().indexes()){
+        if(index.column() == 0)
+            ids.append(index.data(ThoughtsModel::UnitIdsRole).toList());
     }
     emit item_selected(ids);
 }
 
+void ThoughtsWidget::clear_filter(){
+    m_tree->view()->clearSelection();
+}
+
+void ThoughtsWidget::closeEvent(QCloseEvent *event){
+    m_tree->clear_search();
+    clear_filter();
+    event->accept();
+}
+
 void ThoughtsItemDelegate::paint(QPainter *painter, const QStyleOptionViewItem &option,const QModelIndex &index) const {
     QStyledItemDelegate::paint(painter, option, index);
 
@@ -177,7 +267,7 @@ void ThoughtsItemDelegate::paint(QPainter *painter, const QStyleOptionViewItem &
 
         painter->save();
 
-        QVariantList counts = index.data(Qt::UserRole+1).toList();
+        QVariantList counts = index.data(ThoughtsModel::TotalsRole).toList();
         QColor default_pen = painter->pen().color();
         QString curr_text = "";
         //draw the eustress count
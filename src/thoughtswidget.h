@@ -23,29 +23,69 @@ THE SOFTWARE.
 #ifndef THOUGHTSWIDGET_H
 #define THOUGHTSWIDGET_H
 
-#include "basetreewidget.h"
+#include "statstreemodel.h"
+#include "emotiongroup.h"
+#include <QHash>
 #include <QString>
 #include <QStyledItemDelegate>
+#include <QWidget>
 
 class QPainter;
 class QStyleOptionViewItem;
 class QColor;
+class DFInstance;
+class SearchFilterTreeView;
 
-class ThoughtsWidget : public BaseTreeWidget {
+class ThoughtsModel: public StatsTreeModel {
+    Q_OBJECT
+public:
+    ThoughtsModel(QObject *parent = nullptr);
+
+    void refresh(DFInstance *df);
+
+    static constexpr auto TotalsRole = Qt::UserRole+1; //!< stress/unaffected/eustress occurrences of a thought
+    static constexpr auto SortRole = Qt::UserRole+2;
+    static constexpr auto UnitIdsRole = Qt::UserRole+3;
+
+protected:
+    QVariant group_data(const QString &group, int column, int role) const override;
+    QVariant child_data(const QString &group, const QString &child, int column, int role) const override;
+
+private:
+    struct thought_row {
+        int stress_units;
+        int unaffected_units;
+        int eustress_units;
+        QVariantList totals;
+        int occurrences;
+        QHash<EMOTION_TYPE, EmotionGroup::emotion_count> details;
+    };
+    QHash<QString, thought_row> m_thoughts;
+};
+
+class ThoughtsWidget : public QWidget {
     Q_OBJECT
 public:
     ThoughtsWidget(QWidget *parent = nullptr);
 
+public slots:
+    void refresh();
+    void clear();
+
 protected:
-    void search_tree(QString val);
-    void build_tree();
+    void closeEvent(QCloseEvent *event);
 
 protected slots:
     void selection_changed();
+    void clear_filter();
+    void span_thoughts();
 
 signals:
     void item_selected(QVariantList);
 
+private:
+    ThoughtsModel *m_model;
+    SearchFilterTreeView *m_tree;
 };
 
 class ThoughtsItemDelegate : public QStyledItemDelegate {
@@ -25,7 +25,6 @@ THE SOFTWARE.
 #include "dwarfmodel.h"
 #include "dwarf.h"
 #include "dwarftherapist.h"
-#include "defaultfonts.h"
 
 #include <QFont>
 #include <QFontMetrics>
@@ -57,7 +56,7 @@ QStandardItem *TrainedColumn::build_cell(Dwarf *d){
 
     QChar sym_master(0x263C); //masterwork symbol in df
     QChar sym_exceptional(0x2261); //3 horizontal lines
-    QFontMetrics fm(DT->user_settings()->value("options/grid/font", QFont(DefaultFonts::getRowFontName(), DefaultFonts::getRowFontSize())).value<QFont>());
+    QFontMetrics fm(DT->settings().grid_font);
     bool symbols_ok = false;
     if(fm.inFont(sym_master) && fm.inFont(sym_exceptional)){
         symbols_ok = true;
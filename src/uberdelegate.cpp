@@ -31,20 +31,30 @@ THE SOFTWARE.
 #include "dwarftherapist.h"
 #include "skill.h"
 #include "labor.h"
-#include "defaultfonts.h"
 #include "item.h"
 
 #include "viewcolumn.h"
 #include "gridview.h"
+#include "glyphatlas.h"
+#include "profiler.h"
 
 #include <QPainter>
 #include <QSettings>
+#include <QStandardItemModel>
 
 const float UberDelegate::MIN_DRAW_SIZE = 0.05625f;
 const float UberDelegate::MAX_CELL_FILL = 0.76f;
+const int UberDelegate::GLYPH_STEPS = 256;
+
+namespace {
+//glyph kinds, value glyphs are offset by their shape
+const int GK_BG = 0;
+const int GK_VALUE = 1;
+}
 
 UberDelegate::UberDelegate(QObject *parent)
     : QStyledItemDelegate(parent)
+    , m_atlas(new GlyphAtlas)
     , m_model(0)
     , m_proxy(0)
 {
@@ -71,6 +81,9 @@ UberDelegate::UberDelegate(QObject *parent)
                     << QPointF(0.25, 0.5); // left
 }
 
+UberDelegate::~UberDelegate(){
+}
+
 void UberDelegate::read_settings() {
     QSettings *s = DT->user_settings();
     s->beginGroup("options");
@@ -89,22 +102,29 @@ void UberDelegate::read_settings() {
     color_border = s->value("border").value<QColor>();
     s->endGroup(); //colors
     s->beginGroup("grid");
-    cell_size = s->value("cell_size", DEFAULT_CELL_SIZE).toInt();
-    cell_padding = s->value("cell_padding", 0).toInt();
-    cell_size += (cell_padding*2)+2; //increase the cell size by padding
     m_skill_drawing_method = static_cast<SKILL_DRAWING_METHOD>(s->value("skill_drawing_method", SDM_NUMERIC).toInt());
     draw_happiness_icons = s->value("happiness_icons",false).toBool();
     color_mood_cells = s->value("color_mood_cells",false).toBool();
     color_health_cells = s->value("color_health_cells",true).toBool();
     color_attribute_syns = s->value("color_attribute_syns",true).toBool();
     color_pref_matches = s->value("color_pref_matches",false).toBool();
-    m_fnt = s->value("font", QFont(DefaultFonts::getRowFontName(), DefaultFonts::getRowFontSize())).value<QFont>();
-    gradient_cell_bg = s->value("shade_cells",true).toBool();
     s->endGroup(); //grid
     s->endGroup(); //options
+
+    const SettingsSnapshot &opts = DT->settings();
+    cell_size = opts.cell_size;
+    cell_padding = opts.cell_padding;
+    cell_size += (cell_padding*2)+2; //increase the cell size by padding
+    m_fnt = opts.grid_font;
+    gradient_cell_bg = opts.shade_cells;
+
+    //colors, sizes and fonts are baked into the cached glyphs
+    if(m_atlas)
+        m_atlas->clear();
 }
 
 void UberDelegate::paint(QPainter *p, const QStyleOptionViewItem &opt, const QModelIndex &proxy_idx) const {
+    PROFILE_SCOPE_CAT("paint_cell", "view");
     if (!proxy_idx.isValid()) {
         return;
     }
@@ -139,22 +159,30 @@ void UberDelegate::paint_cell(QPainter *p, const QStyleOptionViewItem &opt, cons
     if (m_proxy)
         model_idx = m_proxy->mapToSource(idx);
 
-    COLUMN_TYPE type = static_cast<COLUMN_TYPE>(model_idx.data(DwarfModel::DR_COL_TYPE).toInt());
+    //read the roles straight from the item rather than through the proxy for each one
+    const QStandardItemModel *item_model = qobject_cast<const QStandardItemModel*>(model_idx.model());
+    const QStandardItem *item = item_model ? item_model->itemFromIndex(model_idx) : 0;
+    auto cell_data = [item, &model_idx](int role) {
+        return item ? item->data(role) : model_idx.data(role);
+    };
+
+    COLUMN_TYPE type = static_cast<COLUMN_TYPE>(cell_data(DwarfModel::DR_COL_TYPE).toInt());
     QRect adjusted = opt.rect.adjusted(cell_padding, cell_padding, -cell_padding, -cell_padding);
 
-    float rating = model_idx.data(DwarfModel::DR_RATING).toFloat();
-    QString text_rating = model_idx.data(DwarfModel::DR_DISPLAY_RATING).toString();
+    float rating = cell_data(DwarfModel::DR_RATING).toFloat();
+    QString text_rating = cell_data(DwarfModel::DR_DISPLAY_RATING).toString();
+    QColor default_bg = cell_data(DwarfModel::DR_DEFAULT_BG_COLOR).value<QColor>();
     float limit = 100.0;
 
     Dwarf *d = 0;
     if(m_model){
-        d = m_model->get_dwarf_by_id(idx.data(DwarfModel::DR_ID).toInt());
+        d = m_model->get_dwarf_by_id(cell_data(DwarfModel::DR_ID).toInt());
     }
 //    if(!d && !drawing_aggregate){
 //        return QStyledItemDelegate::paint(p, opt, idx);
 //    }
 
-    int state = idx.data(DwarfModel::DR_STATE).toInt();
+    int state = cell_data(DwarfModel::DR_STATE).toInt();
     QColor state_color = QColor(Qt::transparent);
     if(m_model){
         ViewColumn *vc = m_model->current_grid_view()->get_column(idx.column());
@@ -166,24 +194,24 @@ void UberDelegate::paint_cell(QPainter *p, const QStyleOptionViewItem &opt, cons
     switch (type) {
     case CT_SKILL:
     {
-        QColor bg = paint_bg(adjusted, p, opt, idx);
+        QColor bg = paint_bg(adjusted, p, opt, default_bg);
         limit = 15.0;
         if(rating >= 0){
-            paint_values(adjusted, rating, text_rating, bg, p, opt, idx, 0, 0, limit, 0, 0);
+            paint_values(adjusted, rating, text_rating, bg, p, opt, 0, 0, limit, 0, 0);
         }
         if(d){
-            paint_mood_cell(adjusted,p,opt,idx,model_idx.data(DwarfModel::DR_OTHER_ID).toInt(),false,d);
+            paint_mood_cell(adjusted,p,opt,idx,cell_data(DwarfModel::DR_OTHER_ID).toInt(),false,d);
         }
     }
         break;
     case CT_LABOR:
     {
         if (!drawing_aggregate && d) {
-            int labor_id = idx.data(DwarfModel::DR_LABOR_ID).toInt();
-            QColor bg = paint_bg_active(adjusted,d->labor_enabled(labor_id),p,opt,idx,state,state_color);
+            int labor_id = cell_data(DwarfModel::DR_LABOR_ID).toInt();
+            QColor bg = paint_bg_active(adjusted, d->labor_enabled(labor_id), p, opt, default_bg,state,state_color);
             limit = 15.0;
             if(rating >= 0){
-                paint_values(adjusted, rating, text_rating, bg, p, opt, idx, 0, 0, limit, 0, 0);
+                paint_values(adjusted, rating, text_rating, bg, p, opt, 0, 0, limit, 0, 0);
             }
             paint_mood_cell(adjusted,p,opt,idx,GameDataReader::ptr()->get_labor(labor_id)->skill_id, d->is_labor_state_dirty(labor_id),d);
         }else {
@@ -194,7 +222,7 @@ void UberDelegate::paint_cell(QPainter *p, const QStyleOptionViewItem &opt, cons
     case CT_HAPPINESS:
     case CT_FOCUS:
     {
-        paint_bg(adjusted, p, opt, idx, true, state_color);
+        paint_bg(adjusted, p, opt, default_bg, true, state_color);
         if(draw_happiness_icons || (d && d->in_stressed_mood())){
             paint_icon(adjusted,p,opt,idx);
         }else{
@@ -204,14 +232,14 @@ void UberDelegate::paint_cell(QPainter *p, const QStyleOptionViewItem &opt, cons
         break;
     case CT_EQUIPMENT:
     {
-        Item::ITEM_STATE i_status = static_cast<Item::ITEM_STATE>(idx.data(DwarfModel::DR_SPECIAL_FLAG).toInt());
-        paint_bg(adjusted, p, opt, idx, true, state_color);
+        Item::ITEM_STATE i_status = static_cast<Item::ITEM_STATE>(cell_data(DwarfModel::DR_SPECIAL_FLAG).toInt());
+        paint_bg(adjusted, p, opt, default_bg, true, state_color);
         paint_wear_cell(adjusted,p,opt,idx,i_status);
     }
         break;
     case CT_ITEMTYPE:
     {
-        QColor bg = paint_bg(adjusted, p, opt, idx, true, model_idx.data(Qt::BackgroundColorRole).value<QColor>());
+        QColor bg = paint_bg(adjusted, p, opt, default_bg, true, cell_data(Qt::BackgroundColorRole).value<QColor>());
         //if we're drawing numbers, we only want to draw counts for squads
         //this is a special case because we're drawing different information if it's text mode
         if(m_skill_drawing_method == SDM_NUMERIC && rating == 100)
@@ -219,9 +247,9 @@ void UberDelegate::paint_cell(QPainter *p, const QStyleOptionViewItem &opt, cons
 
         if(rating != 100){
             //only show red squares for missing items (0-50 rating)
-            paint_values(adjusted, rating/2.0f, text_rating, bg, p, opt, idx, 50.0f,5.0f,95.0f,0,0,false);
+            paint_values(adjusted, rating/2.0f, text_rating, bg, p, opt, 50.0f,5.0f,95.0f,0,0,false);
         }
-        Item::ITEM_STATE i_status = static_cast<Item::ITEM_STATE>(idx.data(DwarfModel::DR_SPECIAL_FLAG).toInt());
+        Item::ITEM_STATE i_status = static_cast<Item::ITEM_STATE>(cell_data(DwarfModel::DR_SPECIAL_FLAG).toInt());
         paint_wear_cell(adjusted,p,opt,idx,i_status);
     }
         break;
@@ -232,7 +260,7 @@ void UberDelegate::paint_cell(QPainter *p, const QStyleOptionViewItem &opt, cons
         bool cp_border = false;
 
         if(type == CT_CUSTOM_PROFESSION){
-            QString custom_prof_name = idx.data(DwarfModel::DR_CUSTOM_PROF).toString();
+            QString custom_prof_name = cell_data(DwarfModel::DR_CUSTOM_PROF).toString();
             if(!custom_prof_name.isEmpty()){
                 if(d && d->profession() == custom_prof_name){
                     cp_border = true;
@@ -246,8 +274,8 @@ void UberDelegate::paint_cell(QPainter *p, const QStyleOptionViewItem &opt, cons
         int min_alpha = 75;
 
         if(d && d->can_set_labors()){
-            if(idx.data(DwarfModel::DR_LABORS).canConvert<QVariantList>()){
-                QVariantList labors = idx.data(DwarfModel::DR_LABORS).toList();
+            if(cell_data(DwarfModel::DR_LABORS).canConvert<QVariantList>()){
+                QVariantList labors = cell_data(DwarfModel::DR_LABORS).toList();
                 int active_count = 0;
                 int dirty_count = 0;
                 foreach(QVariant id, labors){
@@ -289,13 +317,13 @@ void UberDelegate::paint_cell(QPainter *p, const QStyleOptionViewItem &opt, cons
         if(is_active){
             bg_color.setAlpha(active_alpha);
         }
-        bg = paint_bg_active(adjusted, is_active, p, opt, idx, state, bg_color);
+        bg = paint_bg_active(adjusted, is_active, p, opt, default_bg, state, bg_color);
 
         if(type == CT_ROLE){
-            paint_values(adjusted, rating, text_rating, bg, p, opt, idx, 50.0f, 5.0f, 95.0f, 42.5f, 57.5f);
+            paint_values(adjusted, rating, text_rating, bg, p, opt, 50.0f, 5.0f, 95.0f, 42.5f, 57.5f);
         }else if(rating >= 0){
             limit = 15.0f;
-            paint_values(adjusted, rating, text_rating, bg, p, opt, idx, 0, 0, limit, 0, 0);
+            paint_values(adjusted, rating, text_rating, bg, p, opt, 0, 0, limit, 0, 0);
         }
 
         if(is_dirty){ //dirty border always has priority
@@ -307,7 +335,7 @@ void UberDelegate::paint_cell(QPainter *p, const QStyleOptionViewItem &opt, cons
             paint_border(adjusted,p,color_active_labor);
             paint_grid(adjusted, false, p, opt, idx,false);
         }else{ //normal border, or role pref border
-            int pref_alpha = idx.data(DwarfModel::DR_SPECIAL_FLAG).toInt();
+            int pref_alpha = cell_data(DwarfModel::DR_SPECIAL_FLAG).toInt();
             if(color_pref_matches && type == CT_ROLE && pref_alpha > 0){
                 if(pref_alpha < min_alpha)
                     pref_alpha = min_alpha;
@@ -326,22 +354,22 @@ void UberDelegate::paint_cell(QPainter *p, const QStyleOptionViewItem &opt, cons
         break;
     case CT_IDLE:
     {
-        paint_bg(adjusted, p, opt, idx, true, model_idx.data(Qt::BackgroundColorRole).value<QColor>());
+        paint_bg(adjusted, p, opt, default_bg, true, cell_data(Qt::BackgroundColorRole).value<QColor>());
         paint_icon(adjusted,p,opt,idx);
     }
         break;
     case CT_PROFESSION:
     {
-        paint_bg(adjusted, p, opt, idx, true, model_idx.data(Qt::BackgroundColorRole).value<QColor>());
+        paint_bg(adjusted, p, opt, default_bg, true, cell_data(Qt::BackgroundColorRole).value<QColor>());
         paint_icon(adjusted,p,opt,idx);
     }
         break;
     case CT_HIGHEST_MOOD:
     {
-        paint_bg(adjusted, p, opt, idx, true, model_idx.data(Qt::BackgroundColorRole).value<QColor>());
+        paint_bg(adjusted, p, opt, default_bg, true, cell_data(Qt::BackgroundColorRole).value<QColor>());
         paint_icon(adjusted,p,opt,idx);
 
-        bool had_mood = idx.data(DwarfModel::DR_SPECIAL_FLAG).toBool();
+        bool had_mood = cell_data(DwarfModel::DR_SPECIAL_FLAG).toBool();
         if(had_mood){
             p->save();
             QRect moodr = adjusted;
@@ -354,11 +382,11 @@ void UberDelegate::paint_cell(QPainter *p, const QStyleOptionViewItem &opt, cons
         break;
     case CT_TRAIT: case CT_BELIEF:
     {
-        QColor bg = paint_bg(adjusted, p, opt, idx);
+        QColor bg = paint_bg(adjusted, p, opt, default_bg);
         if(type==CT_TRAIT && rating == -1)
             rating = 50; //don't draw if the unit doesn't have the trait at all
-        paint_values(adjusted, rating, text_rating, bg, p, opt, idx, 50, 10, 90);
-        int alpha = idx.data(DwarfModel::DR_SPECIAL_FLAG).toInt();
+        paint_values(adjusted, rating, text_rating, bg, p, opt, 50, 10, 90);
+        int alpha = cell_data(DwarfModel::DR_SPECIAL_FLAG).toInt();
         if(alpha > 0){
             paint_border(adjusted,p,QColor(168, 10, 44, alpha));
             paint_grid(adjusted, false, p, opt, idx, false);
@@ -369,10 +397,10 @@ void UberDelegate::paint_cell(QPainter *p, const QStyleOptionViewItem &opt, cons
         break;
     case CT_ATTRIBUTE:
     {
-        QColor bg = paint_bg(adjusted, p, opt, idx);
-        paint_values(adjusted, rating, text_rating, bg, p, opt, idx, 50.0f, 2.0f, 98.0f,30.0f,70.0f);
+        QColor bg = paint_bg(adjusted, p, opt, default_bg);
+        paint_values(adjusted, rating, text_rating, bg, p, opt, 50.0f, 2.0f, 98.0f,30.0f,70.0f);
 
-        if(color_attribute_syns && idx.data(DwarfModel::DR_SPECIAL_FLAG).toInt() > 0){
+        if(color_attribute_syns && cell_data(DwarfModel::DR_SPECIAL_FLAG).toInt() > 0){
             paint_border(adjusted,p,Attribute::color_affected_by_syns());
             paint_grid(adjusted, false, p, opt, idx, false);
         }else{
@@ -382,8 +410,8 @@ void UberDelegate::paint_cell(QPainter *p, const QStyleOptionViewItem &opt, cons
         break;
     case CT_WEAPON:
     {
-        QColor bg = paint_bg(adjusted, p, opt, idx);
-        paint_values(adjusted, rating, text_rating, bg, p, opt, idx, 50.0f, 1, 99, 49, 51, true);
+        QColor bg = paint_bg(adjusted, p, opt, default_bg);
+        paint_values(adjusted, rating, text_rating, bg, p, opt, 50.0f, 1, 99, 49, 51, true);
         paint_grid(adjusted, false, p, opt, idx);
 
     }
@@ -391,8 +419,8 @@ void UberDelegate::paint_cell(QPainter *p, const QStyleOptionViewItem &opt, cons
     case CT_FLAGS:
     {
         if(d){
-            int bit_pos = idx.data(DwarfModel::DR_OTHER_ID).toInt();
-            paint_bg_active(adjusted, d->get_flag_value(bit_pos), p, opt, idx, state, state_color);
+            int bit_pos = cell_data(DwarfModel::DR_OTHER_ID).toInt();
+            paint_bg_active(adjusted, d->get_flag_value(bit_pos), p, opt, default_bg, state, state_color);
             paint_grid(adjusted,d->is_flag_dirty(bit_pos),p,opt,idx);
         }else{
             QStyledItemDelegate::paint(p, opt, idx);
@@ -401,36 +429,36 @@ void UberDelegate::paint_cell(QPainter *p, const QStyleOptionViewItem &opt, cons
         break;
     case CT_TRAINED:
     {
-        QColor bg = paint_bg(adjusted, p, opt, idx, false, model_idx.data(Qt::BackgroundColorRole).value<QColor>());
+        QColor bg = paint_bg(adjusted, p, opt, default_bg, false, cell_data(Qt::BackgroundColorRole).value<QColor>());
         //arbitrary ignore range is used just to hide tame animals
-        paint_values(adjusted, rating, text_rating, bg, p, opt, idx, 50.0f, 1.0f, 95.0f, 49.9f, 50.1f, true);
+        paint_values(adjusted, rating, text_rating, bg, p, opt, 50.0f, 1.0f, 95.0f, 49.9f, 50.1f, true);
         paint_grid(adjusted, false, p, opt, idx);
     }
         break;
     case CT_KILLS:
     {
-        QColor bg = paint_bg(adjusted, p, opt, idx, false, model_idx.data(Qt::BackgroundColorRole).value<QColor>());
-        paint_values(adjusted, rating, text_rating, bg, p, opt, idx, 50.0f, 1.0f, 95.0f, 49.9f, 50.1f, true);
+        QColor bg = paint_bg(adjusted, p, opt, default_bg, false, cell_data(Qt::BackgroundColorRole).value<QColor>());
+        paint_values(adjusted, rating, text_rating, bg, p, opt, 50.0f, 1.0f, 95.0f, 49.9f, 50.1f, true);
         paint_grid(adjusted, false, p, opt, idx);
     }
         break;
     case CT_PREFERENCE:
     {
-        QColor bg = paint_bg(adjusted, p, opt, idx, false, model_idx.data(Qt::BackgroundColorRole).value<QColor>());
+        QColor bg = paint_bg(adjusted, p, opt, default_bg, false, cell_data(Qt::BackgroundColorRole).value<QColor>());
         if (rating > 0)
-            paint_values(adjusted, rating, text_rating, bg, p, opt, idx, 0.0f, 0.0f, 100.0f, 0.0f, 0.0f, true);
+            paint_values(adjusted, rating, text_rating, bg, p, opt, 0.0f, 0.0f, 100.0f, 0.0f, 0.0f, true);
         paint_grid(adjusted, false, p, opt, idx);
     }
         break;
     case CT_HEALTH:
     {
-        QColor bg = paint_bg(adjusted, p, opt, idx, false, model_idx.data(Qt::BackgroundColorRole).value<QColor>());
+        QColor bg = paint_bg(adjusted, p, opt, default_bg, false, cell_data(Qt::BackgroundColorRole).value<QColor>());
 
         //draw the symbol text in bold
         p->save();
         if (rating != 0) {
             if(color_health_cells){
-                p->setPen(model_idx.data(Qt::TextColorRole).value<QColor>());
+                p->setPen(cell_data(Qt::TextColorRole).value<QColor>());
             }else{
                 if(auto_contrast){
                     p->setPen(complement(bg));
@@ -451,10 +479,10 @@ void UberDelegate::paint_cell(QPainter *p, const QStyleOptionViewItem &opt, cons
         break;
     case CT_NEED:
     {
-        paint_bg(adjusted, p, opt, idx, false, state_color);
+        paint_bg(adjusted, p, opt, default_bg, false, state_color);
         limit = 15.0f;
         if (rating > 0)
-            paint_values(adjusted, rating, text_rating, state_color, p, opt, idx, 0, 0, limit, 0, 0);
+            paint_values(adjusted, rating, text_rating, state_color, p, opt, 0, 0, limit, 0, 0);
         paint_grid(adjusted, false, p, opt, idx);
     }
         break;
@@ -463,7 +491,7 @@ void UberDelegate::paint_cell(QPainter *p, const QStyleOptionViewItem &opt, cons
     default:
     {
         if(adjusted.width() > 0){
-            paint_bg(adjusted, p, opt, idx, false, QColor(Qt::transparent));
+            paint_bg(adjusted, p, opt, default_bg, false, QColor(Qt::transparent));
         }
         break;
     }
@@ -491,16 +519,8 @@ void UberDelegate::paint_icon(const QRect &adjusted, QPainter *p, const QStyleOp
     paint_grid(adjusted, false, p, opt, idx);
 }
 
-QColor UberDelegate::paint_bg_active(const QRect &adjusted, bool active, QPainter *p, const QStyleOptionViewItem &opt, const QModelIndex &proxy_idx, const int &state, const QColor &active_col_override) const{
-    QModelIndex idx = proxy_idx;
-    if (m_proxy)
-        idx = m_proxy->mapToSource(proxy_idx);
-
-    QColor bg = idx.data(DwarfModel::DR_DEFAULT_BG_COLOR).value<QColor>();
-    p->save();
-    p->fillRect(opt.rect, bg);
-
-
+QColor UberDelegate::paint_bg_active(const QRect &adjusted, bool active, QPainter *p, const QStyleOptionViewItem &opt, const QColor &default_bg, const int &state, const QColor &active_col_override) const{
+    QColor bg = default_bg;
     if(active || state == ViewColumn::STATE_DISABLED || state == ViewColumn::STATE_ACTIVE){ //always draw disabled or active
         if(active_col_override != QColor(Qt::black))
             bg = active_col_override;
@@ -508,44 +528,57 @@ QColor UberDelegate::paint_bg_active(const QRect &adjusted, bool active, QPainte
             bg = color_active_labor;
     }
 
-    if(gradient_cell_bg){
-        QLinearGradient grad(adjusted.topLeft(),adjusted.bottomRight());
-        grad.setColorAt(0,bg);
+    draw_bg(p, opt, adjusted, default_bg, bg, gradient_cell_bg ? 70 : -1);
+    if(gradient_cell_bg)
         bg.setAlpha(70);
-        grad.setColorAt(1,bg);
-        p->fillRect(adjusted, grad);
-    }else{
-        p->fillRect(adjusted, QBrush(bg));
-    }
-    p->restore();
-
     return bg;
 }
 
-QColor UberDelegate::paint_bg(const QRect &adjusted, QPainter *p, const QStyleOptionViewItem &opt, const QModelIndex &proxy_idx, const bool use_gradient, const QColor &col_override) const{
-    QModelIndex idx = proxy_idx;
-    if (m_proxy)
-        idx = m_proxy->mapToSource(proxy_idx);
-
-    QColor bg = idx.data(DwarfModel::DR_DEFAULT_BG_COLOR).value<QColor>();
-    p->save();
-    p->fillRect(opt.rect, bg);
-
+QColor UberDelegate::paint_bg(const QRect &adjusted, QPainter *p, const QStyleOptionViewItem &opt, const QColor &default_bg, const bool use_gradient, const QColor &col_override) const{
+    QColor bg = default_bg;
     if (col_override != QColor(Qt::black))
         bg = col_override;
 
-    if(use_gradient && gradient_cell_bg){
-        QLinearGradient grad(adjusted.topLeft(),adjusted.bottomRight());
-        grad.setColorAt(0,bg);
+    bool gradient = use_gradient && gradient_cell_bg;
+    draw_bg(p, opt, adjusted, default_bg, bg, gradient ? 75 : -1);
+    if(gradient)
         bg.setAlpha(75);
-        grad.setColorAt(1,bg);
-        p->fillRect(adjusted, grad);
-    }else{
-        p->fillRect(adjusted, QBrush(bg));
+    return bg;
+}
+
+void UberDelegate::draw_bg(QPainter *p, const QStyleOptionViewItem &opt, const QRect &adjusted, const QColor &default_bg, const QColor &fill, int gradient_alpha) const{
+    auto render = [&default_bg, &fill, gradient_alpha](QPainter *gp, const QRect &rect, const QRect &adj) {
+        gp->fillRect(rect, default_bg);
+        if(gradient_alpha >= 0){
+            QColor faded = fill;
+            faded.setAlpha(gradient_alpha);
+            QLinearGradient grad(adj.topLeft(),adj.bottomRight());
+            grad.setColorAt(0,fill);
+            grad.setColorAt(1,faded);
+            gp->fillRect(adj, grad);
+        }else{
+            gp->fillRect(adj, QBrush(fill));
+        }
+    };
+
+    if(!use_atlas(p, opt)){
+        p->save();
+        render(p, opt.rect, adjusted);
+        p->restore();
+        return;
     }
-    p->restore();
+    GlyphAtlas::key k(GK_BG, gradient_alpha, 0, default_bg.rgba(), fill.rgba());
+    m_atlas->draw(p, opt.rect.topLeft(), k, [this, &render](QPainter *gp, const QRect &r) {
+        render(gp, r, r.adjusted(cell_padding, cell_padding, -cell_padding, -cell_padding));
+    });
+}
 
-    return bg;
+bool UberDelegate::use_atlas(QPainter *p, const QStyleOptionViewItem &opt) const{
+    //scaled or rotated painters (printing) get the cells drawn directly
+    if(p->transform().type() > QTransform::TxTranslate)
+        return false;
+    //cells of any other size than the first one cached (spacers) are drawn directly
+    return m_atlas->prepare(opt.rect.size(), p->device() ? p->device()->devicePixelRatioF() : 1.0);
 }
 
 QColor UberDelegate::get_pen_color(const QColor bg) const{
@@ -562,26 +595,40 @@ QColor UberDelegate::get_pen_color(const QColor bg) const{
 }
 
 void UberDelegate::paint_values(const QRect &adjusted, float rating, QString text_rating, QColor bg, QPainter *p, const QStyleOptionViewItem &opt,
-                                const QModelIndex &idx, float median, float min_limit, float max_limit, float min_ignore, float max_ignore, bool bold_text) const{
+                                float median, float min_limit, float max_limit, float min_ignore, float max_ignore, bool bold_text) const{
+    value_glyph g = get_value_glyph(rating, text_rating, bg, median, min_limit, max_limit, min_ignore, max_ignore, bold_text);
+    if(g.shape == value_glyph::VG_NONE)
+        return;
 
-    QColor color_fill = color_skill;
+    if(!use_atlas(p, opt)){
+        render_value_glyph(p, opt.rect, adjusted, g);
+        return;
+    }
+    GlyphAtlas::key k(GK_VALUE + g.shape, g.size, g.bold, g.fill, g.pen, g.text);
+    m_atlas->draw(p, opt.rect.topLeft(), k, [this, &g](QPainter *gp, const QRect &r) {
+        gp->setFont(m_fnt);
+        render_value_glyph(gp, r, r.adjusted(cell_padding, cell_padding, -cell_padding, -cell_padding), g);
+    });
+}
 
-    QPen pn;
-    pn.setColor(get_pen_color(bg));
-    pn.setWidth(0);
+UberDelegate::value_glyph UberDelegate::get_value_glyph(float rating, const QString &text_rating, const QColor &bg, float median,
+                                                        float min_limit, float max_limit, float min_ignore, float max_ignore, bool bold_text) const{
+    value_glyph g;
+    g.shape = value_glyph::VG_NONE;
+    g.size = 0;
+    g.bold = false;
+
+    QColor color_fill = color_skill;
+    QColor color_pen = get_pen_color(bg);
 
     if (auto_contrast)
         color_fill = complement(bg);
 
-    QModelIndex model_idx = idx;
-    if (m_proxy)
-        model_idx = m_proxy->mapToSource(idx);
-
     //some columns will ignore a mid range of values and draw nothing
     //however this is NEVER done when using the numeric drawing method
     if((min_ignore != 0 || max_ignore != 0) && m_skill_drawing_method != SDM_NUMERIC){
         if (rating >= min_ignore && rating <= max_ignore){
-            return; //paint nothing for mid ranges
+            return g; //paint nothing for mid ranges
         }
     }
 
@@ -597,7 +644,7 @@ void UberDelegate::paint_values(const QRect &adjusted, float rating, QString tex
         }else{
             color_fill = neg;
         }
-        pn.setColor(Qt::gray);
+        color_pen = Qt::gray;
     }
 
     //check the median passed in and covert to normal: 0-50-100 if necessary
@@ -610,26 +657,13 @@ void UberDelegate::paint_values(const QRect &adjusted, float rating, QString tex
                 adj_rating = ((adj_rating - median) / (100.0f-median) * 50.0f) + 50.0f;
             }
         }
-        //        //also invert the value if it was below the median, and rescale our drawing values from 0-50 and 50-100
-        //        if(adj_rating > 50.0f){
-        //            adj_rating = (adj_rating - 50.0f) * 2.0f;
-        //        }else{
-        //            adj_rating = 100 - (adj_rating * 2.0f);
-        //        }
     }
 
-    p->save();
     switch(m_skill_drawing_method) {
     default:
     case SDM_GROWING_CENTRAL_BOX:
         if (adj_rating >= max_limit || adj_rating <= min_limit) {
-            // draw diamond
-            p->setRenderHint(QPainter::Antialiasing);
-            p->setPen(pn);
-            p->setBrush(QBrush(color_fill));
-            p->translate(opt.rect.x() + 2, opt.rect.y() + 2);
-            p->scale(opt.rect.width() - 4, opt.rect.height() - 4);
-            p->drawPolygon(m_diamond_shape);
+            g.shape = value_glyph::VG_DIAMOND;
         } else if (adj_rating > -1) {
             //0.05625 (MIN_DRAW_SIZE) is the smallest dot we can draw here, so scale to ensure the smallest exp value (1/500 or .002) can always be drawn
             //relative to our maximum limit for this range. this could still be improved to take into account the cell size, as having even
@@ -650,147 +684,179 @@ void UberDelegate::paint_values(const QRect &adjusted, float rating, QString tex
                 }
                 size = MAX_CELL_FILL - size + MIN_DRAW_SIZE;
             }
-
-            //double size = (((adj_rating-0) * (perc_of_cell - 0.05625)) / (100.0f-0)) + 0.05625;
-            //size = roundf(size * 100) / 100; //this is to aid in the problem of an odd number of pixel in an even size cell, or vice versa
-            double inset = (1.0f - size) / 2.0f;
-            p->translate(adjusted.x(),adjusted.y());
-            p->scale(adjusted.width(),adjusted.height());
-            p->fillRect(QRectF(inset, inset, size, size), QBrush(color_fill));
+            g.shape = value_glyph::VG_BOX;
+            g.size = qRound(size * GLYPH_STEPS);
         }
         break;
     case SDM_GROWING_FILL:
         if (rating >= max_limit) {
-            // draw diamond
-            p->setRenderHint(QPainter::Antialiasing);
-            p->setPen(pn);
-            p->setBrush(QBrush(color_fill));
-            p->translate(opt.rect.x() + 2, opt.rect.y() + 2);
-            p->scale(opt.rect.width() - 4, opt.rect.height() - 4);
-            p->drawPolygon(m_diamond_shape);
+            g.shape = value_glyph::VG_DIAMOND;
         } else if (rating > -1 && rating < max_limit) {
-            float size = 0.8f * (rating / max_limit) + 0.1f;
-            p->translate(adjusted.x(), adjusted.y());
-            p->scale(adjusted.width(), adjusted.height());
-            p->fillRect(QRectF(0, 0, size, 1), QBrush(color_fill));
+            g.shape = value_glyph::VG_FILL;
+            g.size = qRound((0.8f * (rating / max_limit) + 0.1f) * GLYPH_STEPS);
         }
         break;
     case SDM_GLYPH_LINES:
-    {
-        p->setBrush(QBrush(color_fill));
         //match pen to brush for glyphs
-        pn.setColor(color_fill);
-        p->setPen(pn);
-        p->translate(adjusted.x(), adjusted.y());
-        p->scale(adjusted.width(), adjusted.height());
-        QVector<QLineF> lines;
-
+        color_pen = color_fill;
         if(rating >= max_limit){
-            p->resetTransform();
-            p->setPen(pn);
-            p->translate(adjusted.x() + adjusted.width()/2.0,
-                         adjusted.y() + adjusted.height()/2.0);
-            p->scale(adjusted.width(), adjusted.height());
-            p->rotate(-18);
-            p->setRenderHint(QPainter::Antialiasing);
-            p->drawPolygon(m_star_shape, Qt::WindingFill);
+            g.shape = value_glyph::VG_STAR;
         }else{
             //scale rating down to 0-14 + 1 to ensure dabbling is drawn
-            adj_rating = floor((((rating-0)/(max_limit-0))*0.15)*100);
-
-            switch ((int)adj_rating) {//((int)rating) {
-            case 0: //dabbling
-                lines << QLineF(QPointF(0.499, 0.5), QPointF(0.501, 0.5));
-                break;
-            case 15:
-            {
-                p->resetTransform();
-                p->translate(adjusted.x() + adjusted.width()/2.0,
-                             adjusted.y() + adjusted.height()/2.0);
-                p->scale(adjusted.width(), adjusted.height());
-                p->rotate(-18);
-                p->setRenderHint(QPainter::Antialiasing);
-                p->drawPolygon(m_star_shape, Qt::WindingFill);
+            int level = floor((((rating-0)/(max_limit-0))*0.15)*100);
+            if(level == 15){
+                g.shape = value_glyph::VG_STAR;
+            }else if(level >= 0 && level < 15){
+                g.shape = value_glyph::VG_LINES;
+                g.size = level;
             }
-                break;
-            case 14:
-            {
-                QPolygonF poly;
-                poly << QPointF(0.5, 0.1)
-                     << QPointF(0.5, 0.5)
-                     << QPointF(0.9, 0.5);
-                p->drawPolygon(poly);
-            } // fallthrough
-            case 13:
-            {
-                QPolygonF poly;
-                poly << QPointF(0.1, 0.5)
-                     << QPointF(0.5, 0.5)
-                     << QPointF(0.5, 0.9);
-                p->drawPolygon(poly);
-            } // fallthrough
-            case 12:
-            {
-                QPolygonF poly;
-                poly << QPointF(0.9, 0.5)
-                     << QPointF(0.5, 0.5)
-                     << QPointF(0.5, 0.9);
-                p->drawPolygon(poly);
-            } // fallthrough
-            case 11:
-            {
-                QPolygonF poly;
-                poly << QPointF(0.1, 0.5)
-                     << QPointF(0.5, 0.5)
-                     << QPointF(0.5, 0.1);
-                p->drawPolygon(poly);
-            } // fallthrough
-            case 10: // accomplished
-                lines << QLineF(QPointF(0.5, 0.1), QPointF(0.9, 0.5));
-                // fallthrough
-            case 9: //professional
-                lines << QLineF(QPointF(0.1, 0.5), QPointF(0.5, 0.1));
-                // fallthrough
-            case 8: //expert
-                lines << QLineF(QPointF(0.5, 0.9), QPointF(0.1, 0.5));
-                // fallthrough
-            case 7: //adept
-                lines << QLineF(QPointF(0.5, 0.9), QPointF(0.9, 0.5));
-                // fallthrough
-            case 6: //talented
-                lines << QLineF(QPointF(0.5, 0.5), QPointF(0.5, 0.9));
-                // fallthrough
-            case 5: //proficient
-                lines << QLineF(QPointF(0.5, 0.5), QPointF(0.9, 0.5));
-                // fallthrough
-            case 4: //skilled
-                lines << QLineF(QPointF(0.5, 0.1), QPointF(0.5, 0.5));
-                // fallthrough
-            case 3: //competent
-                lines << QLineF(QPointF(0.1, 0.5), QPointF(0.5, 0.5));
-                // fallthrough
-            case 2: //untitled
-                lines << QLineF(QPointF(0.7, 0.3), QPointF(0.3, 0.7));
-                // fallthrough
-            case 1: //novice
-                lines << QLineF(QPointF(0.3, 0.3), QPointF(0.7, 0.7));
-                break;
-            }
-            p->drawLines(lines);
         }
-    }
         break;
     case SDM_NUMERIC:
         if (rating > -1) { // don't draw 0s everywhere
-            p->setPen(color_fill);
+            g.shape = value_glyph::VG_TEXT;
+            g.text = text_rating;
             //for some reason df's masterwork glyph's quality is reduced when using bold
-            if(bold_text && !text_rating.contains(QChar(0x263C))){
-                QFont tmp = m_fnt;
-                tmp.setBold(true);
-                p->setFont(tmp);
-            }
-            p->drawText(opt.rect, Qt::AlignCenter, text_rating);
+            g.bold = bold_text && !text_rating.contains(QChar(0x263C));
+            color_pen = color_fill;
+        }
+        break;
+    }
+
+    g.fill = color_fill.rgba();
+    g.pen = color_pen.rgba();
+    return g;
+}
+
+void UberDelegate::render_value_glyph(QPainter *p, const QRect &rect, const QRect &adjusted, const value_glyph &g) const{
+    QColor color_fill = QColor::fromRgba(g.fill);
+    QPen pn;
+    pn.setColor(QColor::fromRgba(g.pen));
+    pn.setWidth(0);
+
+    p->save();
+    switch(g.shape) {
+    case value_glyph::VG_NONE:
+        break;
+    case value_glyph::VG_DIAMOND:
+        p->setRenderHint(QPainter::Antialiasing);
+        p->setPen(pn);
+        p->setBrush(QBrush(color_fill));
+        p->translate(rect.x() + 2, rect.y() + 2);
+        p->scale(rect.width() - 4, rect.height() - 4);
+        p->drawPolygon(m_diamond_shape);
+        break;
+    case value_glyph::VG_BOX:
+    {
+        double size = (double)g.size / GLYPH_STEPS;
+        //size = roundf(size * 100) / 100; //this is to aid in the problem of an odd number of pixel in an even size cell, or vice versa
+        double inset = (1.0f - size) / 2.0f;
+        p->translate(adjusted.x(),adjusted.y());
+        p->scale(adjusted.width(),adjusted.height());
+        p->fillRect(QRectF(inset, inset, size, size), QBrush(color_fill));
+    }
+        break;
+    case value_glyph::VG_FILL:
+        p->translate(adjusted.x(), adjusted.y());
+        p->scale(adjusted.width(), adjusted.height());
+        p->fillRect(QRectF(0, 0, (double)g.size / GLYPH_STEPS, 1), QBrush(color_fill));
+        break;
+    case value_glyph::VG_STAR:
+        p->setBrush(QBrush(color_fill));
+        p->setPen(pn);
+        p->translate(adjusted.x() + adjusted.width()/2.0,
+                     adjusted.y() + adjusted.height()/2.0);
+        p->scale(adjusted.width(), adjusted.height());
+        p->rotate(-18);
+        p->setRenderHint(QPainter::Antialiasing);
+        p->drawPolygon(m_star_shape, Qt::WindingFill);
+        break;
+    case value_glyph::VG_LINES:
+    {
+        p->setBrush(QBrush(color_fill));
+        p->setPen(pn);
+        p->translate(adjusted.x(), adjusted.y());
+        p->scale(adjusted.width(), adjusted.height());
+        QVector<QLineF> lines;
+
+        switch (g.size) {
+        case 0: //dabbling
+            lines << QLineF(QPointF(0.499, 0.5), QPointF(0.501, 0.5));
+            break;
+        case 14:
+        {
+            QPolygonF poly;
+            poly << QPointF(0.5, 0.1)
+                 << QPointF(0.5, 0.5)
+                 << QPointF(0.9, 0.5);
+            p->drawPolygon(poly);
+        } // fallthrough
+        case 13:
+        {
+            QPolygonF poly;
+            poly << QPointF(0.1, 0.5)
+                 << QPointF(0.5, 0.5)
+                 << QPointF(0.5, 0.9);
+            p->drawPolygon(poly);
+        } // fallthrough
+        case 12:
+        {
+            QPolygonF poly;
+            poly << QPointF(0.9, 0.5)
+                 << QPointF(0.5, 0.5)
+                 << QPointF(0.5, 0.9);
+            p->drawPolygon(poly);
+        } // fallthrough
+        case 11:
+        {
+            QPolygonF poly;
+            poly << QPointF(0.1, 0.5)
+                 << QPointF(0.5, 0.5)
+                 << QPointF(0.5, 0.1);
+            p->drawPolygon(poly);
+        } // fallthrough
+        case 10: // accomplished
+            lines << QLineF(QPointF(0.5, 0.1), QPointF(0.9, 0.5));
+            // fallthrough
+        case 9: //professional
+            lines << QLineF(QPointF(0.1, 0.5), QPointF(0.5, 0.1));
+            // fallthrough
+        case 8: //expert
+            lines << QLineF(QPointF(0.5, 0.9), QPointF(0.1, 0.5));
+            // fallthrough
+        case 7: //adept
+            lines << QLineF(QPointF(0.5, 0.9), QPointF(0.9, 0.5));
+            // fallthrough
+        case 6: //talented
+            lines << QLineF(QPointF(0.5, 0.5), QPointF(0.5, 0.9));
+            // fallthrough
+        case 5: //proficient
+            lines << QLineF(QPointF(0.5, 0.5), QPointF(0.9, 0.5));
+            // fallthrough
+        case 4: //skilled
+            lines << QLineF(QPointF(0.5, 0.1), QPointF(0.5, 0.5));
+            // fallthrough
+        case 3: //competent
+            lines << QLineF(QPointF(0.1, 0.5), QPointF(0.5, 0.5));
+            // fallthrough
+        case 2: //untitled
+            lines << QLineF(QPointF(0.7, 0.3), QPointF(0.3, 0.7));
+            // fallthrough
+        case 1: //novice
+            lines << QLineF(QPointF(0.3, 0.3), QPointF(0.7, 0.7));
+            break;
+        }
+        p->drawLines(lines);
+    }
+        break;
+    case value_glyph::VG_TEXT:
+        p->setPen(color_fill);
+        if(g.bold){
+            QFont tmp = m_fnt;
+            tmp.setBold(true);
+            p->setFont(tmp);
         }
+        p->drawText(rect, Qt::AlignCenter, g.text);
         break;
     }
     p->restore();
@@ -816,7 +882,6 @@ void UberDelegate::paint_mood_cell(const QRect &adjusted, QPainter *p, const QSt
     }
 
     if(color_mood_cells && !dirty){ //dirty is always drawn over mood
-        QList<Skill> skills = d->get_moodable_skills().values();
         if(d->get_moodable_skills().contains(skill_id)){
             QColor mood = color_mood;
             if(d->had_mood())
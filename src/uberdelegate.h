@@ -24,16 +24,19 @@ THE SOFTWARE.
 #define UBER_DELEGATE_H
 
 #include <QStyledItemDelegate>
+#include <memory>
 #include "item.h"
 
 class Dwarf;
 class DwarfModel;
 class DwarfModelProxy;
+class GlyphAtlas;
 
 class UberDelegate : public QStyledItemDelegate {
     Q_OBJECT
 public:
     UberDelegate(QObject *parent = 0);
+    ~UberDelegate();
     void paint(QPainter *p, const QStyleOptionViewItem &opt, const QModelIndex &proxy_idx) const;
 
     typedef enum {
@@ -91,6 +94,29 @@ private:
 
     static const float MIN_DRAW_SIZE; //minimum visible drawn square
     static const float MAX_CELL_FILL; //max percentage of the cell to fill
+    static const int GLYPH_STEPS; //resolution of the cached glyph sizes, per cell
+
+    //! what paint_values draws for a rating, used as the glyph cache key
+    struct value_glyph {
+        typedef enum {
+            VG_NONE = 0,
+            VG_DIAMOND,
+            VG_BOX,
+            VG_FILL,
+            VG_LINES,
+            VG_STAR,
+            VG_TEXT
+        } SHAPE;
+        SHAPE shape;
+        int size; //!< box/fill size in GLYPH_STEPS, or the skill level for line glyphs
+        bool bold;
+        QRgb fill;
+        QRgb pen;
+        QString text;
+    };
+
+    //! backgrounds and rating glyphs of the cells, rendered once and blitted
+    std::unique_ptr<GlyphAtlas> m_atlas;
 
     void paint_cell(QPainter *p, const QStyleOptionViewItem &opt, const QModelIndex &proxy_idx, const bool drawing_aggregate) const;
 
@@ -100,13 +126,21 @@ private:
 
     //! return the bg color that was painted
     //! drawing labor bg cells (shaded for active possibly)
-    QColor paint_bg_active(const QRect &adjusted, bool active, QPainter *p, const QStyleOptionViewItem &opt, const QModelIndex &proxy_idx, const int &state, const QColor &active_col_override = Qt::black) const;
+    QColor paint_bg_active(const QRect &adjusted, bool active, QPainter *p, const QStyleOptionViewItem &opt, const QColor &default_bg, const int &state, const QColor &active_col_override = Qt::black) const;
     //! drawing any other cell that cannot be active (non-labor)
-    QColor paint_bg(const QRect &adjusted, QPainter *p, const QStyleOptionViewItem &opt, const QModelIndex &proxy_idx, const bool use_gradient = true, const QColor &col_override = Qt::black) const;
+    QColor paint_bg(const QRect &adjusted, QPainter *p, const QStyleOptionViewItem &opt, const QColor &default_bg, const bool use_gradient = true, const QColor &col_override = Qt::black) const;
+    //! fill the cell with default_bg and the inner rect with fill, as a gradient fading to gradient_alpha if it's not negative
+    void draw_bg(QPainter *p, const QStyleOptionViewItem &opt, const QRect &adjusted, const QColor &default_bg, const QColor &fill, int gradient_alpha) const;
 
     void paint_values(const QRect &adjusted, float rating, QString text_rating, QColor bg, QPainter *p,
-                    const QStyleOptionViewItem &opt, const QModelIndex &proxy_idx, float median = 50.0f,
+                    const QStyleOptionViewItem &opt, float median = 50.0f,
                     float min_limit=5.0f, float max_limit=95.0f, float min_ignore=40.0f, float max_ignore=60.0f, bool bold_text = false) const;
+    value_glyph get_value_glyph(float rating, const QString &text_rating, const QColor &bg, float median,
+                                float min_limit, float max_limit, float min_ignore, float max_ignore, bool bold_text) const;
+    void render_value_glyph(QPainter *p, const QRect &rect, const QRect &adjusted, const value_glyph &g) const;
+
+    //! true if the cell can be blitted from the glyph atlas
+    bool use_atlas(QPainter *p, const QStyleOptionViewItem &opt) const;
 
     void paint_mood_cell(const QRect &adjusted, QPainter *p, const QStyleOptionViewItem &opt, const QModelIndex &proxy_idx, int skill_id, bool dirty, Dwarf *d) const;
     void paint_wear_cell(const QRect &adjusted, QPainter *p, const QStyleOptionViewItem &opt, const QModelIndex &proxy_idx, const Item::ITEM_STATE i_status) const;
@@ -26,6 +26,7 @@ THE SOFTWARE.
 #include <QObject>
 #include "global_enums.h"
 #include "utils.h"
+#include "generationarena.h"
 
 class DFInstance;
 class ItemDefUniform;
@@ -34,6 +35,7 @@ class Item;
 class Uniform : public QObject {
     Q_OBJECT
 public:
+    GENERATION_ALLOCATED
     Uniform(DFInstance *df, QObject *parent = 0);
     virtual ~Uniform();
 
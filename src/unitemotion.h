@@ -27,6 +27,7 @@ THE SOFTWARE.
 #include "global_enums.h"
 #include "utils.h"
 #include "dftime.h"
+#include "generationarena.h"
 
 class DFInstance;
 
@@ -51,6 +52,7 @@ private:
     QString m_compare_id; //id/name used to compare in addition to thought/emotion
 
 public:
+    GENERATION_ALLOCATED
     UnitEmotion(QObject *parent = 0);
     UnitEmotion(VIRTADDR addr, DFInstance *df, QObject *parent = 0);
 
@@ -38,6 +38,23 @@ UnitNeed::UnitNeed(VIRTADDR address, DFInstance *df, Dwarf *d)
     m_deity_id = df->read_int(mem->need_field(address, "deity_id"));
     m_focus_level = df->read_int(mem->need_field(address, "focus_level"));
     m_need_level = df->read_int(mem->need_field(address, "need_level"));
+    set_focus_degree();
+    if (m_deity_id != -1)
+        m_deity_name = HistFigure::get_name(df, m_deity_id, true);
+}
+
+UnitNeed::UnitNeed(int id, int deity_id, int focus_level, int need_level, Dwarf *d)
+    : m_dwarf(d)
+    , m_id(id)
+    , m_deity_id(deity_id)
+    , m_focus_level(focus_level)
+    , m_need_level(need_level)
+{
+    set_focus_degree();
+}
+
+void UnitNeed::set_focus_degree()
+{
     if (m_focus_level <= -100000)
         m_focus_degree = BADLY_DISTRACTED;
     else if (m_focus_level <= -10000)
@@ -52,8 +69,6 @@ UnitNeed::UnitNeed(VIRTADDR address, DFInstance *df, Dwarf *d)
         m_focus_degree = LEVEL_HEADED;
     else // if (m_focus_level < 400)
         m_focus_degree = UNFETTERED;
-    if (m_deity_id != -1)
-        m_deity_name = HistFigure::get_name(df, m_deity_id, true);
 }
 
 QString UnitNeed::adjective() const
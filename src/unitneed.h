@@ -28,6 +28,7 @@ THE SOFTWARE.
 #include <QString>
 
 #include "utils.h"
+#include "generationarena.h"
 
 class DFInstance;
 class Dwarf;
@@ -37,7 +38,9 @@ class UnitNeed
 {
     Q_DECLARE_TR_FUNCTIONS(UnitNeed)
 public:
+    GENERATION_ALLOCATED
     UnitNeed(VIRTADDR address, DFInstance *df, Dwarf *d);
+    UnitNeed(int id, int deity_id, int focus_level, int need_level, Dwarf *d);
 
     enum DEGREE {
         BADLY_DISTRACTED = 0,
@@ -69,6 +72,8 @@ private:
     int m_focus_level;
     int m_need_level;
     DEGREE m_focus_degree;
+
+    void set_focus_degree();
 };
 
 #endif
@@ -166,7 +166,13 @@ void ViewColumn::write_to_ini(QSettings &s) {
 
 QString ViewColumn::get_cell_value(Dwarf *d)
 {
-    return QString("%1").arg(m_cells.value(d)->data(m_export_data_role).toString());
+    return get_export_value(d).toString();
+}
+
+QVariant ViewColumn::get_export_value(Dwarf *d) const
+{
+    DTStandardItem *item = m_cells.value(d);
+    return item ? item->data(m_export_data_role) : QVariant();
 }
 
 QString ViewColumn::tooltip_name_footer(Dwarf *d){
@@ -119,6 +119,8 @@ public:
     virtual QStandardItem *build_aggregate(const QString &group_name, const QVector<Dwarf*> &dwarves) = 0; // create an aggregate cell based on several dwarves
 
     QString get_cell_value(Dwarf *d);
+    //! the raw export role value of the unit's cell, invalid if the unit has no cell
+    QVariant get_export_value(Dwarf *d) const;
     virtual void write_to_ini(QSettings &s);
 
     QList<COLUMN_SORT_TYPE> get_sortable_types(){return m_sortable_types;}
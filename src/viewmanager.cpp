@@ -106,44 +106,16 @@ void ViewManager::reload_views() {
     m_last_index = -1;
 
     QSettings *u = DT->user_settings();
-    //read in the default column sorts
-    m_default_column_sort.clear();
-    for(int i = 0; i < CT_TOTAL_TYPES; i++){
-        QString val = u->value("options/grid/" + get_column_type(static_cast<COLUMN_TYPE>(i)),"").toString();
-        if(val != ""){
-            m_default_column_sort.insert(static_cast<COLUMN_TYPE>(i),ViewColumn::get_sort_type(val));
-        }
-    }
+    load_default_column_sorts(*u);
 
-    QStringList view_names;
-    QList<GridView*> built_in_views;
-
-    //custom views
-    for (auto search_path: StandardPaths::data_locations()) {
-        QDir d(QString("%1/gridviews").arg(search_path));
-        d.setNameFilters(QStringList() << "*.dtg");
-        d.setFilter(QDir::NoDotAndDotDot | QDir::Readable | QDir::Files);
-        d.setSorting(QDir::Name);
-        QFileInfoList files = d.entryInfoList();
-        foreach(QFileInfo info, files) {
-            LOGI << "Loading gridviews from" << info.absoluteFilePath();
-            QSettings s(info.absoluteFilePath(), QSettings::IniFormat);
-            load_views(s,view_names,built_in_views);
-        }
-    }
-    //packaged default views, if we've already loaded an override for a view, don't include these views
-    LOGI << "Loading built-in default gridviews";
-    QSettings s(":config/default_gridviews", QSettings::IniFormat);
-    load_views(s,view_names,built_in_views);
+    QList<GridView*> built_in_views = read_built_in_views(this);
+    m_views = built_in_views;
 
     //special default weapon view
     add_weapons_view(built_in_views);
 
     // now read any gridviews out of the user's settings
-    int total_views = u->beginReadArray("gridviews");
-    for (int i = 0; i < total_views; ++i) {
-        u->setArrayIndex(i);
-        GridView *gv = GridView::read_from_ini(*u, this);
+    foreach(GridView *gv, read_user_views(*u, this)) {
         bool name_taken = true;
         do {
             name_taken = false;
@@ -167,28 +139,78 @@ void ViewManager::reload_views() {
             }
         } while(name_taken);
 
-        gv->set_is_custom(true); // this came from a user's settings
         m_views << gv;
     }
-    u->endArray();
 
     LOGI << "Loaded" << m_views.size() << "views from disk";
     draw_add_tab_button();
 }
 
-void ViewManager::load_views(QSettings &s, QStringList &view_names, QList<GridView*> &built_in_views){
+void ViewManager::load_default_column_sorts(QSettings &s){
+    m_default_column_sort.clear();
+    for(int i = 0; i < CT_TOTAL_TYPES; i++){
+        QString val = s.value("options/grid/" + get_column_type(static_cast<COLUMN_TYPE>(i)),"").toString();
+        if(val != ""){
+            m_default_column_sort.insert(static_cast<COLUMN_TYPE>(i),ViewColumn::get_sort_type(val));
+        }
+    }
+}
+
+QList<GridView*> ViewManager::read_built_in_views(QObject *parent){
+    QList<GridView*> views;
+
+    //custom views
+    for (auto search_path: StandardPaths::data_locations()) {
+        QDir d(QString("%1/gridviews").arg(search_path));
+        d.setNameFilters(QStringList() << "*.dtg");
+        d.setFilter(QDir::NoDotAndDotDot | QDir::Readable | QDir::Files);
+        d.setSorting(QDir::Name);
+        QFileInfoList files = d.entryInfoList();
+        foreach(QFileInfo info, files) {
+            LOGI << "Loading gridviews from" << info.absoluteFilePath();
+            QSettings s(info.absoluteFilePath(), QSettings::IniFormat);
+            load_views(s, views, parent);
+        }
+    }
+    //packaged default views, if we've already loaded an override for a view, don't include these views
+    LOGI << "Loading built-in default gridviews";
+    QSettings s(":config/default_gridviews", QSettings::IniFormat);
+    load_views(s, views, parent);
+    return views;
+}
+
+QList<GridView*> ViewManager::read_user_views(QSettings &s, QObject *parent){
+    QList<GridView*> views;
     int total_views = s.beginReadArray("gridviews");
     for (int i = 0; i < total_views; ++i) {
         s.setArrayIndex(i);
-        GridView *gv = GridView::read_from_ini(s, this);
+        GridView *gv = GridView::read_from_ini(s, parent);
+        gv->set_is_custom(true); // this came from a user's settings
+        views << gv;
+    }
+    s.endArray();
+    return views;
+}
+
+void ViewManager::load_views(QSettings &s, QList<GridView*> &views, QObject *parent){
+    int total_views = s.beginReadArray("gridviews");
+    for (int i = 0; i < total_views; ++i) {
+        s.setArrayIndex(i);
+        GridView *gv = GridView::read_from_ini(s, parent);
         gv->set_is_custom(false); // this is a default view
-        if (!view_names.contains(gv->name())) {
-            m_views << gv;
-            built_in_views << gv;
-            view_names.append(gv->name());
+        bool name_taken = false;
+        foreach(GridView *v, views){
+            if(v->name() == gv->name()){
+                name_taken = true;
+                break;
+            }
+        }
+        if (!name_taken) {
+            views << gv;
             LOGD << "gridview" << gv->name() << "added";
         }else{
             LOGW << "gridview" << gv->name() << "was not loaded because a view with this name already exists";
+            delete gv;
         }
     }
     s.endArray();
@@ -689,9 +711,7 @@ void ViewManager::redraw_current_tab_headers(){
 }
 
 void ViewManager::redraw_specific_header(int id, COLUMN_TYPE type){
-    get_stv(currentIndex())->is_loading_rows = true;
     m_model->update_header_info(id,type);
-    get_stv(currentIndex())->is_loading_rows = false;
 }
 
 
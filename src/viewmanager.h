@@ -61,7 +61,12 @@ public:
     QList<GridView*> views() {return m_views;}
     void add_view(GridView *view);
     void add_weapons_view(QList<GridView*> &built_in_views);
-    void load_views(QSettings &s, QStringList &view_names, QList<GridView *> &built_in_views);
+
+    //! read the views of the custom view files and the packaged defaults, the first view of a name wins
+    static QList<GridView*> read_built_in_views(QObject *parent);
+    //! read the user's own views, name clashes with the built-in views are left to the caller
+    static QList<GridView*> read_user_views(QSettings &s, QObject *parent);
+    static void load_default_column_sorts(QSettings &s);
 
     static void save_column_sort(COLUMN_TYPE cType, ViewColumn::COLUMN_SORT_TYPE sType);
     static ViewColumn::COLUMN_SORT_TYPE get_default_col_sort(COLUMN_TYPE cType){
@@ -99,6 +104,8 @@ public:
         void rebuild_global_sort_keys();
 
 private:
+    static void load_views(QSettings &s, QList<GridView*> &views, QObject *parent);
+
     QList<GridView*> m_views;
     DwarfModel *m_model;
     DwarfModelProxy *m_proxy;